@@ -62,6 +62,15 @@ struct CHANTRAIT<uint16_t>
 	static uint16_t grayscale( uint16_t r, uint16_t g, uint16_t b ) { return ( r * 6966 + g * 23436 + b * 2366 ) >> 15; } // luma coefficients from Rec. 709
 };
 
+template<>
+struct CHANTRAIT<uint32_t>
+{
+	typedef uint64_t Sum;
+	typedef uint64_t Accum;
+	typedef int64_t SignedSum;
+	static uint32_t max() { return 0xFFFFFFFF; }
+};
+
 template<>
 struct CHANTRAIT<float>
 {
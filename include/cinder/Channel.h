@@ -49,6 +49,8 @@ class ChannelT {
 		
 		void						(*mDeallocatorFunc)(void *refcon);
 		void						*mDeallocatorRefcon;
+		
+		std::shared_ptr<Obj>		mParent; // keeps alive the Obj whose pixels a sub-channel shares
 	};
 	/// \endcond
 
@@ -68,6 +70,11 @@ class ChannelT {
 	ChannelT			clone( bool copyPixels = true ) const;
 	//! Returns a new Channel which is a duplicate of an Area \a area. If \a copyPixels the pixel values are copied, otherwise the clone's pixels remain uninitialized.
 	ChannelT			clone( const Area &area, bool copyPixels = true ) const;
+	/*! \brief Returns a Channel which shares rather than copies the pixels of the Area \a area, clipped to the Channel's bounds
+	 
+	 The result has the parent's row bytes and increment and keeps its Obj alive. Changes made through either are visible in both. An \a area wholly outside the bounds yields an empty, 0x0 Channel.
+	 */
+	ChannelT			getSubChannel( const Area &area ) const;
 	
 	//! Returns the width of the Channel in pixels
 	int32_t		getWidth() const { return mObj->mWidth; }
@@ -81,6 +88,8 @@ class ChannelT {
 	Area		getBounds() const { return Area( 0, 0, mObj->mWidth, mObj->mHeight ); }
 	//! Returns the width of a row of the Channel measured in bytes, which is not necessarily getWidth() * getPixelInc()
 	int32_t		getRowBytes() const { return mObj->mRowBytes; }
+	//! Returns whether the Channel's data and each of its rows begin on a multiple of \a alignment bytes
+	bool		isAligned( int32_t alignment ) const { return ( ( reinterpret_cast<size_t>( mObj->mData ) | mObj->mRowBytes ) & ( alignment - 1 ) ) == 0; }
 	//! Returns the amount to increment a T* to increment by a pixel. For a planar channel this is \c 1, but for a Channel of a Surface this might be \c 3 or \c 4
 	uint8_t		getIncrement() const { return mObj->mIncrement; }
 	//! Returns whether the Channel represents a tightly packed array of values. This will be \c false if the Channel is a member of a Surface. Analogous to <tt>getIncrement() == 1</tt>
@@ -275,6 +284,8 @@ typedef ChannelT<uint8_t>	Channel;
 typedef ChannelT<uint8_t>	Channel8u;
 //! 16-bit image channel. Suitable as an intermediate representation and ImageIo but not a first-class citizen.	
 typedef ChannelT<uint16_t>	Channel16u;
+//! 32-bit unsigned integer image channel, such as the labels written by ip::label(). Not supported by ImageIo.
+typedef ChannelT<uint32_t>	Channel32u;
 //! 32-bit floating point image channel
 typedef ChannelT<float>		Channel32f;
 
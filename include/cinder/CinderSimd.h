@@ -0,0 +1,75 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+// Compile-time availability of SIMD intrinsics. Visual C++ exposes the intrinsics of every SSE generation regardless
+// of compiler flags, whereas gcc only does so when the matching -m flag (-msse4.1 etc.) is in effect. Code guarded by
+// these must still verify support at runtime via System::hasSse2(), System::hasSse4_1() etc. before executing; see
+// cinder/SimdDispatch.h. Note that since gcc applies -mavx to a whole translation unit, gcc builds only offer AVX
+// kernels when built for AVX machines, whereas Visual C++ 2012 and later can select them at runtime.
+#if defined( _MSC_VER ) && ( defined( _M_IX86 ) || defined( _M_X64 ) )
+	#define CINDER_SSE2
+	#define CINDER_SSSE3
+	#define CINDER_SSE4_1
+	#if _MSC_VER >= 1700
+		#define CINDER_AVX
+		#define CINDER_AVX2
+		#define CINDER_FMA
+	#endif
+#else
+	#if defined( __SSE2__ )
+		#define CINDER_SSE2
+	#endif
+	#if defined( __SSSE3__ )
+		#define CINDER_SSSE3
+	#endif
+	#if defined( __SSE4_1__ )
+		#define CINDER_SSE4_1
+	#endif
+	#if defined( __AVX__ )
+		#define CINDER_AVX
+	#endif
+	#if defined( __AVX2__ )
+		#define CINDER_AVX2
+	#endif
+	#if defined( __FMA__ )
+		#define CINDER_FMA
+	#endif
+#endif
+
+#if defined( CINDER_SSE2 )
+	#include <xmmintrin.h>
+	#include <emmintrin.h>
+#endif
+#if defined( CINDER_SSSE3 )
+	#include <tmmintrin.h>
+#endif
+#if defined( CINDER_SSE4_1 )
+	#include <smmintrin.h>
+#endif
+#if defined( CINDER_AVX )
+	#include <immintrin.h>
+#endif
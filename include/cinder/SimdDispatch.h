@@ -0,0 +1,61 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/System.h"
+
+#include <boost/thread/once.hpp>
+
+namespace cinder {
+
+/** \brief Resolves a table of function pointers to the SIMD kernels best suited to the machine, once per process.
+	\a TABLE is a POD struct of function pointers with a static member <tt>void resolve( System::SimdLevel level, TABLE *table )</tt>
+	which fills in the fastest implementation available at \a level. The first call to get() resolves the table, thread-safely;
+	every call after that is a plain load, so kernels can be looked up per row without the cost of querying System each time.
+	Since resolution goes through System::getSimdLevel(), the \c CINDER_SIMD environment variable forces a lower instruction set.
+	\code
+	struct SumKernels {
+		float	(*mSum)( const float *values, int32_t count );
+		static void resolve( System::SimdLevel level, SumKernels *table ) { table->mSum = ( level >= System::SIMD_SSE2 ) ? &sumSse2 : &sumScalar; }
+	};
+	float total = DispatchTable<SumKernels>::get().mSum( values, count );
+	\endcode **/
+template<typename TABLE>
+class DispatchTable {
+  public:
+	static const TABLE&		get() { boost::call_once( &DispatchTable<TABLE>::resolve, sOnce ); return sTable; }
+
+  private:
+	static void				resolve() { TABLE::resolve( System::getSimdLevel(), &sTable ); }
+
+	// both are constant-initialized, so get() is safe to call during static initialization
+	static TABLE				sTable;
+	static boost::once_flag		sOnce;
+};
+
+template<typename TABLE> TABLE DispatchTable<TABLE>::sTable;
+template<typename TABLE> boost::once_flag DispatchTable<TABLE>::sOnce = BOOST_ONCE_INIT;
+
+} // namespace cinder
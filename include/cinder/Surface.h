@@ -30,6 +30,7 @@
 #include "cinder/Channel.h"
 #include "cinder/ChanTraits.h"
 #include "cinder/Color.h"
+#include "cinder/CinderMath.h"
 
 #include <boost/logic/tribool.hpp>
 
@@ -76,11 +77,31 @@ class SurfaceConstraints {
  
 	virtual SurfaceChannelOrder getChannelOrder( bool alpha ) const { return ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB; }
 	virtual int32_t				getRowBytes( int requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const { return requestedWidth * elementSize * sco.getPixelInc(); }
+	//! Returns the byte alignment required of the Surface's pixel data, or 0 if any alignment \c new provides is acceptable
+	virtual int32_t				getDataAlignment() const { return 0; }
 };
 
 class SurfaceConstraintsDefault : public SurfaceConstraints {
 };
 
+/*! Aligns a Surface's pixel data and each of its rows to \a alignment bytes, such as 16, 32 or 64. An \a alignment which is not a power of two
+	is rounded up to the next one. Rows are additionally padded by \a paddingColumns pixels beyond their width, which is useful for kernels that read past the end of a row. */
+class SurfaceConstraintsAligned : public SurfaceConstraints {
+ public:
+	SurfaceConstraintsAligned( int32_t alignment = 16, int32_t paddingColumns = 0 )
+		: mAlignment( (int32_t)nextPowerOf2( (uint32_t)std::max<int32_t>( alignment, 1 ) - 1 ) ), mPaddingColumns( paddingColumns ) {}
+
+	virtual int32_t		getRowBytes( int requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const
+		{ return ( ( requestedWidth + mPaddingColumns ) * elementSize * sco.getPixelInc() + mAlignment - 1 ) & ~( mAlignment - 1 ); }
+	virtual int32_t		getDataAlignment() const { return mAlignment; }
+
+	int32_t		getAlignment() const { return mAlignment; }
+	int32_t		getPaddingColumns() const { return mPaddingColumns; }
+
+ private:
+	int32_t		mAlignment, mPaddingColumns;
+};
+
 typedef std::shared_ptr<class ImageSource> ImageSourceRef;
 typedef std::shared_ptr<class ImageTarget> ImageTargetRef;
 
@@ -106,6 +127,8 @@ class SurfaceT {
 		
 		void						(*mDeallocatorFunc)(void *refcon);
 		void						*mDeallocatorRefcon;
+		
+		std::shared_ptr<Obj>		mParent; // keeps alive the Obj whose pixels a sub-surface shares
 	};
 	/// \endcond
 
@@ -127,6 +150,12 @@ class SurfaceT {
 	 <tt>Surface mySurface = Surface( loadImage( loadResource( RES ) );</tt>
 	 */
 	SurfaceT( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
+	/*! \brief Creates a Surface by converting the pixels of \a rhs, for example from a Surface8u to a Surface32f
+	 
+	 The result has the same size, channel order and premultiplication as \a rhs. Values are rescaled between 0-255, 0-65535 and 0-1 as appropriate.
+	 */
+	template<typename Y>
+	explicit SurfaceT( const SurfaceT<Y> &rhs );
 
 	operator ImageSourceRef() const;
 	operator ImageTargetRef();
@@ -149,6 +178,8 @@ class SurfaceT {
 	bool			setPremultiplied( bool premult = true ) const { return mObj->mIsPremultiplied = premult; }
 	//! Returns the width of a row of the Surface measured in bytes, which is not necessarily getWidth() * getPixelInc()
 	int32_t			getRowBytes() const { return mObj->mRowBytes; }
+	//! Returns whether the Surface's data and each of its rows begin on a multiple of \a alignment bytes
+	bool			isAligned( int32_t alignment ) const { return ( ( reinterpret_cast<size_t>( mObj->mData ) | mObj->mRowBytes ) & ( alignment - 1 ) ) == 0; }
 	//! Returns the amount to increment a T* to increment by a pixel. Analogous to the number of channels, which is either 3 or 4
 	uint8_t			getPixelInc() const { return mObj->mChannelOrder.getPixelInc(); }
 
@@ -156,6 +187,11 @@ class SurfaceT {
 	SurfaceT			clone( bool copyPixels = true ) const;
 	//! Returns a new Surface which is a duplicate of an Area \a area. If \a copyPixels the pixel values are copied, otherwise the clone's pixels remain uninitialized
 	SurfaceT			clone( const Area &area, bool copyPixels = true ) const;
+	/*! \brief Returns a Surface which shares rather than copies the pixels of the Area \a area, clipped to the Surface's bounds
+	 
+	 The result has the parent's row bytes and keeps its pixels alive. Changes made through either are visible in both. An \a area wholly outside the bounds yields an empty, 0x0 Surface.
+	 */
+	SurfaceT			getSubSurface( const Area &area ) const;
 
 	//! Retuns the raw data of an image as a pointer to either uin8t_t values in the case of a Surface8u or floats in the case of a Surface32f
 	T*					getData() { return mObj->mData; }
@@ -236,6 +272,7 @@ class SurfaceT {
  private:
 	std::shared_ptr<Obj>		mObj;
 
+	void allocate( int32_t width, int32_t height, SurfaceChannelOrder channelOrder, int32_t rowBytes, int32_t alignment );
 	void init( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
 
 	void	copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &absoluteOffset );
@@ -0,0 +1,88 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+namespace cinder {
+
+/*! Recycles the pixel memory of Surfaces and Channels. Memory is handed out in size classes, four per power of two, so that images of similar
+	sizes share buckets; releasing the last reference to a Surface or Channel created by the pool returns its memory to the pool rather than
+	freeing it. Released memory beyond the pool's budget is freed. Pools may be used from multiple threads, and outlive their last reference
+	until every Surface and Channel they created has been released. \ImplShared */
+class SurfacePool {
+  private:
+	struct Obj;
+	struct Block;
+
+  public:
+	struct Stats {
+		Stats() : mHits( 0 ), mMisses( 0 ), mReleases( 0 ), mEvictions( 0 ), mBytesPooled( 0 ), mBytesInUse( 0 ) {}
+
+		uint64_t	mHits;			//!< allocations satisfied from pooled memory
+		uint64_t	mMisses;		//!< allocations which required new memory
+		uint64_t	mReleases;		//!< allocations returned to the pool
+		uint64_t	mEvictions;		//!< pooled allocations freed to remain within the budget
+		size_t		mBytesPooled;	//!< memory held by the pool awaiting reuse
+		size_t		mBytesInUse;	//!< memory held by live Surfaces and Channels created by the pool
+	};
+
+	//! Constructs an empty SurfacePool, which is the equivalent of NULL and should not be used directly.
+	SurfacePool() {}
+	//! Creates a pool which retains at most \a budgetBytes of released memory
+	explicit SurfacePool( size_t budgetBytes );
+
+	//! Returns a Surface whose memory comes from the pool. Its pixels are uninitialized.
+	template<typename T>
+	SurfaceT<T>		createSurface( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints = SurfaceConstraintsDefault() );
+	//! Returns a Channel whose memory comes from the pool. Its pixels are uninitialized.
+	template<typename T>
+	ChannelT<T>		createChannel( int32_t width, int32_t height );
+
+	//! Returns the maximum amount of released memory the pool retains
+	size_t		getBudget() const;
+	//! Sets the maximum amount of released memory the pool retains, freeing pooled memory beyond it
+	void		setBudget( size_t budgetBytes );
+	//! Frees all pooled memory. Memory in use is unaffected.
+	void		clear();
+
+	Stats		getStats() const;
+	//! Zeroes the hit, miss, release and eviction counts
+	void		resetStats();
+
+	/// \cond
+	typedef std::shared_ptr<Obj> SurfacePool::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &SurfacePool::mObj; }
+	void reset() { mObj.reset(); }
+	/// \endcond
+
+  private:
+	static void		releaseBlock( void *refcon );
+
+	std::shared_ptr<Obj>	mObj;
+};
+
+} // namespace cinder
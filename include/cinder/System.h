@@ -34,16 +34,32 @@ namespace cinder {
 	Values are cached so there is low overhead in calling these functions more than once. **/
 class System {
  public:
+	/** \brief Successive x86 SIMD instruction sets, each of which implies support for those before it.
+		Setting the environment variable \c CINDER_SIMD to one of \c none, \c sse2, \c sse3, \c ssse3, \c sse4.1, \c sse4.2, \c avx or \c avx2
+		caps the instruction sets reported by hasSse2(), hasAvx() etc. to that level, which is useful for testing the fallback paths of SIMD code.
+	Names are matched case-insensitively; any other value prints a warning to \c std::cerr and is treated as \c none. **/
+	enum SimdLevel { SIMD_NONE, SIMD_SSE2, SIMD_SSE3, SIMD_SSSE3, SIMD_SSE4_1, SIMD_SSE4_2, SIMD_AVX, SIMD_AVX2 };
+
 	//! Returns whether the system supports the SSE2 instruction set.
 	static bool			hasSse2();
 	//! Returns whether the system supports the SSE3 instruction set.	
 	static bool			hasSse3();
+	//! Returns whether the system supports the SSSE3 (Supplemental SSE3) instruction set.
+	static bool			hasSsse3();
 	//! Returns whether the system supports the SSE4.1 instruction set.	
 	static bool			hasSse4_1();
 	//! Returns whether the system supports the SSE4.2 instruction set.		
 	static bool			hasSse4_2();
+	//! Returns whether the system supports the AVX instruction set, including operating system support for saving its registers.
+	static bool			hasAvx();
+	//! Returns whether the system supports the AVX2 instruction set.
+	static bool			hasAvx2();
+	//! Returns whether the system supports the FMA3 fused multiply-add instructions.
+	static bool			hasFma();
 	//! Returns whether the system supports the x86-64 instruction set.		
 	static bool			hasX86_64();
+	//! Returns the highest SIMD instruction set supported by the system. \sa SimdLevel
+	static SimdLevel	getSimdLevel();
 	//! Returns the number of physical processors in the system. A single processor dual core machine returns 1.
 	static int			getNumCpus();
 	//! Returns the number of cores (or logical processors) in the system. A single processor dual core machine returns 2.	
@@ -81,20 +97,23 @@ class System {
 	static std::string						getIpAddress();
 	
  private:
-	 enum {	HAS_SSE2, HAS_SSE3, HAS_SSE4_1, HAS_SSE4_2, HAS_X86_64, PHYSICAL_CPUS, LOGICAL_CPUS, OS_MAJOR, OS_MINOR, OS_BUGFIX, MULTI_TOUCH, MAX_MULTI_TOUCH_POINTS, TOTAL_CACHE_TYPES };
+	 enum {	HAS_SSE2, HAS_SSE3, HAS_SSSE3, HAS_SSE4_1, HAS_SSE4_2, HAS_AVX, HAS_AVX2, HAS_FMA, HAS_X86_64, PHYSICAL_CPUS, LOGICAL_CPUS, OS_MAJOR, OS_MINOR, OS_BUGFIX, MULTI_TOUCH, MAX_MULTI_TOUCH_POINTS, TOTAL_CACHE_TYPES };
 
 	System();
 	static std::shared_ptr<System>		instance();
 	static std::shared_ptr<System>		sInstance;
 
 	bool				mCachedValues[TOTAL_CACHE_TYPES];
-	bool				mHasSSE2, mHasSSE3, mHasSSE4_1, mHasSSE4_2, mHasX86_64;
+	bool				mHasSSE2, mHasSSE3, mHasSSSE3, mHasSSE4_1, mHasSSE4_2, mHasAVX, mHasAVX2, mHasFMA, mHasX86_64;
+	SimdLevel			mMaxSimdLevel; // the cap imposed by the CINDER_SIMD environment variable
 	int					mPhysicalCPUs, mLogicalCPUs;
 	int32_t				mOSMajorVersion, mOSMinorVersion, mOSBugFixVersion;
 	bool				mHasMultiTouch;
 	uint32_t			mMaxMultiTouchPoints;
-#if defined( CINDER_MSW )
+#if ! defined( CINDER_COCOA )
 	uint32_t			mCPUID_EBX, mCPUID_ECX, mCPUID_EDX;
+	uint32_t			mCPUID7_EBX; // structured extended features, leaf 7
+	uint32_t			mXCR0; // the OS-enabled register state, or 0 if XGETBV is unavailable
 #endif 
 };
 
@@ -23,6 +23,8 @@
 #pragma once
 
 #include "cinder/Cinder.h"
+#include "cinder/Function.h"
+#include "cinder/Area.h"
 #if defined( CINDER_COCOA )
 	#include "cinder/cocoa/CinderCocoa.h"
 #endif
@@ -31,6 +33,8 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/exception_ptr.hpp>
 
 // Promote classes from boost which will be part of std:: in C++1x where necessary
 namespace std {
@@ -58,4 +62,145 @@ class ThreadSetup {
 #endif
 };
 
+class TaskGroup;
+
+/*! The process-wide pool of worker threads which runs the tasks of TaskGroups, parallelFor() and runAsync(). It starts System::getNumCores() - 1 workers
+	on first use, since a thread which waits on tasks runs pending tasks itself rather than blocking, but at least one so that runAsync() makes progress
+	on a single core without anyone waiting. Each worker keeps its own queue of the tasks it spawns,
+	running the newest first, and steals the oldest tasks of the other queues when its own is empty. Tasks spawned by tasks therefore share the same
+	threads, so nested parallelism does not oversubscribe the cores. Tasks run through a TaskGroup or parallelFor() must not throw: an exception escaping
+	one calls std::terminate() on a worker thread, and leaves its TaskGroup never completing on a waiting thread. runAsync() hands exceptions to its Future instead. */
+class TaskScheduler : private boost::noncopyable {
+  public:
+	//! Returns the process-wide scheduler, starting its worker threads on first use
+	static TaskScheduler&	get();
+
+	//! Returns the number of worker threads, which excludes the threads waiting on tasks
+	int32_t		getNumWorkers() const;
+	//! Returns the number of threads parallelFor() splits work across, the calling thread included, which is the number of cores
+	int32_t		getConcurrency() const;
+	//! Returns whether the calling thread is one of the scheduler's workers
+	bool		isWorkerThread() const;
+
+  private:
+	TaskScheduler();
+	static void	create();
+
+	void		spawn( const std::function<void()> &fn, TaskGroup *group );
+	void		wait( const TaskGroup *group );
+	bool		isDone( const TaskGroup *group );
+
+	class Impl;
+	std::shared_ptr<Impl>	mImpl;
+
+	friend class TaskGroup;
+};
+
+/*! A set of tasks run by the TaskScheduler which can be waited on together. Waiting runs pending tasks rather than blocking, so a task may itself
+	run a TaskGroup and wait on it. Destroying a TaskGroup waits on its tasks. */
+class TaskGroup : private boost::noncopyable {
+  public:
+	TaskGroup() : mNumPending( 0 ) {}
+	~TaskGroup() { wait(); }
+
+	//! Schedules \a fn to run on any thread
+	void	run( const std::function<void()> &fn ) { TaskScheduler::get().spawn( fn, this ); }
+	//! Returns when every task run so far has completed, running pending tasks in the meantime
+	void	wait() { TaskScheduler::get().wait( this ); }
+	//! Returns whether every task run so far has completed
+	bool	isDone() const;
+
+  private:
+	int32_t		mNumPending; // guarded by the TaskScheduler
+
+	friend class TaskScheduler;
+};
+
+/*! Splits the indices [\a begin, \a end) into contiguous ranges of at least \a grainSize indices and calls \a rangeFn( rangeBegin, rangeEnd ) once per range
+	on the TaskScheduler, the calling thread included. Returns after every range has completed. */
+void parallelFor( int32_t begin, int32_t end, const std::function<void(int32_t,int32_t)> &rangeFn, int32_t grainSize = 1 );
+/*! Splits \a area into tiles of \a tileSize pixels, the last ones in each direction clipped to \a area, and calls \a tileFn( tile ) once per tile
+	on the TaskScheduler, the calling thread included. Returns after every tile has completed. */
+void parallelFor( const Area &area, const Vec2i &tileSize, const std::function<void(const Area&)> &tileFn );
+
+/*! The result of a function run by runAsync(), which becomes available once the function has completed. Waiting runs pending tasks rather than blocking.
+	An exception thrown by the function is rethrown by get(). Standard exceptions keep their type, while others arrive as boost::unknown_exception
+	unless thrown through boost::enable_current_exception(). Use a TaskGroup for functions which return nothing. \ImplShared */
+template<typename T>
+class Future {
+  public:
+	//! Constructs an empty Future, which is the equivalent of NULL and should not be used directly.
+	Future() {}
+
+	//! Returns whether the result is available
+	bool		isReady() const { return mObj->mGroup.isDone(); }
+	//! Returns when the result is available, running pending tasks in the meantime
+	void		wait() const { mObj->mGroup.wait(); }
+	//! Returns the result, waiting for it first. Rethrows the exception the function threw, if any.
+	const T&	get() const
+	{
+		wait();
+		if( mObj->mException )
+			boost::rethrow_exception( mObj->mException );
+		return mObj->mValue;
+	}
+
+	/// \cond
+	struct Obj {
+		TaskGroup				mGroup;
+		T						mValue;
+		boost::exception_ptr	mException;
+	};
+
+	typedef std::shared_ptr<Obj> Future::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &Future::mObj; }
+	void reset() { mObj.reset(); }
+	/// \endcond
+
+  private:
+	template<typename Y>
+	friend Future<Y> runAsync( const std::function<Y()> &fn );
+
+	// Stores the result of mFn in mObj
+	class Task {
+	  public:
+		Task( const std::shared_ptr<Obj> &obj, const std::function<T()> &fn ) : mObj( obj ), mFn( fn ) {}
+		void operator()() const
+		{
+			// caught here, as an exception escaping a worker thread terminates the process
+			try {
+				mObj->mValue = mFn();
+			}
+			catch( ... ) {
+				mObj->mException = boost::current_exception();
+			}
+		}
+
+	  private:
+		std::shared_ptr<Obj>		mObj;
+		std::function<T()>			mFn;
+	};
+
+	std::shared_ptr<Obj>	mObj;
+};
+
+/*! Runs \a fn on the TaskScheduler and returns the Future of its result. \a T can't be deduced from a functor, so name it explicitly,
+	as in <tt>runAsync<Surface>( std::bind( &loadSurface, path ) )</tt>. */
+template<typename T>
+Future<T> runAsync( const std::function<T()> &fn )
+{
+	Future<T> result;
+	result.mObj = std::shared_ptr<typename Future<T>::Obj>( new typename Future<T>::Obj );
+	// the task holds the Obj, so the result outlives a Future which is destroyed before the task runs
+	result.mObj->mGroup.run( typename Future<T>::Task( result.mObj, fn ) );
+	return result;
+}
+
+//! Runs the function \a fn on the TaskScheduler and returns the Future of its result
+template<typename T>
+Future<T> runAsync( T (*fn)() )
+{
+	return runAsync( std::function<T()>( fn ) );
+}
+
 } // namespace cinder
\ No newline at end of file
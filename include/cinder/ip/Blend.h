@@ -35,5 +35,9 @@ inline void blend( Surface *background, const Surface &foreground ) { blend( bac
 void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset = Vec2i::zero() );
 inline void blend( Surface32f *background, const Surface32f &foreground ) { blend( background, foreground, background->getBounds(), Vec2i::zero() ); }
 
+//! Equivalent to blend() but never uses the SIMD code paths. Serves as the reference implementation.
+void blendScalar( Surface *background, const Surface &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset = Vec2i::zero() );
+void blendScalar( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset = Vec2i::zero() );
+
 
 } } // namespace cinder::ip
\ No newline at end of file
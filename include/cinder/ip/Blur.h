@@ -0,0 +1,54 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+/*! Blurs \a srcSurface into \a dstSurface with a box filter spanning 2 * \a radius + 1 pixels in each direction. Costs O(1) per pixel regardless of \a radius.
+	Edge pixels are repeated beyond the bounds of the image. \a dstSurface may be the same as \a srcSurface. Alpha is blurred only when both Surfaces have it. */
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius );
+//! Blurs \a srcChannel into \a dstChannel with a box filter spanning 2 * \a radius + 1 pixels in each direction. \a dstChannel may be the same as \a srcChannel.
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius );
+
+/*! Blurs \a srcSurface into \a dstSurface with an approximation of a Gaussian of standard deviation \a sigma, built from three stacked box filters.
+	Costs O(1) per pixel regardless of \a sigma. \a dstSurface may be the same as \a srcSurface. */
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma );
+//! Blurs \a srcChannel into \a dstChannel with an approximation of a Gaussian of standard deviation \a sigma, built from three stacked box filters.
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma );
+
+//! Blurs \a srcSurface into \a dstSurface with a separable Gaussian of standard deviation \a sigma, truncated at 3 * \a sigma. Costs O(\a sigma) per pixel.
+template<typename T>
+void gaussianBlurExact( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma );
+//! Blurs \a srcChannel into \a dstChannel with a separable Gaussian of standard deviation \a sigma, truncated at 3 * \a sigma. Costs O(\a sigma) per pixel.
+template<typename T>
+void gaussianBlurExact( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma );
+
+} } // namespace cinder::ip
@@ -0,0 +1,115 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Color.h"
+#include "cinder/DataSource.h"
+#include "cinder/Surface.h"
+#include "cinder/Thread.h"
+
+#include <string>
+#include <vector>
+
+namespace cinder { namespace ip {
+
+/*! A 3D color lookup table: a lattice of getSize() colors along each of red, green and blue, between which colors are interpolated.
+	Loads the \c .cube format written by Resolve, Nuke, Photoshop and most other grading tools. \ImplShared */
+class ColorLut3d {
+  public:
+	enum Interpolation {
+		TRILINEAR,		//!< blends the 8 lattice colors surrounding a color
+		TETRAHEDRAL		//!< blends the 4 lattice colors of the tetrahedron containing a color, which is faster and keeps neutrals neutral
+	};
+
+	/// \cond
+	struct FixedTable;
+
+	struct Obj {
+		int32_t				mSize;
+		std::string			mTitle;
+		Colorf				mDomainMin, mDomainMax;
+		std::vector<Colorf>	mValues; // red varies fastest, then green, as in a .cube file
+
+		// fixed-point copy of mValues used for 8-bit Surfaces, built on first use and discarded by setValue()
+		std::shared_ptr<const FixedTable>	mFixedTable;
+		std::mutex							mFixedTableMutex;
+	};
+	/// \endcond
+
+	//! Constructs an empty ColorLut3d, which is the equivalent of NULL and should not be used directly.
+	ColorLut3d() {}
+	//! Constructs an identity ColorLut3d of \a size colors along each axis, over the domain [0,1]
+	explicit ColorLut3d( int32_t size );
+	//! Loads a ColorLut3d from the \c .cube file \a dataSource. Throws ColorLutExcInvalidFile if it is malformed or holds a 1D table.
+	explicit ColorLut3d( DataSourceRef dataSource );
+
+	//! Returns the number of colors along each axis of the lattice
+	int32_t				getSize() const { return mObj->mSize; }
+	//! Returns the title of the table, which is empty if its file had none
+	const std::string&	getTitle() const { return mObj->mTitle; }
+	//! Returns the input color which maps to the first lattice color. Inputs outside the domain are clamped to it.
+	const Colorf&		getDomainMin() const { return mObj->mDomainMin; }
+	//! Returns the input color which maps to the last lattice color
+	const Colorf&		getDomainMax() const { return mObj->mDomainMax; }
+
+	//! Returns the lattice color at index (\a r, \a g, \a b)
+	const Colorf&		getValue( int32_t r, int32_t g, int32_t b ) const { return mObj->mValues[( b * mObj->mSize + g ) * mObj->mSize + r]; }
+	//! Sets the lattice color at index (\a r, \a g, \a b). Tables are shared between copies, so this affects those too.
+	void				setValue( int32_t r, int32_t g, int32_t b, const Colorf &color );
+
+	//! Returns \a color mapped through the table
+	Colorf				lookup( const Colorf &color, Interpolation interpolation = TETRAHEDRAL ) const;
+
+	/// \cond
+	typedef std::shared_ptr<Obj> ColorLut3d::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &ColorLut3d::mObj; }
+	void reset() { mObj.reset(); }
+
+	// Returns the fixed-point copy of the table, building it if this is the first call since the table was last modified
+	std::shared_ptr<const FixedTable>	getFixedTable() const;
+	/// \endcond
+
+  private:
+	std::shared_ptr<Obj>	mObj;
+};
+
+/*! Maps the colors of \a surface through \a lut in place, leaving alpha untouched. Rows are processed across multiple threads.
+	8-bit Surfaces use a fixed-point copy of the table, which clamps lattice colors to [0,1]. It is built by the first call and reused until the table is modified. */
+template<typename T>
+void applyLut( SurfaceT<T> *surface, const ColorLut3d &lut, ColorLut3d::Interpolation interpolation = ColorLut3d::TETRAHEDRAL );
+//! Writes the colors of \a srcSurface mapped through \a lut to \a dstSurface, copying alpha if both have it. The two may differ in channel order.
+template<typename T>
+void applyLut( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ColorLut3d &lut, ColorLut3d::Interpolation interpolation = ColorLut3d::TETRAHEDRAL );
+
+class ColorLutExc : public std::exception {
+};
+
+class ColorLutExcInvalidFile : public ColorLutExc {
+	virtual const char* what() const throw() {
+		return "ColorLut3d exception: the file is not a valid 3D .cube table";
+	}
+};
+
+} } // namespace cinder::ip
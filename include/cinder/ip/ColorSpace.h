@@ -0,0 +1,59 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+/*! The color spaces rgbToColorSpace() and colorSpaceToRgb() convert between, and how each stores its three components. 8-bit components are
+	the float ones scaled by 255, except that 8-bit chroma is centered on 128 and that CS_LAB's L is scaled by 255/100 and its a and b offset by 128.
+	RGB is taken to be sRGB. */
+enum ColorSpace {
+	CS_HSV,					//!< hue, saturation and value in [0,1], as rgbToHSV() computes them
+	CS_YCBCR_601,			//!< BT.601 luma in [0,1] and chroma centered on 0.5, as JPEG uses
+	CS_YCBCR_601_LIMITED,	//!< BT.601 with video's headroom: luma in [16,235] and chroma in [16,240] centered on 128, out of 255
+	CS_YCBCR_709,			//!< BT.709 luma in [0,1] and chroma centered on 0.5
+	CS_YCBCR_709_LIMITED,	//!< BT.709 with video's headroom: luma in [16,235] and chroma in [16,240] centered on 128, out of 255
+	CS_LAB					//!< CIE L*a*b* under D65, with L in [0,100] and a and b roughly in [-128,127]
+};
+
+/*! Converts the RGB of \a srcSurface to \a space, storing the three components in the red, green and blue of \a dstSurface, which may be \a srcSurface.
+	Alpha is copied when both Surfaces have it. Rows are converted in blocks across multiple threads, with SIMD kernels where the machine has them;
+	8-bit Surfaces are converted in fixed point, through lookup tables for CS_LAB. Float components outside their usual range are not clamped. */
+template<typename T>
+void rgbToColorSpace( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, ColorSpace space );
+//! Converts the RGB of \a srcSurface to \a space, storing the three components in the planes \a dstChannel0, \a dstChannel1 and \a dstChannel2
+template<typename T>
+void rgbToColorSpace( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel0, ChannelT<T> *dstChannel1, ChannelT<T> *dstChannel2, ColorSpace space );
+//! Converts the components in \a space stored in the red, green and blue of \a srcSurface to RGB in \a dstSurface, which may be \a srcSurface
+template<typename T>
+void colorSpaceToRgb( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, ColorSpace space );
+//! Converts the components in \a space stored in the planes \a srcChannel0, \a srcChannel1 and \a srcChannel2 to RGB in \a dstSurface
+template<typename T>
+void colorSpaceToRgb( const ChannelT<T> &srcChannel0, const ChannelT<T> &srcChannel1, const ChannelT<T> &srcChannel2, SurfaceT<T> *dstSurface, ColorSpace space );
+
+} } // namespace cinder::ip
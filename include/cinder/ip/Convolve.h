@@ -0,0 +1,85 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! Determines how convolve() samples pixels beyond the edges of the source
+enum BorderMode {
+	BORDER_CLAMP,	//!< repeats the edge pixel: aaa|abcd|ddd
+	BORDER_WRAP,	//!< tiles the image: bcd|abcd|abc
+	BORDER_MIRROR	//!< reflects about the edge pixel: dcb|abcd|cba
+};
+
+/*! A convolution kernel of \a width x \a height weights, anchored at ( width / 2, height / 2 ). Kernels are applied as a correlation,
+	so that <tt>dst( x, y ) = bias + sum of weight( i, j ) * src( x + i - width / 2, y + j - height / 2 )</tt>. Whether the kernel
+	can be applied as two 1D passes is determined at construction. */
+class ConvolutionKernel {
+  public:
+	ConvolutionKernel() : mWidth( 0 ), mHeight( 0 ), mBias( 0 ), mSeparable( false ) {}
+	//! Creates a \a width x \a height kernel from the row-major array \a weights
+	ConvolutionKernel( int32_t width, int32_t height, const float *weights, float bias = 0 );
+	//! Creates the separable kernel <tt>weight( i, j ) = horizontal[i] * vertical[j]</tt>
+	ConvolutionKernel( const std::vector<float> &horizontal, const std::vector<float> &vertical, float bias = 0 );
+
+	int32_t		getWidth() const { return mWidth; }
+	int32_t		getHeight() const { return mHeight; }
+	float		getWeight( int32_t x, int32_t y ) const { return mWeights[y * mWidth + x]; }
+	//! Returns the row-major array of weights
+	const std::vector<float>&	getWeights() const { return mWeights; }
+
+	//! Returns the constant added to every result, in the units of the destination's channels
+	float		getBias() const { return mBias; }
+	void		setBias( float bias ) { mBias = bias; }
+
+	//! Returns whether the kernel is the outer product of a horizontal and a vertical kernel
+	bool		isSeparable() const { return mSeparable; }
+	//! Returns the horizontal factor of a separable kernel
+	const std::vector<float>&	getHorizontal() const { return mHorizontal; }
+	//! Returns the vertical factor of a separable kernel
+	const std::vector<float>&	getVertical() const { return mVertical; }
+
+  private:
+	void		findFactors();
+
+	int32_t				mWidth, mHeight;
+	std::vector<float>	mWeights, mHorizontal, mVertical;
+	float				mBias;
+	bool				mSeparable;
+};
+
+/*! Convolves \a srcSurface with \a kernel into \a dstSurface, sampling beyond the edges according to \a border. Separable kernels are applied as
+	two 1D passes. Alpha is convolved only when both Surfaces have it. \a dstSurface must not be \a srcSurface. */
+template<typename T>
+void convolve( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border = BORDER_CLAMP );
+//! Convolves \a srcChannel with \a kernel into \a dstChannel, sampling beyond the edges according to \a border. \a dstChannel must not be \a srcChannel.
+template<typename T>
+void convolve( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border = BORDER_CLAMP );
+
+} } // namespace cinder::ip
@@ -0,0 +1,63 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+//! Options for distanceTransform()
+class DistanceTransformOptions {
+  public:
+	enum Metric {
+		EUCLIDEAN,	//!< the exact Euclidean distance (Felzenszwalb & Huttenlocher), computed in separable passes across multiple threads
+		CHAMFER		//!< the 3-4 chamfer approximation of Euclidean distance, within 6%, computed in two raster scans on a single thread
+	};
+
+	DistanceTransformOptions() : mMetric( EUCLIDEAN ), mThreshold( 127 ), mSigned( false ) {}
+
+	//! Sets the distance metric. Default is \c EUCLIDEAN.
+	DistanceTransformOptions&	metric( Metric metric ) { mMetric = metric; return *this; }
+	//! Sets the value which foreground pixels must exceed. Default is \c 127.
+	DistanceTransformOptions&	threshold( uint8_t threshold ) { mThreshold = threshold; return *this; }
+	/*! Sets whether the result is a signed distance field: each background pixel's distance to the nearest foreground pixel less each foreground pixel's distance
+		to the nearest background pixel, so that the field is positive outside shapes and negative inside. Default is \c false. */
+	DistanceTransformOptions&	signedDistance( bool signedDistance = true ) { mSigned = signedDistance; return *this; }
+
+	Metric		getMetric() const { return mMetric; }
+	uint8_t		getThreshold() const { return mThreshold; }
+	bool		isSignedDistance() const { return mSigned; }
+
+  private:
+	Metric		mMetric;
+	uint8_t		mThreshold;
+	bool		mSigned;
+};
+
+/*! Writes to \a dstChannel the distance in pixels from each pixel of \a srcChannel to the nearest foreground pixel, which is \c 0 for the foreground pixels themselves.
+	Pixels are infinitely far from a Channel with no foreground. \a dstChannel should be the size of \a srcChannel. */
+void distanceTransform( const Channel8u &srcChannel, Channel32f *dstChannel, const DistanceTransformOptions &options = DistanceTransformOptions() );
+
+} } // namespace cinder::ip
@@ -24,6 +24,8 @@
 
 #include "cinder/Surface.h"
 
+#include <vector>
+
 namespace cinder { namespace ip {
 
 template<typename T>
@@ -35,4 +37,28 @@ void edgeDetectSobel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );
 template<typename T>
 void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSuface );
 
+/*! Computes the Sobel gradient of each pixel of \a srcChannel, replicating the edge pixels, and writes its magnitude to \a magnitude and, unless it is NULL, its direction
+	to \a direction. The direction is atan2( gradientY, gradientX ) in radians, accurate to about 0.0002, with y increasing down the Channel. Interior pixels are computed with SIMD
+	across multiple threads. The magnitude of a Channel8u's gradient is at most 1442. */
+void edgeDetectSobel( const Channel8u &srcChannel, Channel32f *magnitude, Channel32f *direction = 0 );
+
+/*! Canny edge detection. The Sobel gradient is thinned to its local maxima along the gradient direction, which are edges if their magnitude is at least
+	the high threshold or if they connect to such edges through maxima of at least the low threshold. Keeps its working memory between calls, so detecting the
+	edges of successive Channels of the same size allocates nothing. Noisy images should be blurred first, with gaussianBlur() for example. */
+class Canny {
+  public:
+	Canny() {}
+
+	/*! Writes \c 255 to \a dstChannel for each edge pixel of \a srcChannel and \c 0 elsewhere, including the outermost pixels. \a lowThreshold and \a highThreshold
+		are gradient magnitudes as edgeDetectSobel() computes them. */
+	void				detect( const Channel8u &srcChannel, Channel8u *dstChannel, float lowThreshold, float highThreshold );
+	//! Returns the Sobel gradient magnitude of the Channel last passed to detect()
+	const Channel32f&	getMagnitude() const { return mMagnitude; }
+
+  private:
+	Channel32f				mMagnitude;
+	Channel8u				mSectors; // the gradient direction of each pixel, quantized to 0 (horizontal), 1 (down-right), 2 (vertical) or 3 (up-right)
+	std::vector<int32_t>	mStack;
+};
+
 } } // namespace cinder::ip
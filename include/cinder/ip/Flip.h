@@ -30,5 +30,44 @@ namespace cinder { namespace ip {
 /** Flips the contents of \a surface vertically **/
 template<typename T>
 void flipVertical( SurfaceT<T> *surface );
+/** Flips the contents of \a channel vertically **/
+template<typename T>
+void flipVertical( ChannelT<T> *channel );
+
+/** Flips the contents of \a surface horizontally **/
+template<typename T>
+void flipHorizontal( SurfaceT<T> *surface );
+/** Flips the contents of \a channel horizontally **/
+template<typename T>
+void flipHorizontal( ChannelT<T> *channel );
+
+/** Rotates the contents of \a surface by 180 degrees in place **/
+template<typename T>
+void rotate180( SurfaceT<T> *surface );
+/** Rotates the contents of \a channel by 180 degrees in place **/
+template<typename T>
+void rotate180( ChannelT<T> *channel );
+
+/** Writes \a srcSurface rotated 90 degrees clockwise to \a dstSurface, which should be as wide as \a srcSurface is tall and vice versa.
+	The two may differ in channel order. Works through cache-sized tiles, transposing 4x4 blocks of 4-byte pixels in SSE2 registers. **/
+template<typename T>
+void rotate90( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+/** Writes \a srcChannel rotated 90 degrees clockwise to \a dstChannel, which should be as wide as \a srcChannel is tall and vice versa **/
+template<typename T>
+void rotate90( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );
+
+/** Writes \a srcSurface rotated 90 degrees counter-clockwise to \a dstSurface, which should be as wide as \a srcSurface is tall and vice versa **/
+template<typename T>
+void rotate270( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+/** Writes \a srcChannel rotated 90 degrees counter-clockwise to \a dstChannel, which should be as wide as \a srcChannel is tall and vice versa **/
+template<typename T>
+void rotate270( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );
+
+/** Writes the transpose of \a srcSurface to \a dstSurface, so that the pixel at (x, y) moves to (y, x) **/
+template<typename T>
+void transpose( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+/** Writes the transpose of \a srcChannel to \a dstChannel, so that the value at (x, y) moves to (y, x) **/
+template<typename T>
+void transpose( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );
 
 } } // namespace cinder::ip
@@ -33,5 +33,10 @@ void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
 //! Converts Surface \a srcSurface to grayscale and stores the result in Channel \a dstChannel. Uses primary weights dictated by the Rec. 709 Video Standard
 template<typename T>
 void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel );
+/*! Converts Surface \a srcSurface to grayscale at half its resolution and stores the result in Channel \a dstChannel, reading \a srcSurface only once.
+	Each pixel is the gray of the mean of a 2x2 block of \a srcSurface, whose last column or row is repeated when its width or height is odd,
+	so \a dstChannel should measure <tt>( width + 1 ) / 2</tt> by <tt>( height + 1 ) / 2</tt>. Uses the same weights as grayscale(). */
+template<typename T>
+void grayscaleDownsample( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel );
 
 } } // namespace cinder::ip
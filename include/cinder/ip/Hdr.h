@@ -34,4 +34,62 @@ void hdrNormalize( Channel32f *channel );
 /** Determines the minimum and maximum values of \a channel **/
 void getMinMax( const Channel32f &channel, float *resultMin, float *resultMax );
 
+//! Summary statistics of an HDR image, as returned by getStats(). Luminance uses the Rec. 709 weights.
+struct HdrStats {
+	float	mMin, mMax;			//!< the smallest and largest red, green or blue value
+	float	mMean;				//!< the mean of the red, green and blue values
+	float	mLogAverage;		//!< the log-average luminance, exp( mean( log( 0.0001 + luminance ) ) ), which Reinhard's operator maps to its key
+	float	mMaxLuminance;		//!< the largest luminance
+};
+
+//! Returns the HdrStats of \a surface, computed across multiple threads
+HdrStats getStats( const Surface32f &surface );
+//! Returns the HdrStats of \a channel, whose values are treated as luminance, computed across multiple threads
+HdrStats getStats( const Channel32f &channel );
+
+//! Options for toneMap()
+class ToneMapOptions {
+  public:
+	enum Operator {
+		LINEAR,			//!< exposure and gamma only; values above 1 are clipped
+		REINHARD,		//!< Reinhard et al.'s global photographic operator
+		REINHARD_LOCAL,	//!< Reinhard's operator, with each pixel's luminance compressed according to its Gaussian-blurred surround
+		FILMIC			//!< John Hable's filmic curve, applied to each color channel
+	};
+
+	ToneMapOptions() : mOperator( REINHARD ), mExposure( 0 ), mGamma( 2.2f ), mKey( 0.18f ), mWhite( 0 ), mLogAverage( 0 ), mLocalSigma( 8 ) {}
+
+	//! Sets the tone mapping operator. Default is \c REINHARD.
+	ToneMapOptions&	op( Operator op ) { mOperator = op; return *this; }
+	//! Scales the input by 2 ^ \a stops before the operator is applied. Default is \c 0.
+	ToneMapOptions&	exposure( float stops ) { mExposure = stops; return *this; }
+	//! Sets the display gamma the output is encoded for. Default is \c 2.2; \c 1 leaves the output linear.
+	ToneMapOptions&	gamma( float gamma ) { mGamma = gamma; return *this; }
+	//! Sets the value Reinhard's operators map the log-average luminance to. Default is \c 0.18.
+	ToneMapOptions&	key( float key ) { mKey = key; return *this; }
+	/*! Sets the white point. For Reinhard's operators this is the smallest key-scaled luminance mapped to pure white, with \c 0 meaning infinity.
+		For \c FILMIC it is the linear value mapped to white, with \c 0 meaning \c 11.2. Default is \c 0. */
+	ToneMapOptions&	white( float white ) { mWhite = white; return *this; }
+	//! Supplies the log-average luminance, typically a smoothed value from previous frames, rather than computing it from the source. Default is \c 0, which computes it.
+	ToneMapOptions&	logAverage( float logAverage ) { mLogAverage = logAverage; return *this; }
+	//! Sets the standard deviation in pixels of the surround used by \c REINHARD_LOCAL. Default is \c 8.
+	ToneMapOptions&	localSigma( float sigma ) { mLocalSigma = sigma; return *this; }
+
+	Operator	getOp() const { return mOperator; }
+	float		getExposure() const { return mExposure; }
+	float		getGamma() const { return mGamma; }
+	float		getKey() const { return mKey; }
+	float		getWhite() const { return mWhite; }
+	float		getLogAverage() const { return mLogAverage; }
+	float		getLocalSigma() const { return mLocalSigma; }
+
+  private:
+	Operator	mOperator;
+	float		mExposure, mGamma, mKey, mWhite, mLogAverage, mLocalSigma;
+};
+
+/*! Tone maps \a srcSurface into the 8-bit \a dstSurface in a single pass across multiple threads, applying exposure, the operator and gamma encoding to each pixel.
+	Only the Area common to both Surfaces is written. Alpha is scaled to 0-255 when both Surfaces have it, and is otherwise written as 255. */
+void toneMap( const Surface32f &srcSurface, Surface8u *dstSurface, const ToneMapOptions &options = ToneMapOptions() );
+
 } } // namespace cinder::ip
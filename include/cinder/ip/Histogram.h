@@ -0,0 +1,86 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+
+namespace cinder { namespace ip {
+
+/*! Counts the values of \a channel into \a histogram, which must hold 256 entries. The Channel is divided into bands which are counted
+	into private histograms on multiple threads and merged at the end. \a histogram is overwritten. */
+void histogram( const Channel8u &channel, uint32_t *histogram );
+/*! Counts the values of \a channel into the \a numBins entries of \a histogram, which divide [\a minValue, \a maxValue) equally. Values outside
+	the range are counted in the first or last bin. Runs across multiple threads as histogram( const Channel8u&, uint32_t* ) does. */
+void histogram( const Channel32f &channel, uint32_t *histogram, int32_t numBins = 256, float minValue = 0, float maxValue = 1 );
+//! Counts the red, green and blue values of \a surface into \a red, \a green and \a blue, each of which holds 256 entries or may be NULL. Reads the Surface once.
+void histogram( const Surface8u &surface, uint32_t *red, uint32_t *green, uint32_t *blue );
+//! Counts the red, green and blue values of \a surface into \a red, \a green and \a blue, each of which holds \a numBins entries or may be NULL. Binned as histogram( const Channel32f&, uint32_t*, int32_t, float, float ) is.
+void histogram( const Surface32f &surface, uint32_t *red, uint32_t *green, uint32_t *blue, int32_t numBins = 256, float minValue = 0, float maxValue = 1 );
+
+//! Equalizes the histogram of \a srcChannel, spreading its values across the full range, and stores the result in \a dstChannel, which may be \a srcChannel
+void equalizeHistogram( const Channel8u &srcChannel, Channel8u *dstChannel );
+//! Equalizes the histogram of \a srcChannel over \a numBins bins spanning [\a minValue, \a maxValue) and stores the result, which spans the same range, in \a dstChannel, which may be \a srcChannel
+void equalizeHistogram( const Channel32f &srcChannel, Channel32f *dstChannel, int32_t numBins = 256, float minValue = 0, float maxValue = 1 );
+//! Equalizes the combined histogram of the red, green and blue values of \a srcSurface, applying the same mapping to each, and stores the result in \a dstSurface, which may be \a srcSurface. Alpha is not written.
+void equalizeHistogram( const Surface8u &srcSurface, Surface8u *dstSurface );
+//! Equalizes the combined histogram of the red, green and blue values of \a srcSurface over \a numBins bins spanning [\a minValue, \a maxValue) and stores the result in \a dstSurface, which may be \a srcSurface. Alpha is not written.
+void equalizeHistogram( const Surface32f &srcSurface, Surface32f *dstSurface, int32_t numBins = 256, float minValue = 0, float maxValue = 1 );
+
+//! Options for clahe()
+class ClaheOptions {
+  public:
+	ClaheOptions() : mTilesX( 8 ), mTilesY( 8 ), mClipLimit( 2 ), mNumBins( 256 ), mMinValue( 0 ), mMaxValue( 1 ) {}
+
+	//! Sets the number of tiles the image is divided into horizontally and vertically. Default is \c 8 x \c 8.
+	ClaheOptions&	tiles( int32_t tilesX, int32_t tilesY ) { mTilesX = tilesX; mTilesY = tilesY; return *this; }
+	/*! Sets the largest count of any bin of a tile's histogram, as a multiple of the tile's mean count per bin. The excess is redistributed
+		across all bins, which limits how far noise in uniform areas is amplified. \c 0 disables clipping. Default is \c 2. */
+	ClaheOptions&	clipLimit( float limit ) { mClipLimit = limit; return *this; }
+	//! Sets the number of bins of a Channel32f's tile histograms. Default is \c 256. Channel8u histograms always have 256 bins.
+	ClaheOptions&	numBins( int32_t numBins ) { mNumBins = numBins; return *this; }
+	//! Sets the range of a Channel32f's values, which the result spans as well. Default is [\c 0, \c 1).
+	ClaheOptions&	range( float minValue, float maxValue ) { mMinValue = minValue; mMaxValue = maxValue; return *this; }
+
+	int32_t		getTilesX() const { return mTilesX; }
+	int32_t		getTilesY() const { return mTilesY; }
+	float		getClipLimit() const { return mClipLimit; }
+	int32_t		getNumBins() const { return mNumBins; }
+	float		getMinValue() const { return mMinValue; }
+	float		getMaxValue() const { return mMaxValue; }
+
+  private:
+	int32_t		mTilesX, mTilesY;
+	float		mClipLimit;
+	int32_t		mNumBins;
+	float		mMinValue, mMaxValue;
+};
+
+/*! Applies contrast-limited adaptive histogram equalization to \a srcChannel and stores the result in \a dstChannel, which may be \a srcChannel. The clipped
+	histogram of each tile is equalized in parallel, then each pixel is mapped by bilinearly interpolating the mappings of the four nearest tiles in a single pass. */
+void clahe( const Channel8u &srcChannel, Channel8u *dstChannel, const ClaheOptions &options = ClaheOptions() );
+//! Applies contrast-limited adaptive histogram equalization to \a srcChannel, binned according to \a options, and stores the result in \a dstChannel, which may be \a srcChannel
+void clahe( const Channel32f &srcChannel, Channel32f *dstChannel, const ClaheOptions &options = ClaheOptions() );
+
+} } // namespace cinder::ip
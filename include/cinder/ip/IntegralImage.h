@@ -0,0 +1,172 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Channel.h"
+#include "cinder/Area.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+/*! A summed-area table of a Channel, which answers the sum, mean and variance of the values in any Area in constant time. \a T is the type of the sums: 
+	\c uint32_t or \c uint64_t for a Channel8u, or \c double for either a Channel8u or a Channel32f. Integer sums wrap, but the sum of an Area is exact
+	so long as it fits in \a T, so an IntegralImage32u serves any Channel8u whose queried Areas hold fewer than 16843009 pixels. When constructed with
+	\a squares the table of squared values which variance() requires is built as well. Building runs across multiple threads. \ImplShared */
+template<typename T>
+class IntegralImageT {
+  public:
+	/// \cond
+	struct Obj {
+		Obj() : mWidth( 0 ), mHeight( 0 ), mHasSquares( false ) {}
+	
+		int32_t					mWidth, mHeight;
+		bool					mHasSquares;
+		// ( mWidth + 1 ) x ( mHeight + 1 ), with a leading row and column of zeros
+		std::vector<T>			mSums;
+		std::vector<double>		mSquares;
+	};
+	/// \endcond
+
+	//! Constructs an empty IntegralImage, which is the equivalent of NULL and should not be used directly.
+	IntegralImageT() {}
+	//! Builds the table of \a channel, and the table of its squared values if \a squares
+	template<typename Y>
+	explicit IntegralImageT( const ChannelT<Y> &channel, bool squares = false );
+
+	//! Rebuilds the tables from \a channel, reusing their memory. Tables which are shared with copies of the IntegralImage are updated in those too.
+	template<typename Y>
+	void	update( const ChannelT<Y> &channel );
+
+	//! Returns the width of the source Channel in pixels
+	int32_t		getWidth() const { return mObj->mWidth; }
+	//! Returns the height of the source Channel in pixels
+	int32_t		getHeight() const { return mObj->mHeight; }
+	//! Returns the bounding Area of the source Channel in pixels: [0,0]-(width,height)
+	Area		getBounds() const { return Area( 0, 0, mObj->mWidth, mObj->mHeight ); }
+	//! Returns whether the table of squared values has been built, which variance() and sumSquares() require
+	bool		hasSquares() const { return mObj->mHasSquares; }
+
+	//! Returns the sum of the values in \a area, clipped to getBounds()
+	T			sum( const Area &area ) const;
+	//! Returns the sum of the squared values in \a area, clipped to getBounds(). Throws IntegralImageExc unless hasSquares().
+	double		sumSquares( const Area &area ) const;
+	//! Returns the mean of the values in \a area, clipped to getBounds(), or \c 0 if it is empty
+	double		mean( const Area &area ) const;
+	//! Returns the variance of the values in \a area, clipped to getBounds(), or \c 0 if it is empty. Throws IntegralImageExc unless hasSquares().
+	double		variance( const Area &area ) const;
+
+	//! Writes the sums of the \a count Areas \a areas into \a results
+	void		sum( const Area *areas, size_t count, T *results ) const;
+	//! Writes the means of the \a count Areas \a areas into \a results
+	void		mean( const Area *areas, size_t count, double *results ) const;
+	//! Writes the variances of the \a count Areas \a areas into \a results. Throws IntegralImageExc unless hasSquares().
+	void		variance( const Area *areas, size_t count, double *results ) const;
+
+	//! Returns the table of sums. The entry at ( \a x, \a y ) is the sum of the values above and to the left of pixel ( \a x, \a y ) and each row holds getWidth() + 1 entries.
+	const T*		getData() const { return &mObj->mSums[0]; }
+	//! Returns the table of squared sums, laid out as getData(), or NULL unless hasSquares().
+	const double*	getSquaresData() const { return ( mObj->mHasSquares ) ? &mObj->mSquares[0] : 0; }
+
+	/// \cond
+	typedef std::shared_ptr<Obj> IntegralImageT::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &IntegralImageT::mObj; }
+	void reset() { mObj.reset(); }
+	/// \endcond
+
+  private:
+	// Clips \a area to the table, returning false if nothing remains
+	bool		clip( const Area &area, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2 ) const;
+	template<typename S>
+	static S	boxSum( const S *table, int32_t stride, int32_t x1, int32_t y1, int32_t x2, int32_t y2 )
+		{ return ( table[y2 * stride + x2] - table[y2 * stride + x1] ) - ( table[y1 * stride + x2] - table[y1 * stride + x1] ); }
+	
+	std::shared_ptr<Obj>	mObj;
+};
+
+typedef IntegralImageT<double>		IntegralImage;
+typedef IntegralImageT<uint32_t>	IntegralImage32u;
+typedef IntegralImageT<uint64_t>	IntegralImage64u;
+typedef IntegralImageT<double>		IntegralImage64f;
+
+class IntegralImageExc : public std::exception {
+	virtual const char* what() const throw() {
+		return "IntegralImage exception: the table of squared values was not built";
+	}
+};
+
+template<typename T>
+inline bool IntegralImageT<T>::clip( const Area &area, int32_t *x1, int32_t *y1, int32_t *x2, int32_t *y2 ) const
+{
+	*x1 = constrain<int32_t>( area.x1, 0, mObj->mWidth );
+	*y1 = constrain<int32_t>( area.y1, 0, mObj->mHeight );
+	*x2 = constrain<int32_t>( area.x2, 0, mObj->mWidth );
+	*y2 = constrain<int32_t>( area.y2, 0, mObj->mHeight );
+	return ( *x2 > *x1 ) && ( *y2 > *y1 );
+}
+
+template<typename T>
+inline T IntegralImageT<T>::sum( const Area &area ) const
+{
+	int32_t x1, y1, x2, y2;
+	if( ! clip( area, &x1, &y1, &x2, &y2 ) )
+		return 0;
+	return boxSum( &mObj->mSums[0], mObj->mWidth + 1, x1, y1, x2, y2 );
+}
+
+template<typename T>
+inline double IntegralImageT<T>::sumSquares( const Area &area ) const
+{
+	if( ! mObj->mHasSquares )
+		throw IntegralImageExc();
+	int32_t x1, y1, x2, y2;
+	if( ! clip( area, &x1, &y1, &x2, &y2 ) )
+		return 0;
+	return boxSum( &mObj->mSquares[0], mObj->mWidth + 1, x1, y1, x2, y2 );
+}
+
+template<typename T>
+inline double IntegralImageT<T>::mean( const Area &area ) const
+{
+	int32_t x1, y1, x2, y2;
+	if( ! clip( area, &x1, &y1, &x2, &y2 ) )
+		return 0;
+	return boxSum( &mObj->mSums[0], mObj->mWidth + 1, x1, y1, x2, y2 ) / ( (double)( x2 - x1 ) * ( y2 - y1 ) );
+}
+
+template<typename T>
+inline double IntegralImageT<T>::variance( const Area &area ) const
+{
+	if( ! mObj->mHasSquares )
+		throw IntegralImageExc();
+	int32_t x1, y1, x2, y2;
+	if( ! clip( area, &x1, &y1, &x2, &y2 ) )
+		return 0;
+	const double invCount = 1.0 / ( (double)( x2 - x1 ) * ( y2 - y1 ) );
+	const double mean = boxSum( &mObj->mSums[0], mObj->mWidth + 1, x1, y1, x2, y2 ) * invCount;
+	// rounding can take a uniform Area's variance slightly negative
+	return std::max( boxSum( &mObj->mSquares[0], mObj->mWidth + 1, x1, y1, x2, y2 ) * invCount - mean * mean, 0.0 );
+}
+
+} } // namespace cinder::ip
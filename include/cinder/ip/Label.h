@@ -0,0 +1,74 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+#include "cinder/Area.h"
+#include "cinder/Vector.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! Statistics of a connected component found by label()
+struct BlobStats {
+	uint32_t	mLabel;			//!< the value of the blob's pixels in the label Channel
+	uint32_t	mArea;			//!< the number of pixels
+	Area		mBounds;		//!< the bounding Area of the pixels
+	Vec2f		mCentroid;		//!< the mean position of the pixels, where the center of pixel ( x, y ) is ( x + 0.5, y + 0.5 )
+	float		mMu20;			//!< the variance of the pixels' x positions, their second central moment divided by mArea
+	float		mMu02;			//!< the variance of the pixels' y positions
+	float		mMu11;			//!< the covariance of the pixels' x and y positions. The blob's orientation is 0.5 * atan2( 2 * mMu11, mMu20 - mMu02 ).
+	float		mPerimeter;		//!< the number of pixel edges bordering the background or the edge of the Channel, scaled by pi / 4. This is unbiased for shapes of random orientation.
+};
+
+//! Options for label()
+class LabelOptions {
+  public:
+	LabelOptions() : mThreshold( 0 ), mConnectivity( 8 ), mTileHeight( 64 ) {}
+
+	//! Sets the value which foreground pixels must exceed, as ip::threshold() does. Default is \c 0.
+	LabelOptions&	threshold( uint8_t threshold ) { mThreshold = threshold; return *this; }
+	//! Sets whether pixels touching diagonally are connected, \c 8, or only those touching horizontally and vertically, \c 4. Default is \c 8.
+	LabelOptions&	connectivity( int32_t connectivity ) { mConnectivity = connectivity; return *this; }
+	//! Sets the height in rows of the tiles which are labeled concurrently before being merged along their borders. Default is \c 64.
+	LabelOptions&	tileHeight( int32_t rows ) { mTileHeight = rows; return *this; }
+
+	uint8_t		getThreshold() const { return mThreshold; }
+	int32_t		getConnectivity() const { return mConnectivity; }
+	int32_t		getTileHeight() const { return mTileHeight; }
+
+  private:
+	uint8_t		mThreshold;
+	int32_t		mConnectivity, mTileHeight;
+};
+
+/*! Labels the connected components of the foreground pixels of \a srcChannel, writing \c 0 to \a labels for the background and \c 1 through the number of components
+	for the pixels of each component, numbered in the order their first pixels appear scanning down the rows. Returns the number of components. If \a stats is not NULL
+	it is resized to the number of components and element \c i receives the BlobStats of label \c i + 1. Tiles are labeled concurrently with union-find, merged along their
+	borders and relabeled concurrently, gathering statistics as they go. */
+uint32_t label( const Channel8u &srcChannel, Channel32u *labels, std::vector<BlobStats> *stats = 0, const LabelOptions &options = LabelOptions() );
+
+} } // namespace cinder::ip
@@ -0,0 +1,46 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+/*! Erodes \a srcChannel, replacing each value with the minimum of the rectangle of \a kernelSize pixels around it, and stores the result in \a dstChannel, which may be \a srcChannel.
+	The rectangle is anchored at \a kernelSize / 2 and clipped at the edges of the Channel. The cost per pixel is independent of \a kernelSize (van Herk/Gil-Werman),
+	and 3x3 kernels take a single SIMD pass. Runs across multiple threads. */
+template<typename T>
+void erode( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize = Vec2i( 3, 3 ) );
+//! Dilates \a srcChannel, replacing each value with the maximum of the rectangle of \a kernelSize pixels around it, and stores the result in \a dstChannel, which may be \a srcChannel. Computed as erode() is.
+template<typename T>
+void dilate( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize = Vec2i( 3, 3 ) );
+//! Opens \a srcChannel, eroding and then dilating it with the same rectangle, which removes bright features smaller than \a kernelSize. Stores the result in \a dstChannel, which may be \a srcChannel.
+template<typename T>
+void open( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize = Vec2i( 3, 3 ) );
+//! Closes \a srcChannel, dilating and then eroding it with the same rectangle, which fills dark features smaller than \a kernelSize. Stores the result in \a dstChannel, which may be \a srcChannel.
+template<typename T>
+void close( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize = Vec2i( 3, 3 ) );
+
+} } // namespace cinder::ip
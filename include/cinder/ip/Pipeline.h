@@ -0,0 +1,93 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+/*! A sequence of point-wise and small-neighborhood ip operations which run fused. The image is processed in tiles of rows, each small enough that its
+	intermediate results stay in a core's cache, and the tiles are spread across multiple threads. Each operation reads the rows around a tile which
+	it needs, so the result is identical to calling the operations one after another on whole images:
+	\code
+	ip::Pipeline().grayscale().threshold( 128 ).edgeDetectSobel().flipVertical().run( surface, &magnitude );
+	\endcode */
+class Pipeline {
+  public:
+	Pipeline() : mTileBytes( 256 * 1024 ) {}
+
+	//! Appends grayscale(), which converts the source Surface to a Channel. Must be the first operation of a Pipeline run on a Surface, and of no other.
+	Pipeline&	grayscale();
+	//! Appends threshold(), which maps values greater than \a value to the maximum of their type and others to \c 0. \a value is converted to the type of the values.
+	Pipeline&	threshold( float value );
+	//! Appends edgeDetectSobel(), which converts a Channel8u to the Channel32f of its gradient magnitude
+	Pipeline&	edgeDetectSobel();
+	//! Appends erode() with the rectangle of \a kernelSize pixels
+	Pipeline&	erode( const Vec2i &kernelSize = Vec2i( 3, 3 ) );
+	//! Appends dilate() with the rectangle of \a kernelSize pixels
+	Pipeline&	dilate( const Vec2i &kernelSize = Vec2i( 3, 3 ) );
+	//! Appends flipVertical()
+	Pipeline&	flipVertical();
+
+	//! Sets the number of bytes each tile's intermediate results may occupy, which should fit in the L2 cache of a core. Default is 256k.
+	Pipeline&	tileBytes( size_t bytes ) { mTileBytes = bytes; return *this; }
+	//! Returns the number of bytes each tile's intermediate results may occupy
+	size_t		getTileBytes() const { return mTileBytes; }
+
+	/*! Runs the operations on \a srcSurface and stores the result in \a dstChannel, which should be the size of \a srcSurface and must not share its pixels. Throws PipelineExc
+		unless the first operation is grayscale() and each operation accepts the type its predecessor produces, and the last one produces \a Y. */
+	template<typename T, typename Y>
+	void	run( const SurfaceT<T> &srcSurface, ChannelT<Y> *dstChannel ) const;
+	/*! Runs the operations on \a srcChannel and stores the result in \a dstChannel, which should be the size of \a srcChannel and must not share its pixels. Throws PipelineExc
+		unless each operation accepts the type its predecessor produces and the last one produces \a Y. */
+	template<typename T, typename Y>
+	void	run( const ChannelT<T> &srcChannel, ChannelT<Y> *dstChannel ) const;
+
+	/// \cond
+	enum Op { GRAYSCALE, THRESHOLD, EDGE_DETECT_SOBEL, ERODE, DILATE, FLIP_VERTICAL };
+	struct Stage {
+		Stage( Op op, float value = 0, const Vec2i &kernelSize = Vec2i::zero() ) : mOp( op ), mValue( value ), mKernelSize( kernelSize ) {}
+
+		Op		mOp;
+		float	mValue;
+		Vec2i	mKernelSize;
+	};
+	/// \endcond
+
+  private:
+	std::vector<Stage>	mStages;
+	size_t				mTileBytes;
+};
+
+class PipelineExc : public std::exception {
+	virtual const char* what() const throw() {
+		return "Pipeline exception: the operations do not accept the types of the images";
+	}
+};
+
+} } // namespace cinder::ip
@@ -35,4 +35,14 @@ void premultiply( SurfaceT<T> *surface );
 template<typename T>
 void unpremultiply( SurfaceT<T> *surface );
 
+/** Copies \a srcSurface into \a dstSurface, premultiplying it by its alpha channel along the way, and marks \a dstSurface as being premultiplied.
+	Channel orders may differ. If \a srcSurface has no alpha channel its colors are copied unchanged. **/
+template<typename T>
+void premultiply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+
+/** Copies \a srcSurface into \a dstSurface, unpremultiplying it by its alpha channel along the way, and marks \a dstSurface as being unpremultiplied.
+	Channel orders may differ. If \a srcSurface has no alpha channel its colors are copied unchanged. **/
+template<typename T>
+void unpremultiply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+
 } } // namespace cinder::ip
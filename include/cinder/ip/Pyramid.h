@@ -0,0 +1,100 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+/*! A Gaussian pyramid or mip chain of a Surface: level 0 is a copy of the source and each further level is half the size of the one before it, rounded up.
+	Every level lives in one allocation, getSurface(), with level 0 at its left and the others stacked down its right, and each level is a sub-surface
+	of it. Levels are built across multiple threads by dedicated 2:1 downsampling kernels. \ImplShared */
+template<typename T>
+class PyramidT {
+  public:
+	enum Filter {
+		BOX,		//!< the mean of each 2x2 block, as for a mip chain
+		BINOMIAL	//!< the 5x5 binomial kernel, an approximation of a Gaussian, as for a Gaussian or Laplacian pyramid
+	};
+
+	/// \cond
+	struct Obj {
+		Filter						mFilter;
+		int32_t						mRequestedLevels; // 0 for every level down to 1x1
+		SurfaceT<T>					mSurface;
+		std::vector<SurfaceT<T> >	mLevels;
+	};
+	/// \endcond
+
+	//! Constructs an empty Pyramid, which is the equivalent of NULL and should not be used directly.
+	PyramidT() {}
+	//! Builds \a numLevels levels of \a surface, including \a surface itself. A \a numLevels of \c 0 builds every level down to 1x1.
+	explicit PyramidT( const SurfaceT<T> &surface, int32_t numLevels = 0, Filter filter = BINOMIAL );
+
+	/*! Rebuilds every level from \a surface, reusing their memory when \a surface has the size and channel order of level 0. Levels which are
+		shared with copies of the Pyramid, or held as Surfaces, are updated in those too. */
+	void	update( const SurfaceT<T> &surface );
+	//! Rebuilds levels 1 and up from level 0, for when its pixels have been written directly
+	void	update();
+
+	//! Returns the number of levels, including level 0
+	int32_t					getNumLevels() const { return (int32_t)mObj->mLevels.size(); }
+	//! Returns the filter the levels are built with
+	Filter					getFilter() const { return mObj->mFilter; }
+	//! Returns level \a level, where level 0 is the size of the source
+	SurfaceT<T>&			getLevel( int32_t level ) { return mObj->mLevels[level]; }
+	//! Returns level \a level, where level 0 is the size of the source
+	const SurfaceT<T>&		getLevel( int32_t level ) const { return mObj->mLevels[level]; }
+	//! Returns the Surface which holds every level, level 0 at its left and the others stacked down its right
+	const SurfaceT<T>&		getSurface() const { return mObj->mSurface; }
+
+	/// \cond
+	typedef std::shared_ptr<Obj> PyramidT::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &PyramidT::mObj; }
+	void reset() { mObj.reset(); }
+	/// \endcond
+
+  private:
+	void	allocate( int32_t width, int32_t height, const SurfaceChannelOrder &channelOrder, int32_t numLevels );
+
+	std::shared_ptr<Obj>	mObj;
+};
+
+typedef PyramidT<uint8_t>	Pyramid;
+typedef PyramidT<uint8_t>	Pyramid8u;
+typedef PyramidT<float>		Pyramid32f;
+
+/*! Writes to \a dstSurface \a srcSurface upsampled 2:1 by the binomial kernel which is the counterpart of PyramidT::BINOMIAL. \a dstSurface should be
+	the size of the level below \a srcSurface in a Pyramid, whose width and height are twice those of \a srcSurface or one less. */
+void pyramidExpand( const Surface32f &srcSurface, Surface32f *dstSurface );
+/*! Converts \a pyramid in place from a Gaussian pyramid to a Laplacian pyramid: every level but the last becomes the difference between itself and
+	the next level upsampled by pyramidExpand(). The last level is left as is. */
+void makeLaplacian( Pyramid32f *pyramid );
+//! Converts \a pyramid in place from a Laplacian pyramid back to a Gaussian pyramid, which reconstructs the original Surface as level 0
+void collapseLaplacian( Pyramid32f *pyramid );
+
+} } // namespace cinder::ip
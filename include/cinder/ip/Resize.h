@@ -40,4 +40,46 @@ SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, cons
 template<typename T>
 void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
 
+/*! Precomputes the filter weights for resizing the Area \a srcArea of images sized \a srcBounds into the Area \a dstArea of images sized \a dstBounds.
+	Reusing a plan skips rebuilding the weight tables on every resize of the same geometry. run() splits the destination into row bands processed on
+	worker threads, and may itself be called concurrently. */
+template<typename T>
+class ResizePlanT {
+	struct Obj;
+
+  public:
+	//! Constructs an empty ResizePlan, which is the equivalent of NULL and should not be used directly.
+	ResizePlanT() {}
+	ResizePlanT( const Area &srcBounds, const Area &srcArea, const Area &dstBounds, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+	//! Resizes the whole of a \a srcSize image to the whole of a \a dstSize image
+	ResizePlanT( const Vec2i &srcSize, const Vec2i &dstSize, const FilterBase &filter = FilterTriangle() );
+
+	//! Resizes \a srcSurface into \a dstSurface. Throws ResizePlanExc if their bounds differ from those the plan was created for.
+	void	run( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ) const;
+	//! Resizes \a srcChannel into \a dstChannel. Throws ResizePlanExc if their bounds differ from those the plan was created for.
+	void	run( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel ) const;
+
+	const Area&		getSrcBounds() const;
+	const Area&		getDstBounds() const;
+
+	/// \cond
+	typedef std::shared_ptr<Obj> ResizePlanT::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &ResizePlanT::mObj; }
+	void reset() { mObj.reset(); }
+	/// \endcond
+
+  private:
+	std::shared_ptr<Obj>	mObj;
+};
+
+typedef ResizePlanT<uint8_t>	ResizePlan;
+typedef ResizePlanT<uint8_t>	ResizePlan8u;
+typedef ResizePlanT<float>		ResizePlan32f;
+
+class ResizePlanExc : public std::exception {
+	virtual const char* what() const throw() {
+		return "ResizePlan exception: image bounds do not match the plan";
+	}
+};
+
 } } // namespace cinder::ip
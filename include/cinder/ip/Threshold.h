@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/IntegralImage.h"
 
 namespace cinder { namespace ip {
 
@@ -55,6 +56,49 @@ void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize );
 template<typename T>
 void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel );
 
+//! Options for the local-window adaptiveThreshold() functions which reuse an IntegralImage
+class AdaptiveThresholdOptions {
+  public:
+	enum Method {
+		MEAN,		//!< a pixel is set when it exceeds the mean of its window less the offset
+		SAUVOLA		//!< a pixel is set when it exceeds Sauvola's threshold, mean * ( 1 + k * ( stdDev / dynamicRange - 1 ) ), which also requires the table of squared values
+	};
+
+	AdaptiveThresholdOptions() : mMethod( MEAN ), mWindowSize( 15 ), mOffset( 0 ), mK( 0.2f ), mDynamicRange( 0.5f ) {}
+
+	//! Sets the thresholding method. Default is \c MEAN.
+	AdaptiveThresholdOptions&	method( Method method ) { mMethod = method; return *this; }
+	//! Sets the width and height of the square window centered on each pixel, which is clipped at the edges of the Channel. Default is \c 15.
+	AdaptiveThresholdOptions&	windowSize( int32_t windowSize ) { mWindowSize = windowSize; return *this; }
+	//! Sets the amount subtracted from the mean by \c MEAN, as a fraction of the Channel's maximum value. Default is \c 0.
+	AdaptiveThresholdOptions&	offset( float offset ) { mOffset = offset; return *this; }
+	//! Sets the sensitivity \a k of \c SAUVOLA, typically between \c 0.2 and \c 0.5. Default is \c 0.2.
+	AdaptiveThresholdOptions&	k( float k ) { mK = k; return *this; }
+	//! Sets the dynamic range of the standard deviation used by \c SAUVOLA, as a fraction of the Channel's maximum value. Default is \c 0.5, which is \c 128 for a Channel8u.
+	AdaptiveThresholdOptions&	dynamicRange( float range ) { mDynamicRange = range; return *this; }
+
+	Method		getMethod() const { return mMethod; }
+	int32_t		getWindowSize() const { return mWindowSize; }
+	float		getOffset() const { return mOffset; }
+	float		getK() const { return mK; }
+	float		getDynamicRange() const { return mDynamicRange; }
+
+  private:
+	Method		mMethod;
+	int32_t		mWindowSize;
+	float		mOffset, mK, mDynamicRange;
+};
+
+/*! Thresholds \a srcChannel against the mean or Sauvola threshold of the window around each pixel and stores the result in \a dstChannel, which may be \a srcChannel.
+	The work per pixel is constant regardless of the window size and runs across multiple threads. \a integralImage is updated from \a srcChannel, reusing its memory,
+	so passing the same IntegralImage each frame avoids any allocation once it has been built. It is built on the first call, with squared values for \c SAUVOLA.
+	\a SUMT may be \c uint32_t, \c uint64_t or \c double for a Channel8u and \c double for a Channel32f. */
+template<typename T, typename SUMT>
+void adaptiveThreshold( const ChannelT<T> &srcChannel, const AdaptiveThresholdOptions &options, IntegralImageT<SUMT> *integralImage, ChannelT<T> *dstChannel );
+//! Converts \a srcSurface to grayscale in \a dstChannel and thresholds it in place as adaptiveThreshold( const ChannelT<T>&, const AdaptiveThresholdOptions&, IntegralImageT<SUMT>*, ChannelT<T>* ) does
+template<typename T, typename SUMT>
+void adaptiveThreshold( const SurfaceT<T> &srcSurface, const AdaptiveThresholdOptions &options, IntegralImageT<SUMT> *integralImage, ChannelT<T> *dstChannel );
+
 template<typename T>
 class AdaptiveThresholdT {
  private:
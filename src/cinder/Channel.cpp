@@ -196,6 +196,21 @@ ChannelT<T> ChannelT<T>::clone( const Area &area, bool copyPixels ) const
 	return result;
 }
 
+template<typename T>
+ChannelT<T> ChannelT<T>::getSubChannel( const Area &area ) const
+{
+	Area clipped( area.getClipBy( getBounds() ) );
+	// an Area lying wholly outside the bounds clips to an inverted one, which yields an empty view of the first pixel
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		clipped = Area( 0, 0, 0, 0 );
+	T *data = const_cast<T*>( getData( clipped.getUL() ) );
+	
+	ChannelT result( clipped.getWidth(), clipped.getHeight(), getRowBytes(), getIncrement(), data );
+	result.mObj->mParent = mObj;
+	
+	return result;
+}
+
 
 template<typename T>
 void ChannelT<T>::copyFrom( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &relativeOffset )
@@ -247,6 +262,7 @@ T ChannelT<T>::areaAverage( const Area &area ) const
 
 template class ChannelT<uint8_t>;
 template class ChannelT<uint16_t>;
+template class ChannelT<uint32_t>;
 template class ChannelT<float>;
 
 } // namespace cinder
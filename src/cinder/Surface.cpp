@@ -23,12 +23,237 @@
 #include "cinder/Surface.h"
 #include "cinder/ImageIo.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/SimdDispatch.h"
 
 #include <boost/type_traits/is_same.hpp>
+#include <cstring>
 using boost::tribool;
 
 namespace cinder {
 
+namespace {
+
+void freeAlignedData( void *allocation )
+{
+	delete [] reinterpret_cast<uint8_t*>( allocation );
+}
+
+#if defined( CINDER_SSSE3 )
+
+// Reorders the channels of a row a register at a time with a byte shuffle. Built once per copy from the source and destination
+// channel orders; each destination byte either comes from the source byte named by mShuffle or, where mKeep is set, is left untouched.
+class SwizzleRow {
+  public:
+	SwizzleRow( const SurfaceChannelOrder &src, const SurfaceChannelOrder &dst, bool copyAlpha, int elementSize );
+
+	// Converts as many leading pixels of a row as whole 16-byte loads allow and returns how many that was
+	int32_t operator()( const uint8_t *src, uint8_t *dst, int32_t width ) const;
+
+  private:
+	uint8_t		mShuffle[16], mKeep[16];
+	bool		mKeepsDst;
+	int32_t		mPixelsPerLoad, mSrcPixelBytes, mDstPixelBytes;
+};
+
+SwizzleRow::SwizzleRow( const SurfaceChannelOrder &src, const SurfaceChannelOrder &dst, bool copyAlpha, int elementSize )
+{
+	const int numChannels = ( copyAlpha ) ? 4 : 3;
+	const uint8_t srcOffsets[4] = { src.getRedOffset(), src.getGreenOffset(), src.getBlueOffset(), src.getAlphaOffset() };
+	const uint8_t dstOffsets[4] = { dst.getRedOffset(), dst.getGreenOffset(), dst.getBlueOffset(), dst.getAlphaOffset() };
+	
+	// as many whole pixels as fit in a register when 4 channels wide
+	mPixelsPerLoad = 16 / ( 4 * elementSize );
+	mSrcPixelBytes = src.getPixelInc() * elementSize;
+	mDstPixelBytes = dst.getPixelInc() * elementSize;
+	
+	memset( mShuffle, 0x80, sizeof(mShuffle) ); // a set high bit zeroes the byte
+	memset( mKeep, 0xFF, sizeof(mKeep) );
+	for( int p = 0; p < mPixelsPerLoad; ++p ) {
+		for( int c = 0; c < numChannels; ++c ) {
+			for( int b = 0; b < elementSize; ++b ) {
+				const int dstByte = p * mDstPixelBytes + dstOffsets[c] * elementSize + b;
+				mShuffle[dstByte] = p * mSrcPixelBytes + srcOffsets[c] * elementSize + b;
+				mKeep[dstByte] = 0;
+			}
+		}
+	}
+
+	// only a 4-channel destination that isn't receiving alpha has bytes to preserve, namely its alpha or padding
+	mKeepsDst = ( ! copyAlpha ) && ( dst.getPixelInc() == 4 );
+}
+
+int32_t SwizzleRow::operator()( const uint8_t *src, uint8_t *dst, int32_t width ) const
+{
+	const __m128i shuffle = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mShuffle ) );
+	const __m128i keep = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mKeep ) );
+	const int32_t srcRowBytes = width * mSrcPixelBytes;
+	int32_t x = 0;
+	// every load reads 16 bytes, so stop while a whole register still lies within the source row
+	for( ; ( x + mPixelsPerLoad <= width ) && ( x * mSrcPixelBytes + 16 <= srcRowBytes ); x += mPixelsPerLoad ) {
+		__m128i result = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ), shuffle );
+		if( mDstPixelBytes * mPixelsPerLoad == 16 ) {
+			if( mKeepsDst )
+				result = _mm_or_si128( result, _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst ) ), keep ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), result );
+		}
+		else { // a 3-channel destination receives 12 bytes
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( dst ), result );
+			// dst + 8 is unaligned for an int32_t, so the last 4 bytes go through memcpy
+			const int32_t tail = _mm_cvtsi128_si32( _mm_srli_si128( result, 8 ) );
+			memcpy( dst + 8, &tail, 4 );
+		}
+		src += mPixelsPerLoad * mSrcPixelBytes;
+		dst += mPixelsPerLoad * mDstPixelBytes;
+	}
+	
+	return x;
+}
+
+// Whether SwizzleRow can be used between these channel orders on this machine
+bool canSwizzle( const SurfaceChannelOrder &src, const SurfaceChannelOrder &dst )
+{
+	return ( src.getPixelInc() >= 3 ) && ( dst.getPixelInc() >= 3 ) && System::hasSsse3();
+}
+
+#endif // defined( CINDER_SSSE3 )
+
+inline void convertValue( float v, float *dst ) { *dst = v; }
+inline void convertValue( float v, uint8_t *dst ) { *dst = (uint8_t)( constrain<float>( v, 0, 255 ) + 0.5f ); }
+inline void convertValue( float v, uint16_t *dst ) { *dst = (uint16_t)( constrain<float>( v, 0, 65535 ) + 0.5f ); }
+
+// Converts \a count channel values, rescaling from the range [0,CHANTRAIT<Y>::max()] to [0,CHANTRAIT<T>::max()]
+template<typename Y, typename T>
+void convertValues( const Y *src, T *dst, int32_t count )
+{
+	const float scale = CHANTRAIT<T>::max() / (float)CHANTRAIT<Y>::max();
+	for( int32_t i = 0; i < count; ++i )
+		convertValue( src[i] * scale, &dst[i] );
+}
+
+void convertValuesU8ToFloat( const uint8_t *src, float *dst, int32_t count )
+{
+	for( int32_t i = 0; i < count; ++i )
+		convertValue( src[i] * ( 1.0f / 255 ), &dst[i] );
+}
+
+void convertValuesFloatToU8( const float *src, uint8_t *dst, int32_t count )
+{
+	for( int32_t i = 0; i < count; ++i )
+		convertValue( src[i] * 255.0f, &dst[i] );
+}
+
+#if defined( CINDER_SSE2 )
+void convertValuesU8ToFloatSse2( const uint8_t *src, float *dst, int32_t count )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale4 = _mm_set1_ps( 1.0f / 255 );
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		const __m128i lo = _mm_unpacklo_epi8( v, zero ), hi = _mm_unpackhi_epi8( v, zero );
+		_mm_storeu_ps( dst + i, _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), scale4 ) );
+		_mm_storeu_ps( dst + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), scale4 ) );
+		_mm_storeu_ps( dst + i + 8, _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), scale4 ) );
+		_mm_storeu_ps( dst + i + 12, _mm_mul_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), scale4 ) );
+	}
+	convertValuesU8ToFloat( src + i, dst + i, count - i );
+}
+
+void convertValuesFloatToU8Sse2( const float *src, uint8_t *dst, int32_t count )
+{
+	const __m128 scale = _mm_set1_ps( 255.0f ), zero = _mm_setzero_ps(), half = _mm_set1_ps( 0.5f );
+	__m128i v[4];
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		// clamp, then round by truncation exactly as convertValue() does
+		for( int k = 0; k < 4; ++k ) {
+			const __m128 f = _mm_min_ps( _mm_max_ps( _mm_mul_ps( _mm_loadu_ps( src + i + k * 4 ), scale ), zero ), scale );
+			v[k] = _mm_cvttps_epi32( _mm_add_ps( f, half ) );
+		}
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( _mm_packs_epi32( v[0], v[1] ), _mm_packs_epi32( v[2], v[3] ) ) );
+	}
+	convertValuesFloatToU8( src + i, dst + i, count - i );
+}
+#endif // defined( CINDER_SSE2 )
+
+#if defined( CINDER_AVX2 )
+void convertValuesU8ToFloatAvx2( const uint8_t *src, float *dst, int32_t count )
+{
+	const __m256 scale8 = _mm256_set1_ps( 1.0f / 255 );
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		_mm256_storeu_ps( dst + i, _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( v ) ), scale8 ) );
+		_mm256_storeu_ps( dst + i + 8, _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_srli_si128( v, 8 ) ) ), scale8 ) );
+	}
+	_mm256_zeroupper();
+	convertValuesU8ToFloat( src + i, dst + i, count - i );
+}
+#endif // defined( CINDER_AVX2 )
+
+#if defined( CINDER_AVX )
+void convertValuesFloatToU8Avx( const float *src, uint8_t *dst, int32_t count )
+{
+	const __m256 scale = _mm256_set1_ps( 255.0f ), zero = _mm256_setzero_ps(), half = _mm256_set1_ps( 0.5f );
+	__m256i v[2];
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		for( int k = 0; k < 2; ++k ) {
+			const __m256 f = _mm256_min_ps( _mm256_max_ps( _mm256_mul_ps( _mm256_loadu_ps( src + i + k * 8 ), scale ), zero ), scale );
+			v[k] = _mm256_cvttps_epi32( _mm256_add_ps( f, half ) );
+		}
+		// AVX lacks 256-bit integer packs, so narrow each half with SSE2
+		const __m128i lo = _mm_packs_epi32( _mm256_castsi256_si128( v[0] ), _mm256_extractf128_si256( v[0], 1 ) );
+		const __m128i hi = _mm_packs_epi32( _mm256_castsi256_si128( v[1] ), _mm256_extractf128_si256( v[1], 1 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( lo, hi ) );
+	}
+	_mm256_zeroupper();
+	convertValuesFloatToU8( src + i, dst + i, count - i );
+}
+#endif // defined( CINDER_AVX )
+
+// The conversions between 8-bit and float channel values, resolved per machine through DispatchTable
+struct ConvertKernels {
+	void	(*mU8ToFloat)( const uint8_t *src, float *dst, int32_t count );
+	void	(*mFloatToU8)( const float *src, uint8_t *dst, int32_t count );
+
+	static void resolve( System::SimdLevel level, ConvertKernels *table )
+	{
+		table->mU8ToFloat = &convertValuesU8ToFloat;
+		table->mFloatToU8 = &convertValuesFloatToU8;
+#if defined( CINDER_SSE2 )
+		if( level >= System::SIMD_SSE2 ) {
+			table->mU8ToFloat = &convertValuesU8ToFloatSse2;
+			table->mFloatToU8 = &convertValuesFloatToU8Sse2;
+		}
+#endif
+#if defined( CINDER_AVX )
+		if( level >= System::SIMD_AVX )
+			table->mFloatToU8 = &convertValuesFloatToU8Avx;
+#endif
+#if defined( CINDER_AVX2 )
+		if( level >= System::SIMD_AVX2 )
+			table->mU8ToFloat = &convertValuesU8ToFloatAvx2;
+#endif
+	}
+};
+
+template<>
+void convertValues<uint8_t,float>( const uint8_t *src, float *dst, int32_t count )
+{
+	DispatchTable<ConvertKernels>::get().mU8ToFloat( src, dst, count );
+}
+
+template<>
+void convertValues<float,uint8_t>( const float *src, uint8_t *dst, int32_t count )
+{
+	DispatchTable<ConvertKernels>::get().mFloatToU8( src, dst, count );
+}
+
+} // anonymous namespace
+
 template<typename T>
 class ImageTargetSurface : public ImageTarget {
   public:
@@ -234,8 +459,7 @@ SurfaceT<T>::SurfaceT( int32_t aWidth, int32_t aHeight, bool alpha, const Surfac
 {
 	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( alpha );
 	int32_t rowBytes = constraints.getRowBytes( aWidth, channelOrder, sizeof(T) );
-	T *data = new T[aHeight * rowBytes];
-	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, true, rowBytes ) );
+	allocate( aWidth, aHeight, channelOrder, rowBytes, constraints.getDataAlignment() );
 }
 
 template<typename T>
@@ -250,6 +474,20 @@ SurfaceT<T>::SurfaceT( ImageSourceRef imageSource, const SurfaceConstraints &con
 	init( imageSource, constraints, alpha );
 }
 
+template<typename T>
+template<typename Y>
+SurfaceT<T>::SurfaceT( const SurfaceT<Y> &rhs )
+{
+	const SurfaceChannelOrder channelOrder = rhs.getChannelOrder();
+	const int32_t rowBytes = rhs.getWidth() * sizeof(T) * channelOrder.getPixelInc();
+	allocate( rhs.getWidth(), rhs.getHeight(), channelOrder, rowBytes, 0 );
+	mObj->mIsPremultiplied = rhs.isPremultiplied();
+
+	const int32_t rowValues = rhs.getWidth() * channelOrder.getPixelInc();
+	for( int32_t y = 0; y < rhs.getHeight(); ++y )
+		convertValues( rhs.getData( Vec2i( 0, y ) ), getData( Vec2i( 0, y ) ), rowValues );
+}
+
 template<typename T>
 SurfaceT<T>::operator ImageSourceRef() const
 {
@@ -282,12 +520,45 @@ SurfaceT<T> SurfaceT<T>::clone( const Area &area, bool copyPixels ) const
 	return result;
 }
 
+template<typename T>
+SurfaceT<T> SurfaceT<T>::getSubSurface( const Area &area ) const
+{
+	Area clipped( area.getClipBy( getBounds() ) );
+	// an Area lying wholly outside the bounds clips to an inverted one, which yields an empty view of the first pixel
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		clipped = Area( 0, 0, 0, 0 );
+	T *data = const_cast<T*>( getData( clipped.getUL() ) );
+	
+	SurfaceT result;
+	result.mObj = std::shared_ptr<Obj>( new Obj( clipped.getWidth(), clipped.getHeight(), getChannelOrder(), data, false, getRowBytes() ) );
+	result.mObj->mIsPremultiplied = isPremultiplied();
+	result.mObj->mParent = mObj;
+	
+	return result;
+}
+
 template<typename T>
 void SurfaceT<T>::setDeallocator( void(*aDeallocatorFunc)( void * ), void *aDeallocatorRefcon )
 {
 	mObj->setDeallocator( aDeallocatorFunc, aDeallocatorRefcon );
 }
 
+template<typename T>
+void SurfaceT<T>::allocate( int32_t width, int32_t height, SurfaceChannelOrder channelOrder, int32_t rowBytes, int32_t alignment )
+{
+	if( alignment <= 1 ) {
+		T *data = new T[height * rowBytes];
+		mObj = std::shared_ptr<Obj>( new Obj( width, height, channelOrder, data, true, rowBytes ) );
+	}
+	else {
+		// over-allocate and round up; the unaligned allocation is freed by the deallocator
+		uint8_t *allocation = new uint8_t[height * rowBytes + alignment - 1];
+		T *data = reinterpret_cast<T*>( ( reinterpret_cast<size_t>( allocation ) + alignment - 1 ) & ~( alignment - 1 ) );
+		mObj = std::shared_ptr<Obj>( new Obj( width, height, channelOrder, data, false, rowBytes ) );
+		mObj->setDeallocator( &freeAlignedData, allocation );
+	}
+}
+
 template<typename T>
 void SurfaceT<T>::init( ImageSourceRef imageSource, const SurfaceConstraints &constraints, boost::tribool alpha )
 {
@@ -304,9 +575,7 @@ void SurfaceT<T>::init( ImageSourceRef imageSource, const SurfaceConstraints &co
 	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( hasAlpha );
 	int32_t rowBytes = constraints.getRowBytes( width, channelOrder, sizeof(T) );
 	
-	T *data = new T[height * rowBytes];
-
-	mObj = std::shared_ptr<Obj>( new Obj( width, height, channelOrder, data, true, rowBytes ) );
+	allocate( width, height, channelOrder, rowBytes, constraints.getDataAlignment() );
 	mObj->mIsPremultiplied = imageSource->isPremultiplied();
 	
 	std::shared_ptr<ImageTargetSurface<T> > target = ImageTargetSurface<T>::createRef( this );
@@ -366,11 +635,23 @@ void SurfaceT<T>::copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcAre
 	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
 	
 	int32_t width = srcArea.getWidth();
+#if defined( CINDER_SSSE3 )
+	const bool simd = canSwizzle( srcSurface.getChannelOrder(), getChannelOrder() );
+	const SwizzleRow swizzle( srcSurface.getChannelOrder(), getChannelOrder(), true, sizeof(T) );
+#endif
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
 		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
+		int32_t x = 0;
+#if defined( CINDER_SSSE3 )
+		if( simd ) { // the shuffle converts as many pixels as it can; the scalar loop finishes the row
+			x = swizzle( reinterpret_cast<const uint8_t*>( src ), reinterpret_cast<uint8_t*>( dst ), width );
+			src += x * 4;
+			dst += x * 4;
+		}
+#endif
+		for( ; x < width; ++x ) {
 			dst[dstRed] = src[srcRed];
 			dst[dstGreen] = src[srcGreen];
 			dst[dstBlue] = src[srcBlue];
@@ -396,11 +677,23 @@ void SurfaceT<T>::copyRawRgb( const SurfaceT<T> &srcSurface, const Area &srcArea
 	const uint8_t dstBlue = getChannelOrder().getBlueOffset();
 	
 	int32_t width = srcArea.getWidth();
+#if defined( CINDER_SSSE3 )
+	const bool simd = canSwizzle( srcSurface.getChannelOrder(), getChannelOrder() );
+	const SwizzleRow swizzle( srcSurface.getChannelOrder(), getChannelOrder(), false, sizeof(T) );
+#endif
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
 		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
+		int32_t x = 0;
+#if defined( CINDER_SSSE3 )
+		if( simd ) { // the shuffle converts as many pixels as it can; the scalar loop finishes the row
+			x = swizzle( reinterpret_cast<const uint8_t*>( src ), reinterpret_cast<uint8_t*>( dst ), width );
+			src += x * srcPixelInc;
+			dst += x * dstPixelInc;
+		}
+#endif
+		for( ; x < width; ++x ) {
 			dst[dstRed] = src[srcRed];
 			dst[dstGreen] = src[srcGreen];
 			dst[dstBlue] = src[srcBlue];
@@ -509,4 +802,11 @@ void* ImageTargetSurface<T>::getRowPointer( int32_t row )
 
 BOOST_PP_SEQ_FOR_EACH( Surface_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
+template SurfaceT<uint8_t>::SurfaceT( const SurfaceT<uint16_t> &rhs );
+template SurfaceT<uint8_t>::SurfaceT( const SurfaceT<float> &rhs );
+template SurfaceT<uint16_t>::SurfaceT( const SurfaceT<uint8_t> &rhs );
+template SurfaceT<uint16_t>::SurfaceT( const SurfaceT<float> &rhs );
+template SurfaceT<float>::SurfaceT( const SurfaceT<uint8_t> &rhs );
+template SurfaceT<float>::SurfaceT( const SurfaceT<uint16_t> &rhs );
+
 } // namespace cinder
\ No newline at end of file
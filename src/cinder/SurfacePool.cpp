@@ -0,0 +1,222 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/SurfacePool.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <map>
+#include <new>
+#include <vector>
+#include <stdlib.h>
+
+namespace cinder {
+
+struct SurfacePool::Obj {
+	Obj( size_t budgetBytes ) : mBudget( budgetBytes ) {}
+	~Obj();
+
+	void*	acquire( size_t bytes );
+	void	release( void *data, size_t bytes );
+	// frees pooled memory, largest first, until no more than budgetBytes remain. Assumes mMutex is locked.
+	void	evict( size_t budgetBytes );
+
+	std::mutex								mMutex;
+	std::map<size_t,std::vector<void*> >	mBuckets;
+	size_t									mBudget;
+	Stats									mStats;
+};
+
+// Passed as the deallocator refcon of each Surface or Channel created by the pool, keeping the pool alive until the memory returns
+struct SurfacePool::Block {
+	std::shared_ptr<SurfacePool::Obj>	mPool;
+	void								*mData;
+	size_t								mBytes;
+};
+
+namespace {
+
+// Rounds \a bytes up to one of four size classes per power of two, wasting at most 25% of any allocation
+size_t sizeClass( size_t bytes )
+{
+	size_t base = 64;
+	if( bytes <= base )
+		return base;
+	while( base * 2 <= bytes )
+		base *= 2;
+	const size_t step = base / 4;
+	return ( bytes + step - 1 ) / step * step;
+}
+
+} // anonymous namespace
+
+SurfacePool::Obj::~Obj()
+{
+	evict( 0 );
+}
+
+void* SurfacePool::Obj::acquire( size_t bytes )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	std::map<size_t,std::vector<void*> >::iterator bucket = mBuckets.find( bytes );
+	void *result;
+	if( ( bucket != mBuckets.end() ) && ( ! bucket->second.empty() ) ) {
+		result = bucket->second.back();
+		bucket->second.pop_back();
+		mStats.mBytesPooled -= bytes;
+		++mStats.mHits;
+	}
+	else {
+		result = malloc( bytes );
+		// matches the new[] Surfaces and Channels otherwise allocate with
+		if( ! result )
+			throw std::bad_alloc();
+		++mStats.mMisses;
+	}
+	mStats.mBytesInUse += bytes;
+	
+	return result;
+}
+
+void SurfacePool::Obj::release( void *data, size_t bytes )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mStats.mBytesInUse -= bytes;
+	++mStats.mReleases;
+	if( bytes > mBudget ) {
+		free( data );
+		++mStats.mEvictions;
+		return;
+	}
+	
+	// the most recently released memory is the most likely to be needed again, so make room for it
+	evict( mBudget - bytes );
+	mBuckets[bytes].push_back( data );
+	mStats.mBytesPooled += bytes;
+}
+
+void SurfacePool::Obj::evict( size_t budgetBytes )
+{
+	std::map<size_t,std::vector<void*> >::reverse_iterator bucket = mBuckets.rbegin();
+	while( ( mStats.mBytesPooled > budgetBytes ) && ( bucket != mBuckets.rend() ) ) {
+		if( bucket->second.empty() ) {
+			++bucket;
+			continue;
+		}
+		free( bucket->second.back() );
+		bucket->second.pop_back();
+		mStats.mBytesPooled -= bucket->first;
+		++mStats.mEvictions;
+	}
+}
+
+SurfacePool::SurfacePool( size_t budgetBytes )
+	: mObj( new Obj( budgetBytes ) )
+{
+}
+
+template<typename T>
+SurfaceT<T> SurfacePool::createSurface( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints )
+{
+	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( alpha );
+	int32_t rowBytes = constraints.getRowBytes( width, channelOrder, sizeof(T) );
+	size_t alignment = std::max<int32_t>( constraints.getDataAlignment(), 1 );
+
+	// acquired before the Block is allocated, so that a failure leaks neither it nor its reference to the pool
+	const size_t bytes = sizeClass( height * rowBytes + alignment - 1 );
+	void *memory = mObj->acquire( bytes );
+	Block *block = new Block;
+	block->mPool = mObj;
+	block->mBytes = bytes;
+	block->mData = memory;
+
+	T *data = reinterpret_cast<T*>( ( reinterpret_cast<size_t>( block->mData ) + alignment - 1 ) & ~( alignment - 1 ) );
+	SurfaceT<T> result( data, width, height, rowBytes, channelOrder );
+	result.setDeallocator( &SurfacePool::releaseBlock, block );
+	
+	return result;
+}
+
+template<typename T>
+ChannelT<T> SurfacePool::createChannel( int32_t width, int32_t height )
+{
+	int32_t rowBytes = width * sizeof(T);
+
+	const size_t bytes = sizeClass( height * rowBytes );
+	void *memory = mObj->acquire( bytes );
+	Block *block = new Block;
+	block->mPool = mObj;
+	block->mBytes = bytes;
+	block->mData = memory;
+
+	ChannelT<T> result( width, height, rowBytes, 1, reinterpret_cast<T*>( block->mData ) );
+	result.setDeallocator( &SurfacePool::releaseBlock, block );
+	
+	return result;
+}
+
+void SurfacePool::releaseBlock( void *refcon )
+{
+	Block *block = reinterpret_cast<Block*>( refcon );
+	block->mPool->release( block->mData, block->mBytes );
+	delete block;
+}
+
+size_t SurfacePool::getBudget() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	return mObj->mBudget;
+}
+
+void SurfacePool::setBudget( size_t budgetBytes )
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	mObj->mBudget = budgetBytes;
+	mObj->evict( budgetBytes );
+}
+
+void SurfacePool::clear()
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	mObj->evict( 0 );
+}
+
+SurfacePool::Stats SurfacePool::getStats() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	return mObj->mStats;
+}
+
+void SurfacePool::resetStats()
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	mObj->mStats.mHits = mObj->mStats.mMisses = mObj->mStats.mReleases = mObj->mStats.mEvictions = 0;
+}
+
+#define SurfacePool_PROTOTYPES(r,data,T)\
+	template SurfaceT<T> SurfacePool::createSurface<T>( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints ); \
+	template ChannelT<T> SurfacePool::createChannel<T>( int32_t width, int32_t height );
+
+BOOST_PP_SEQ_FOR_EACH( SurfacePool_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} // namespace cinder
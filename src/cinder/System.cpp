@@ -57,10 +57,27 @@
 	#pragma pop_macro( "__STDC_CONSTANT_MACROS" )
 	namespace cinder {
 		void cpuidwrap( int *p, unsigned int param );
+		uint32_t xgetbvwrap();
 	}
+#elif defined( CINDER_LINUX )
+	#include <unistd.h>
+	#include <sys/utsname.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <netdb.h>
+	#include <ifaddrs.h>
+	#if defined( __i386__ ) || defined( __x86_64__ )
+		#include <cpuid.h>
+	#endif
+	#include <cstdio>
+	#include <fstream>
+	#include <set>
 #endif
 
 #include <string>
+#include <cstdlib>
+#include <iostream>
+#include <boost/algorithm/string/predicate.hpp>
 using namespace std;
 
 namespace cinder {
@@ -76,20 +93,83 @@ std::shared_ptr<System> System::instance()
 	return sInstance;
 }
 
+// Parses the CINDER_SIMD environment variable, which caps the instruction sets the System reports
+static System::SimdLevel getMaxSimdLevel()
+{
+	static const char *names[] = { "none", "sse2", "sse3", "ssse3", "sse4.1", "sse4.2", "avx", "avx2" };
+	const char *env = getenv( "CINDER_SIMD" );
+	if( ! env )
+		return System::SIMD_AVX2;
+
+	for( int l = System::SIMD_NONE; l <= System::SIMD_AVX2; ++l )
+		if( boost::iequals( env, names[l] ) )
+			return static_cast<System::SimdLevel>( l );
+
+	// a misspelled level shouldn't silently enable everything, so fall back to the scalar paths
+	cerr << "CINDER_SIMD: unknown level \"" << env << "\", expected one of";
+	for( int l = System::SIMD_NONE; l <= System::SIMD_AVX2; ++l )
+		cerr << " " << names[l];
+	cerr << "; disabling SIMD" << endl;
+	return System::SIMD_NONE;
+}
+
 System::System()
 {
 	for( size_t b = 0; b < TOTAL_CACHE_TYPES; ++b )
 		mCachedValues[b] = false;
+	mMaxSimdLevel = getMaxSimdLevel();
 		
 #if defined( CINDER_MSW )
 	int p[4];
+	cpuidwrap( p, 0 );
+	const int maxLeaf = p[0];
 	cpuidwrap( p, 1 );
 	mCPUID_EBX = p[1];
 	mCPUID_ECX = p[2];
 	mCPUID_EDX = p[3];
+	mCPUID7_EBX = 0;
+	if( maxLeaf >= 7 ) {
+		cpuidwrap( p, 7 );
+		mCPUID7_EBX = p[1];
+	}
+	// the AVX registers are only usable if the OS saves them on a context switch, per OSXSAVE and then XCR0
+	mXCR0 = ( mCPUID_ECX & ( 1 << 27 ) ) ? xgetbvwrap() : 0;
+#elif defined( CINDER_LINUX )
+	mCPUID_EBX = mCPUID_ECX = mCPUID_EDX = mCPUID7_EBX = mXCR0 = 0;
+	#if defined( __i386__ ) || defined( __x86_64__ )
+	unsigned int eax, ebx, ecx, edx;
+	if( __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) ) {
+		mCPUID_EBX = ebx;
+		mCPUID_ECX = ecx;
+		mCPUID_EDX = edx;
+	}
+	if( __get_cpuid_max( 0, 0 ) >= 7 ) {
+		__cpuid_count( 7, 0, eax, ebx, ecx, edx );
+		mCPUID7_EBX = ebx;
+	}
+	if( mCPUID_ECX & ( 1 << 27 ) ) {
+		// XGETBV by its encoding, for assemblers which predate it
+		uint32_t xcr0, xcr0High;
+		__asm__ __volatile__( ".byte 0x0f, 0x01, 0xd0" : "=a"( xcr0 ), "=d"( xcr0High ) : "c"( 0 ) );
+		mXCR0 = xcr0;
+	}
+	#endif
 #endif
 }
 
+#if defined( CINDER_LINUX )
+// Returns component \a index of the kernel release, such as 32 of "2.6.32-5-amd64"
+static int32_t getKernelVersion( int index )
+{
+	struct utsname name;
+	if( uname( &name ) != 0 )
+		throw SystemExcFailedQuery();
+	int version[3] = { 0, 0, 0 };
+	sscanf( name.release, "%d.%d.%d", &version[0], &version[1], &version[2] );
+	return version[index];
+}
+#endif
+
 #if defined( CINDER_COCOA )
 
 static std::string getSysCtlString( const std::string &key )
@@ -169,6 +249,7 @@ void cpuidwrap( int * p, unsigned int param )
    __asm {
              mov    edi, p
              mov    eax, param
+             xor    ecx, ecx
              cpuid
              mov    [edi+0d],  eax
              mov    [edi+4d],  ebx
@@ -177,6 +258,20 @@ void cpuidwrap( int * p, unsigned int param )
          }
 }
 
+// Returns the low word of XCR0; emitted as raw bytes since the Visual C++ 2010 inline assembler predates XGETBV
+uint32_t xgetbvwrap()
+{
+   uint32_t result;
+   __asm {
+             xor    ecx, ecx
+             _emit  0x0f
+             _emit  0x01
+             _emit  0xd0
+             mov    result, eax
+         }
+   return result;
+}
+
 void cpuid( int whichlp, PLOGICALPROCESSORDATA p )
 {
    unsigned int i, j, mask, numbits;
@@ -269,6 +364,7 @@ bool System::hasSse2()
 #else
 		instance()->mHasSSE2 = ( instance()->mCPUID_EDX & 0x04000000 ) != 0;
 #endif
+		instance()->mHasSSE2 = instance()->mHasSSE2 && ( instance()->mMaxSimdLevel >= SIMD_SSE2 );
 		instance()->mCachedValues[HAS_SSE2] = true;
 	}
 	
@@ -283,12 +379,28 @@ bool System::hasSse3()
 #else
 		instance()->mHasSSE3 = ( instance()->mCPUID_ECX & 0x00000001 ) != 0;
 #endif
+		instance()->mHasSSE3 = instance()->mHasSSE3 && ( instance()->mMaxSimdLevel >= SIMD_SSE3 );
 		instance()->mCachedValues[HAS_SSE3] = true;
 	}
 	
 	return instance()->mHasSSE3;
 }
 
+bool System::hasSsse3()
+{
+	if( ! instance()->mCachedValues[HAS_SSSE3] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasSSSE3 = ( getSysCtlValue<int>( "hw.optional.supplementalsse3" ) == 1 );
+#else
+		instance()->mHasSSSE3 = ( instance()->mCPUID_ECX & ( 1 << 9 ) ) != 0;
+#endif
+		instance()->mHasSSSE3 = instance()->mHasSSSE3 && ( instance()->mMaxSimdLevel >= SIMD_SSSE3 );
+		instance()->mCachedValues[HAS_SSSE3] = true;
+	}
+	
+	return instance()->mHasSSSE3;
+}
+
 bool System::hasSse4_1()
 {
 	if( ! instance()->mCachedValues[HAS_SSE4_1] ) {
@@ -297,6 +409,7 @@ bool System::hasSse4_1()
 #else
 		instance()->mHasSSE4_1 = ( instance()->mCPUID_ECX & ( 1 << 19 ) ) != 0;
 #endif
+		instance()->mHasSSE4_1 = instance()->mHasSSE4_1 && ( instance()->mMaxSimdLevel >= SIMD_SSE4_1 );
 		instance()->mCachedValues[HAS_SSE4_1] = true;
 	}
 	
@@ -311,12 +424,59 @@ bool System::hasSse4_2()
 #else
 		instance()->mHasSSE4_2 = ( instance()->mCPUID_ECX & ( 1 << 20 ) ) != 0;
 #endif
+		instance()->mHasSSE4_2 = instance()->mHasSSE4_2 && ( instance()->mMaxSimdLevel >= SIMD_SSE4_2 );
 		instance()->mCachedValues[HAS_SSE4_2] = true;
 	}
 	
 	return instance()->mHasSSE4_2;
 }
 
+bool System::hasAvx()
+{
+	if( ! instance()->mCachedValues[HAS_AVX] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasAVX = ( getSysCtlValue<int>( "hw.optional.avx1_0" ) == 1 );
+#else
+		instance()->mHasAVX = ( ( instance()->mCPUID_ECX & ( 1 << 28 ) ) != 0 ) && ( ( instance()->mXCR0 & 0x6 ) == 0x6 );
+#endif
+		instance()->mHasAVX = instance()->mHasAVX && ( instance()->mMaxSimdLevel >= SIMD_AVX );
+		instance()->mCachedValues[HAS_AVX] = true;
+	}
+	
+	return instance()->mHasAVX;
+}
+
+bool System::hasAvx2()
+{
+	if( ! instance()->mCachedValues[HAS_AVX2] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasAVX2 = ( getSysCtlValue<int>( "hw.optional.avx2_0" ) == 1 );
+#else
+		instance()->mHasAVX2 = ( instance()->mCPUID7_EBX & ( 1 << 5 ) ) != 0;
+#endif
+		instance()->mHasAVX2 = instance()->mHasAVX2 && hasAvx() && ( instance()->mMaxSimdLevel >= SIMD_AVX2 );
+		instance()->mCachedValues[HAS_AVX2] = true;
+	}
+	
+	return instance()->mHasAVX2;
+}
+
+bool System::hasFma()
+{
+	if( ! instance()->mCachedValues[HAS_FMA] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasFMA = ( getSysCtlValue<int>( "hw.optional.fma" ) == 1 );
+#else
+		instance()->mHasFMA = ( instance()->mCPUID_ECX & ( 1 << 12 ) ) != 0;
+#endif
+		// FMA3 shipped alongside AVX2, so a cap below AVX2 disables it too
+		instance()->mHasFMA = instance()->mHasFMA && hasAvx() && ( instance()->mMaxSimdLevel >= SIMD_AVX2 );
+		instance()->mCachedValues[HAS_FMA] = true;
+	}
+	
+	return instance()->mHasFMA;
+}
+
 bool System::hasX86_64()
 {
 	if( ! instance()->mCachedValues[HAS_X86_64] ) {
@@ -331,11 +491,34 @@ bool System::hasX86_64()
 	return instance()->mHasX86_64;
 }
 
+System::SimdLevel System::getSimdLevel()
+{
+	if( hasAvx2() ) return SIMD_AVX2;
+	else if( hasAvx() ) return SIMD_AVX;
+	else if( hasSse4_2() ) return SIMD_SSE4_2;
+	else if( hasSse4_1() ) return SIMD_SSE4_1;
+	else if( hasSsse3() ) return SIMD_SSSE3;
+	else if( hasSse3() ) return SIMD_SSE3;
+	else if( hasSse2() ) return SIMD_SSE2;
+	else return SIMD_NONE;
+}
+
 int System::getNumCpus()
 {
 	if( ! instance()->mCachedValues[PHYSICAL_CPUS] ) {
 #if defined( CINDER_COCOA )	
 		instance()->mPhysicalCPUs = getSysCtlValue<int>( "hw.packages" );
+#elif defined( CINDER_LINUX )
+		// the distinct physical ids of the processors listed, of which a machine without any has one
+		std::set<int> packages;
+		std::ifstream cpuInfo( "/proc/cpuinfo" );
+		std::string line;
+		while( std::getline( cpuInfo, line ) ) {
+			int id;
+			if( line.compare( 0, 11, "physical id" ) == 0 && sscanf( line.c_str() + line.find( ':' ) + 1, "%d", &id ) == 1 )
+				packages.insert( id );
+		}
+		instance()->mPhysicalCPUs = std::max<int>( (int)packages.size(), 1 );
 #else
 		const int MAX_NUMBER_OF_LOGICAL_PROCESSORS = 96;
 		const int MAX_NUMBER_OF_PHYSICAL_PROCESSORS = 8;
@@ -376,6 +559,8 @@ int System::getNumCores()
 	if( ! instance()->mCachedValues[LOGICAL_CPUS] ) {
 #if defined( CINDER_COCOA )	
 		instance()->mLogicalCPUs = getSysCtlValue<int>( "hw.logicalcpu" );
+#elif defined( CINDER_LINUX )
+		instance()->mLogicalCPUs = std::max<int>( (int)sysconf( _SC_NPROCESSORS_ONLN ), 1 );
 #else
 		::SYSTEM_INFO sys;
 		::GetSystemInfo( &sys );
@@ -396,6 +581,8 @@ int System::getOsMajorVersion()
 #elif defined( CINDER_COCOA )	
 		if( Gestalt(gestaltSystemVersionMajor, reinterpret_cast<SInt32*>( &(instance()->mOSMajorVersion) ) ) != noErr)
 			throw SystemExcFailedQuery();
+#elif defined( CINDER_LINUX )
+		instance()->mOSMajorVersion = getKernelVersion( 0 );
 #else
 		::OSVERSIONINFOEX info;
 		::ZeroMemory( &info, sizeof( OSVERSIONINFOEX ) );
@@ -418,6 +605,8 @@ int System::getOsMinorVersion()
 #elif defined( CINDER_COCOA )	
 		if( Gestalt(gestaltSystemVersionMinor, reinterpret_cast<SInt32*>( &(instance()->mOSMinorVersion) ) ) != noErr)
 			throw SystemExcFailedQuery();
+#elif defined( CINDER_LINUX )
+		instance()->mOSMinorVersion = getKernelVersion( 1 );
 #else
 		::OSVERSIONINFOEX info;
 		::ZeroMemory( &info, sizeof( OSVERSIONINFOEX ) );
@@ -443,6 +632,8 @@ int System::getOsBugFixVersion()
 #elif defined( CINDER_COCOA )	
 		if( Gestalt(gestaltSystemVersionBugFix, reinterpret_cast<SInt32*>( &(instance()->mOSBugFixVersion) ) ) != noErr)
 			throw SystemExcFailedQuery();
+#elif defined( CINDER_LINUX )
+		instance()->mOSBugFixVersion = getKernelVersion( 2 );
 #else
 		::OSVERSIONINFOEX info;
 		::ZeroMemory( &info, sizeof( OSVERSIONINFOEX ) );
@@ -471,6 +662,8 @@ bool System::hasMultiTouch()
 		int value = ::GetSystemMetrics( 94/*SM_DIGITIZER*/ );
 		instance()->mHasMultiTouch = (value & 0x00000080/*NID_READY*/ ) && 
 				( (value & 0x00000040/*NID_MULTI_INPUT*/ ) || (value & 0x00000001/*NID_INTEGRATED_TOUCH*/ ) );
+#else
+		instance()->mHasMultiTouch = false;
 #endif
 		instance()->mCachedValues[MULTI_TOUCH] = true;
 	}
@@ -487,6 +680,8 @@ int32_t System::getMaxMultiTouchPoints()
 		instance()->mMaxMultiTouchPoints = 6; // we don't seem to be able to query this at runtime; should be hardcoded based on the device
 #elif defined( CINDER_MSW )
 		instance()->mMaxMultiTouchPoints = ::GetSystemMetrics( 95/*SM_MAXIMUMTOUCHES*/ );
+#else
+		instance()->mMaxMultiTouchPoints = 0;
 #endif
 		instance()->mCachedValues[MAX_MULTI_TOUCH_POINTS] = true;
 	}
@@ -498,7 +693,7 @@ vector<System::NetworkAdapter> System::getNetworkAdapters()
 {
 	vector<System::NetworkAdapter> adapters;
 
-#if defined( CINDER_COCOA )
+#if defined( CINDER_COCOA ) || defined( CINDER_LINUX )
 	struct ifaddrs *interfaces = NULL;
 	struct ifaddrs *currentInterface = NULL;
 
@@ -506,14 +701,15 @@ vector<System::NetworkAdapter> System::getNetworkAdapters()
 	if( success == 0 ) {
 		currentInterface = interfaces;
 		while( currentInterface ) {
-			if( currentInterface->ifa_addr->sa_family == AF_INET ) {
+			// Linux lists interfaces without an address, too
+			if( currentInterface->ifa_addr && currentInterface->ifa_addr->sa_family == AF_INET ) {
 				char host[NI_MAXHOST];
 				int result = getnameinfo( currentInterface->ifa_addr,
                            (currentInterface->ifa_addr->sa_family == AF_INET) ? sizeof(struct sockaddr_in) : sizeof(struct sockaddr_in6),
                            host, NI_MAXHOST, NULL, 0, NI_NUMERICHOST );
-				if( result != 0 )
-					continue;
-				adapters.push_back( System::NetworkAdapter( currentInterface->ifa_name, host ) );
+				// skipping ahead to the next interface, as a bare continue would retry this one forever
+				if( result == 0 )
+					adapters.push_back( System::NetworkAdapter( currentInterface->ifa_name, host ) );
 			}
 			currentInterface = currentInterface->ifa_next;
 		}
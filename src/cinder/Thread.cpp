@@ -0,0 +1,324 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/Thread.h"
+#include "cinder/System.h"
+
+#include <boost/thread/tss.hpp>
+#include <boost/thread/once.hpp>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+namespace cinder {
+
+namespace {
+
+struct Task {
+	Task() : mNumPending( 0 ) {}
+	Task( const std::function<void()> &fn, int32_t *numPending ) : mFn( fn ), mNumPending( numPending ) {}
+
+	std::function<void()>	mFn;
+	int32_t					*mNumPending; // the count of its TaskGroup
+};
+
+// A queue of tasks. Its owner pushes and pops at the back, while other threads steal from the front.
+struct TaskQueue {
+	std::mutex			mMutex;
+	std::deque<Task>	mTasks;
+};
+
+// The index of the calling thread's queue, which is set only for the scheduler's workers
+boost::thread_specific_ptr<int32_t> sWorkerIndex;
+
+TaskScheduler *sScheduler = 0;
+boost::once_flag sSchedulerOnce = BOOST_ONCE_INIT;
+
+} // anonymous namespace
+
+class TaskScheduler::Impl {
+  public:
+	Impl( int32_t numWorkers, int32_t concurrency );
+
+	void	spawn( const std::function<void()> &fn, int32_t *numPending );
+	void	wait( const int32_t *numPending );
+	bool	isDone( const int32_t *numPending );
+
+	int32_t		getNumWorkers() const { return (int32_t)mWorkerQueues.size(); }
+	int32_t		getConcurrency() const { return mConcurrency; }
+
+  private:
+	void	workerLoop( int32_t index );
+	// Takes a task from the calling worker's own queue, then from the queue of threads which are not workers, and then from the other workers' queues
+	bool	takeTask( Task *task );
+	bool	runPendingTask();
+
+	std::vector<std::shared_ptr<TaskQueue> >	mWorkerQueues;
+	TaskQueue									mExternalQueue; // tasks spawned by threads which are not workers
+	std::vector<std::shared_ptr<std::thread> >	mThreads;
+	int32_t										mConcurrency;
+
+	// guards mNumQueued and the counts of pending tasks of TaskGroups; mWake is signaled when a task is queued or a TaskGroup completes
+	std::mutex					mMutex;
+	std::condition_variable		mWake;
+	int32_t						mNumQueued; // may be briefly negative while a task is taken before the count of its spawn lands
+};
+
+TaskScheduler::Impl::Impl( int32_t numWorkers, int32_t concurrency )
+	: mConcurrency( concurrency ), mNumQueued( 0 )
+{
+	for( int32_t w = 0; w < numWorkers; ++w )
+		mWorkerQueues.push_back( std::shared_ptr<TaskQueue>( new TaskQueue ) );
+	for( int32_t w = 0; w < numWorkers; ++w )
+		mThreads.push_back( std::shared_ptr<std::thread>( new std::thread( &Impl::workerLoop, this, w ) ) );
+}
+
+void TaskScheduler::Impl::spawn( const std::function<void()> &fn, int32_t *numPending )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		++*numPending;
+	}
+
+	TaskQueue &queue = ( sWorkerIndex.get() ) ? *mWorkerQueues[*sWorkerIndex] : mExternalQueue;
+	{
+		std::lock_guard<std::mutex> lock( queue.mMutex );
+		queue.mTasks.push_back( Task( fn, numPending ) );
+	}
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	++mNumQueued;
+	mWake.notify_one();
+}
+
+bool TaskScheduler::Impl::takeTask( Task *task )
+{
+	const int32_t numWorkers = getNumWorkers();
+	const int32_t self = ( sWorkerIndex.get() ) ? *sWorkerIndex : -1;
+	bool found = false;
+	if( self >= 0 ) {
+		TaskQueue &queue = *mWorkerQueues[self];
+		std::lock_guard<std::mutex> lock( queue.mMutex );
+		if( ! queue.mTasks.empty() ) {
+			*task = queue.mTasks.back();
+			queue.mTasks.pop_back();
+			found = true;
+		}
+	}
+	if( ! found ) {
+		std::lock_guard<std::mutex> lock( mExternalQueue.mMutex );
+		if( ! mExternalQueue.mTasks.empty() ) {
+			*task = mExternalQueue.mTasks.front();
+			mExternalQueue.mTasks.pop_front();
+			found = true;
+		}
+	}
+	for( int32_t i = 1; ( ! found ) && i <= numWorkers; ++i ) {
+		TaskQueue &queue = *mWorkerQueues[( self + i + numWorkers ) % numWorkers];
+		std::lock_guard<std::mutex> lock( queue.mMutex );
+		if( ! queue.mTasks.empty() ) {
+			*task = queue.mTasks.front();
+			queue.mTasks.pop_front();
+			found = true;
+		}
+	}
+
+	if( found ) {
+		std::lock_guard<std::mutex> lock( mMutex );
+		--mNumQueued;
+	}
+	return found;
+}
+
+bool TaskScheduler::Impl::runPendingTask()
+{
+	Task task;
+	if( ! takeTask( &task ) )
+		return false;
+
+	task.mFn();
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( --*task.mNumPending == 0 )
+			mWake.notify_all();
+	}
+	// the task's function is destroyed only now, as it may hold what owns the TaskGroup
+	return true;
+}
+
+void TaskScheduler::Impl::wait( const int32_t *numPending )
+{
+	while( true ) {
+		if( runPendingTask() )
+			continue;
+
+		std::unique_lock<std::mutex> lock( mMutex );
+		while( *numPending > 0 && mNumQueued <= 0 )
+			mWake.wait( lock );
+		if( *numPending == 0 )
+			return;
+	}
+}
+
+bool TaskScheduler::Impl::isDone( const int32_t *numPending )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return *numPending == 0;
+}
+
+void TaskScheduler::Impl::workerLoop( int32_t index )
+{
+	ThreadSetup threadSetup;
+	sWorkerIndex.reset( new int32_t( index ) );
+	while( true ) {
+		if( runPendingTask() )
+			continue;
+
+		std::unique_lock<std::mutex> lock( mMutex );
+		while( mNumQueued <= 0 )
+			mWake.wait( lock );
+	}
+}
+
+TaskScheduler::TaskScheduler()
+{
+	// a single core still gets a worker, as otherwise runAsync() tasks would only run once some thread waited on them
+	const int32_t numCores = std::max( System::getNumCores(), 1 );
+	mImpl = std::shared_ptr<Impl>( new Impl( std::max( numCores - 1, 1 ), numCores ) );
+}
+
+void TaskScheduler::create()
+{
+	// never destroyed, since its workers may be running until the process exits
+	sScheduler = new TaskScheduler;
+}
+
+TaskScheduler& TaskScheduler::get()
+{
+	boost::call_once( &TaskScheduler::create, sSchedulerOnce );
+	return *sScheduler;
+}
+
+int32_t TaskScheduler::getNumWorkers() const
+{
+	return mImpl->getNumWorkers();
+}
+
+int32_t TaskScheduler::getConcurrency() const
+{
+	return mImpl->getConcurrency();
+}
+
+bool TaskScheduler::isWorkerThread() const
+{
+	return sWorkerIndex.get() != 0;
+}
+
+void TaskScheduler::spawn( const std::function<void()> &fn, TaskGroup *group )
+{
+	mImpl->spawn( fn, &group->mNumPending );
+}
+
+void TaskScheduler::wait( const TaskGroup *group )
+{
+	mImpl->wait( &group->mNumPending );
+}
+
+bool TaskScheduler::isDone( const TaskGroup *group )
+{
+	return mImpl->isDone( &group->mNumPending );
+}
+
+bool TaskGroup::isDone() const
+{
+	return TaskScheduler::get().isDone( this );
+}
+
+namespace {
+
+class RangeTask {
+  public:
+	RangeTask( const std::function<void(int32_t,int32_t)> *rangeFn, int32_t begin, int32_t end ) : mRangeFn( rangeFn ), mBegin( begin ), mEnd( end ) {}
+	void operator()() const { (*mRangeFn)( mBegin, mEnd ); }
+
+  private:
+	const std::function<void(int32_t,int32_t)>	*mRangeFn;
+	int32_t										mBegin, mEnd;
+};
+
+// Calls the tile function for each of a range of tile indices, numbered across rows of tiles
+class TileRange {
+  public:
+	TileRange( const Area &area, const Vec2i &tileSize, int32_t tilesPerRow, const std::function<void(const Area&)> *tileFn )
+		: mArea( area ), mTileSize( tileSize ), mTilesPerRow( tilesPerRow ), mTileFn( tileFn )
+	{}
+
+	void operator()( int32_t begin, int32_t end ) const
+	{
+		for( int32_t t = begin; t < end; ++t ) {
+			const int32_t x1 = mArea.x1 + ( t % mTilesPerRow ) * mTileSize.x, y1 = mArea.y1 + ( t / mTilesPerRow ) * mTileSize.y;
+			(*mTileFn)( Area( x1, y1, std::min( x1 + mTileSize.x, mArea.x2 ), std::min( y1 + mTileSize.y, mArea.y2 ) ) );
+		}
+	}
+
+  private:
+	Area										mArea;
+	Vec2i										mTileSize;
+	int32_t										mTilesPerRow;
+	const std::function<void(const Area&)>		*mTileFn;
+};
+
+} // anonymous namespace
+
+void parallelFor( int32_t begin, int32_t end, const std::function<void(int32_t,int32_t)> &rangeFn, int32_t grainSize )
+{
+	const int32_t count = end - begin;
+	if( count <= 0 )
+		return;
+
+	// about four ranges per thread balance the load when ranges take unequal times
+	const int32_t numThreads = TaskScheduler::get().getConcurrency();
+	const int32_t numRanges = ( numThreads > 1 ) ? std::min( std::max( count / std::max( grainSize, 1 ), 1 ), numThreads * 4 ) : 1;
+	if( numRanges == 1 ) {
+		rangeFn( begin, end );
+		return;
+	}
+
+	TaskGroup group;
+	for( int32_t r = 1; r < numRanges; ++r )
+		group.run( RangeTask( &rangeFn, begin + (int32_t)( (int64_t)count * r / numRanges ), begin + (int32_t)( (int64_t)count * ( r + 1 ) / numRanges ) ) );
+	// the calling thread runs the first range itself, and then whichever tasks remain
+	rangeFn( begin, begin + count / numRanges );
+	group.wait();
+}
+
+void parallelFor( const Area &area, const Vec2i &tileSize, const std::function<void(const Area&)> &tileFn )
+{
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 || tileSize.x <= 0 || tileSize.y <= 0 )
+		return;
+
+	const int32_t tilesPerRow = ( area.getWidth() + tileSize.x - 1 ) / tileSize.x, tilesPerColumn = ( area.getHeight() + tileSize.y - 1 ) / tileSize.y;
+	parallelFor( 0, tilesPerRow * tilesPerColumn, TileRange( area, tileSize, tilesPerRow, &tileFn ) );
+}
+
+} // namespace cinder
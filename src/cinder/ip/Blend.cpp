@@ -23,6 +23,9 @@
 
 #include "cinder/ip/Blend.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/SimdDispatch.h"
 
 using namespace std;
 
@@ -35,8 +38,252 @@ namespace cinder { namespace ip {
 	αr×Cr = (1–αs)×Cd + (1–αd)×Cs + B(Cd, αd, Cs, αs)				Premult * Premult
 */
 
+// SIMD row kernels. Each blends as many leading pixels of a row as it can and returns that count; the caller finishes
+// the row with the scalar code, which remains the reference implementation.
+typedef int32_t (*BlendRowFunc_u8)( const uint8_t *src, uint8_t *dst, int32_t width, uint8_t alphaOffset );
+typedef int32_t (*BlendRowFunc_float)( const float *src, float *dst, int32_t width, uint8_t sR, uint8_t sG, uint8_t sB, uint8_t sA, uint8_t dR, uint8_t dG, uint8_t dB, uint8_t dA );
+
+#if defined( CINDER_SSE2 )
+
+// returns ( mask ) ? a : b per bit; SSE4.1 does this in a single instruction
+template<bool SSE4_1>
+inline __m128i select_si128( __m128i mask, __m128i a, __m128i b )
+{
+	return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) );
+}
+
+template<bool SSE4_1>
+inline __m128 select_ps( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+#if defined( CINDER_SSE4_1 )
+template<>
+inline __m128i select_si128<true>( __m128i mask, __m128i a, __m128i b )
+{
+	return _mm_blendv_epi8( b, a, mask );
+}
+
+template<>
+inline __m128 select_ps<true>( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_blendv_ps( b, a, mask );
+}
+#endif
+
+// Aligned loads and stores fault on unaligned addresses, so kernels only use them once the caller has verified alignment
+template<bool ALIGNED>
+inline __m128i load_si128( const void *p ) { return _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) ); }
+template<bool ALIGNED>
+inline void store_si128( void *p, __m128i v ) { _mm_storeu_si128( reinterpret_cast<__m128i*>( p ), v ); }
+template<bool ALIGNED>
+inline __m128 load_ps( const float *p ) { return _mm_loadu_ps( p ); }
+template<bool ALIGNED>
+inline void store_ps( float *p, __m128 v ) { _mm_storeu_ps( p, v ); }
+
+template<>
+inline __m128i load_si128<true>( const void *p ) { return _mm_load_si128( reinterpret_cast<const __m128i*>( p ) ); }
+template<>
+inline void store_si128<true>( void *p, __m128i v ) { _mm_store_si128( reinterpret_cast<__m128i*>( p ), v ); }
+template<>
+inline __m128 load_ps<true>( const float *p ) { return _mm_load_ps( p ); }
+template<>
+inline void store_ps<true>( float *p, __m128 v ) { _mm_store_ps( p, v ); }
+
+// Exactly floor( x / 255 ) for 16-bit lanes where x <= 255 * 255
+inline __m128i div255_epu16( __m128i x )
+{
+	return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( x, _mm_set1_epi16( 1 ) ), _mm_srli_epi16( x, 8 ) ), 8 );
+}
+
+// Blends the color channels of two pixels held in 16-bit lanes. The premultiplied destination formulas in blendImpl_u8
+// reduce to these same expressions, since invAlphaD + alphaD == 255.
+template<bool SRCPREMULT>
+inline __m128i blendColors_u8( __m128i s, __m128i d, __m128i alphaS )
+{
+	const __m128i invAlphaS = _mm_sub_epi16( _mm_set1_epi16( 255 ), alphaS );
+	if( SRCPREMULT ) // s + invAlphaS * d / 255, wrapping like the scalar uint8_t store
+		return _mm_and_si128( _mm_add_epi16( s, div255_epu16( _mm_mullo_epi16( invAlphaS, d ) ) ), _mm_set1_epi16( 0xFF ) );
+	else // ( invAlphaS * d + alphaS * s ) / 255
+		return div255_epu16( _mm_add_epi16( _mm_mullo_epi16( invAlphaS, d ), _mm_mullo_epi16( alphaS, s ) ) );
+}
+
+// Requires both surfaces to be 4 bytes per pixel with identical red, green, blue and alpha (or padding) offsets.
+// An alpha-less destination must be premultiplied or have no alpha; unpremultiplied destinations stay scalar.
+template<bool DSTALPHA, bool SRCPREMULT, bool SSE4_1, bool ALIGNED>
+int32_t blendRow_u8_sse( const uint8_t *src, uint8_t *dst, int32_t width, uint8_t alphaOffset )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lowByte = _mm_set1_epi32( 0xFF );
+	const __m128i alphaShift = _mm_cvtsi32_si128( alphaOffset * 8 );
+	const __m128i alphaLane = _mm_sll_epi32( lowByte, alphaShift ); // 0xFF in the alpha byte of each pixel
+	const int32_t simdWidth = width & ~3;
+
+	for( int32_t x = 0; x < simdWidth; x += 4 ) {
+		const __m128i s = load_si128<ALIGNED>( src );
+		const __m128i d = load_si128<ALIGNED>( dst );
+		// isolate alpha in the low byte of each 32-bit pixel, then replicate it across the pixel
+		const __m128i alphaS32 = _mm_and_si128( _mm_srl_epi32( s, alphaShift ), lowByte );
+		__m128i alphaS = _mm_or_si128( alphaS32, _mm_slli_epi32( alphaS32, 8 ) );
+		alphaS = _mm_or_si128( alphaS, _mm_slli_epi32( alphaS, 16 ) );
+
+		const __m128i colorsLo = blendColors_u8<SRCPREMULT>( _mm_unpacklo_epi8( s, zero ), _mm_unpacklo_epi8( d, zero ), _mm_unpacklo_epi8( alphaS, zero ) );
+		const __m128i colorsHi = blendColors_u8<SRCPREMULT>( _mm_unpackhi_epi8( s, zero ), _mm_unpackhi_epi8( d, zero ), _mm_unpackhi_epi8( alphaS, zero ) );
+		__m128i result = _mm_packus_epi16( colorsLo, colorsHi );
+
+		if( DSTALPHA ) {
+			// alphaR = 255 - invAlphaS * invAlphaD / 255; the products fit in the low 16 bits of each 32-bit lane
+			const __m128i invAlphaS32 = _mm_sub_epi32( lowByte, alphaS32 );
+			const __m128i invAlphaD32 = _mm_sub_epi32( lowByte, _mm_and_si128( _mm_srl_epi32( d, alphaShift ), lowByte ) );
+			const __m128i alphaR32 = _mm_sub_epi32( lowByte, div255_epu16( _mm_mullo_epi16( invAlphaS32, invAlphaD32 ) ) );
+			result = select_si128<SSE4_1>( alphaLane, _mm_sll_epi32( alphaR32, alphaShift ), result );
+			// a fully transparent result leaves the destination pixel untouched
+			result = select_si128<SSE4_1>( _mm_cmpeq_epi32( alphaR32, zero ), d, result );
+		}
+		else // preserve the destination's padding byte
+			result = select_si128<SSE4_1>( alphaLane, d, result );
+
+		store_si128<ALIGNED>( dst, result );
+		src += 4 * 4;
+		dst += 4 * 4;
+	}
+
+	return simdWidth;
+}
+
 template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
-void blendImpl_u8( Surface8u *background, const Surface8u &foreground, const Area &srcArea, Vec2i absOffset )
+inline __m128 blendChannel_float( __m128 s, __m128 d, __m128 alphaS, __m128 invAlphaS, __m128 alphaD, __m128 invAlphaD, __m128 invDstA )
+{
+	// operations are ordered as in blendImpl_float so that both paths round identically
+	if( ! DSTALPHA && ! SRCPREMULT ) // none * unpremult -> none
+		return _mm_add_ps( _mm_mul_ps( invAlphaS, d ), _mm_mul_ps( alphaS, s ) );
+	else if( ! DSTALPHA && SRCPREMULT ) // none * premult -> none
+		return _mm_add_ps( _mm_mul_ps( invAlphaS, d ), s );
+	else if( ! DSTPREMULT && ! SRCPREMULT ) // unpremult * unpremult -> unpremult
+		return _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_mul_ps( invAlphaS, alphaD ), d ), _mm_mul_ps( _mm_mul_ps( invAlphaD, alphaS ), s ) ), _mm_mul_ps( _mm_mul_ps( alphaD, alphaS ), s ) ), invDstA );
+	else if( ! DSTPREMULT && SRCPREMULT ) // unpremult * premult -> unpremult
+		return _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_mul_ps( invAlphaS, alphaD ), d ), _mm_mul_ps( invAlphaD, s ) ), _mm_mul_ps( alphaD, s ) ), invDstA );
+	else if( DSTPREMULT && SRCPREMULT ) // premult * premult -> premult
+		return _mm_add_ps( _mm_add_ps( _mm_mul_ps( invAlphaS, d ), _mm_mul_ps( invAlphaD, s ) ), _mm_mul_ps( alphaD, s ) );
+	else // premult * unpremult -> premult
+		return _mm_add_ps( _mm_add_ps( _mm_mul_ps( invAlphaS, d ), _mm_mul_ps( _mm_mul_ps( invAlphaD, alphaS ), s ) ), _mm_mul_ps( _mm_mul_ps( alphaD, alphaS ), s ) );
+}
+
+// Requires both surfaces to be 4 floats per pixel; channel orders may differ. Processes 4 pixels at a time by
+// transposing them into one register per channel.
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT, bool SSE4_1, bool ALIGNED>
+int32_t blendRow_float_sse( const float *src, float *dst, int32_t width, uint8_t sR, uint8_t sG, uint8_t sB, uint8_t sA, uint8_t dR, uint8_t dG, uint8_t dB, uint8_t dA )
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const int32_t simdWidth = width & ~3;
+
+	for( int32_t x = 0; x < simdWidth; x += 4 ) {
+		__m128 s[4], d[4];
+		s[0] = load_ps<ALIGNED>( src ); s[1] = load_ps<ALIGNED>( src + 4 ); s[2] = load_ps<ALIGNED>( src + 8 ); s[3] = load_ps<ALIGNED>( src + 12 );
+		d[0] = load_ps<ALIGNED>( dst ); d[1] = load_ps<ALIGNED>( dst + 4 ); d[2] = load_ps<ALIGNED>( dst + 8 ); d[3] = load_ps<ALIGNED>( dst + 12 );
+		_MM_TRANSPOSE4_PS( s[0], s[1], s[2], s[3] );
+		_MM_TRANSPOSE4_PS( d[0], d[1], d[2], d[3] );
+
+		const __m128 alphaS = s[sA];
+		const __m128 invAlphaS = _mm_sub_ps( one, alphaS );
+		const __m128 alphaD = ( DSTALPHA ) ? d[dA] : one;
+		const __m128 invAlphaD = ( DSTALPHA ) ? _mm_sub_ps( one, d[dA] ) : zero;
+		__m128 alphaR = one, invDstA = one, keep = zero;
+		if( DSTALPHA ) {
+			alphaR = _mm_sub_ps( one, _mm_mul_ps( invAlphaS, invAlphaD ) );
+			keep = _mm_cmpeq_ps( alphaR, zero ); // a fully transparent result leaves the destination colors untouched
+			if( ! DSTPREMULT )
+				invDstA = _mm_div_ps( one, alphaR );
+		}
+
+		const __m128 red = blendChannel_float<DSTALPHA,DSTPREMULT,SRCPREMULT>( s[sR], d[dR], alphaS, invAlphaS, alphaD, invAlphaD, invDstA );
+		const __m128 green = blendChannel_float<DSTALPHA,DSTPREMULT,SRCPREMULT>( s[sG], d[dG], alphaS, invAlphaS, alphaD, invAlphaD, invDstA );
+		const __m128 blue = blendChannel_float<DSTALPHA,DSTPREMULT,SRCPREMULT>( s[sB], d[dB], alphaS, invAlphaS, alphaD, invAlphaD, invDstA );
+		if( DSTALPHA ) {
+			d[dR] = select_ps<SSE4_1>( keep, d[dR], red );
+			d[dG] = select_ps<SSE4_1>( keep, d[dG], green );
+			d[dB] = select_ps<SSE4_1>( keep, d[dB], blue );
+			d[dA] = alphaR;
+		}
+		else {
+			d[dR] = red;
+			d[dG] = green;
+			d[dB] = blue;
+		}
+
+		_MM_TRANSPOSE4_PS( d[0], d[1], d[2], d[3] );
+		store_ps<ALIGNED>( dst, d[0] ); store_ps<ALIGNED>( dst + 4, d[1] ); store_ps<ALIGNED>( dst + 8, d[2] ); store_ps<ALIGNED>( dst + 12, d[3] );
+		src += 4 * 4;
+		dst += 4 * 4;
+	}
+
+	return simdWidth;
+}
+
+#endif // defined( CINDER_SSE2 )
+
+// Returns whether every row of the region of \a surface at \a offset begins on a 16-byte boundary
+template<typename T>
+bool rowsAligned( const SurfaceT<T> &surface, const Vec2i &offset )
+{
+	return ( ( reinterpret_cast<size_t>( surface.getData( offset ) ) | surface.getRowBytes() ) & 15 ) == 0;
+}
+
+// The SIMD row kernels for one combination of blend modes, resolved per machine through DispatchTable. Each array is
+// indexed by whether rows are 16-byte aligned, and holds NULL where the machine offers no kernel.
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+struct BlendKernels {
+	BlendRowFunc_u8		mRow_u8[2];
+	BlendRowFunc_float	mRow_float[2];
+
+	static void resolve( System::SimdLevel level, BlendKernels *table )
+	{
+		table->mRow_u8[0] = table->mRow_u8[1] = NULL;
+		table->mRow_float[0] = table->mRow_float[1] = NULL;
+#if defined( CINDER_SSE2 )
+		if( level >= System::SIMD_SSE2 ) {
+			table->mRow_u8[0] = &blendRow_u8_sse<DSTALPHA,SRCPREMULT,false,false>;
+			table->mRow_u8[1] = &blendRow_u8_sse<DSTALPHA,SRCPREMULT,false,true>;
+			table->mRow_float[0] = &blendRow_float_sse<DSTALPHA,DSTPREMULT,SRCPREMULT,false,false>;
+			table->mRow_float[1] = &blendRow_float_sse<DSTALPHA,DSTPREMULT,SRCPREMULT,false,true>;
+		}
+#endif
+#if defined( CINDER_SSE4_1 )
+		if( level >= System::SIMD_SSE4_1 ) {
+			table->mRow_u8[0] = &blendRow_u8_sse<DSTALPHA,SRCPREMULT,true,false>;
+			table->mRow_u8[1] = &blendRow_u8_sse<DSTALPHA,SRCPREMULT,true,true>;
+			table->mRow_float[0] = &blendRow_float_sse<DSTALPHA,DSTPREMULT,SRCPREMULT,true,false>;
+			table->mRow_float[1] = &blendRow_float_sse<DSTALPHA,DSTPREMULT,SRCPREMULT,true,true>;
+		}
+#endif
+	}
+};
+
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+BlendRowFunc_u8 selectRowFunc_u8( const Surface8u &background, const Surface8u &foreground, bool aligned )
+{
+	const SurfaceChannelOrder &src = foreground.getChannelOrder(), &dst = background.getChannelOrder();
+	if( ( ! foreground.hasAlpha() ) || ( src.getPixelInc() != 4 ) || ( dst.getPixelInc() != 4 ) )
+		return NULL;
+	if( ( src.getRedOffset() != dst.getRedOffset() ) || ( src.getGreenOffset() != dst.getGreenOffset() ) || ( src.getBlueOffset() != dst.getBlueOffset() ) )
+		return NULL;
+	if( DSTALPHA && ( ( ! DSTPREMULT ) || ( src.getAlphaOffset() != dst.getAlphaOffset() ) ) ) // unpremultiplied destinations require a true divide
+		return NULL;
+	return DispatchTable<BlendKernels<DSTALPHA,DSTPREMULT,SRCPREMULT> >::get().mRow_u8[aligned];
+}
+
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+BlendRowFunc_float selectRowFunc_float( const Surface32f &background, const Surface32f &foreground, bool aligned )
+{
+	if( ( ! foreground.hasAlpha() ) || ( foreground.getPixelInc() != 4 ) || ( background.getPixelInc() != 4 ) )
+		return NULL;
+	return DispatchTable<BlendKernels<DSTALPHA,DSTPREMULT,SRCPREMULT> >::get().mRow_float[aligned];
+}
+
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+void blendImpl_u8( Surface8u *background, const Surface8u &foreground, const Area &srcArea, Vec2i absOffset, BlendRowFunc_u8 rowFunc )
 {
 	bool SRCALPHA = foreground.hasAlpha();
 	const int32_t srcRowBytes = foreground.getRowBytes();
@@ -64,7 +311,13 @@ void blendImpl_u8( Surface8u *background, const Surface8u &foreground, const Are
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const uint8_t *src = reinterpret_cast<const uint8_t*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
 		uint8_t *dst = reinterpret_cast<uint8_t*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
-		for( int32_t x = 0; x < width; ++x ) {
+		int32_t x = 0;
+		if( rowFunc ) { // the SIMD kernel handles as many pixels as it can; the remainder falls through to the scalar loop
+			x = (*rowFunc)( src, dst, width, sA );
+			src += x * srcInc;
+			dst += x * dstInc;
+		}
+		for( ; x < width; ++x ) {
 			const uint8_t alphaS = (SRCALPHA) ? src[sA] : 255;
 			const uint8_t invAlphaS = (SRCALPHA) ? CHANTRAIT<uint8_t>::inverse(src[sA]) : 0;
 			const uint8_t alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<uint8_t>::max();
@@ -110,7 +363,7 @@ void blendImpl_u8( Surface8u *background, const Surface8u &foreground, const Are
 }
 
 template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
-void blendImpl_float( Surface32f *background, const Surface32f &foreground, const Area &srcArea, Vec2i absOffset )
+void blendImpl_float( Surface32f *background, const Surface32f &foreground, const Area &srcArea, Vec2i absOffset, BlendRowFunc_float rowFunc )
 {
 	bool SRCALPHA = foreground.hasAlpha();
 	const int32_t srcRowBytes = foreground.getRowBytes();
@@ -138,7 +391,13 @@ void blendImpl_float( Surface32f *background, const Surface32f &foreground, cons
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const float *src = reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
 		float *dst = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
-		for( int32_t x = 0; x < width; ++x ) {
+		int32_t x = 0;
+		if( rowFunc ) {
+			x = (*rowFunc)( src, dst, width, sR, sG, sB, sA, dR, dG, dB, dA );
+			src += x * srcInc;
+			dst += x * dstInc;
+		}
+		for( ; x < width; ++x ) {
 			const float alphaS = (SRCALPHA) ? src[sA] : 1;
 			const float invAlphaS = (SRCALPHA) ? CHANTRAIT<float>::inverse(src[sA]) : 0;
 			const float alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<float>::max();
@@ -185,54 +444,90 @@ void blendImpl_float( Surface32f *background, const Surface32f &foreground, cons
 	}
 }
 
-void blend( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+void blendRows_u8( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &absOffset, bool allowSimd )
+{
+	const bool aligned = rowsAligned( *background, absOffset ) && rowsAligned( foreground, srcArea.getUL() );
+	BlendRowFunc_u8 rowFunc = ( allowSimd ) ? selectRowFunc_u8<DSTALPHA,DSTPREMULT,SRCPREMULT>( *background, foreground, aligned ) : NULL;
+	blendImpl_u8<DSTALPHA,DSTPREMULT,SRCPREMULT>( background, foreground, srcArea, absOffset, rowFunc );
+}
+
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+void blendRows_float( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &absOffset, bool allowSimd )
+{
+	const bool aligned = rowsAligned( *background, absOffset ) && rowsAligned( foreground, srcArea.getUL() );
+	BlendRowFunc_float rowFunc = ( allowSimd ) ? selectRowFunc_float<DSTALPHA,DSTPREMULT,SRCPREMULT>( *background, foreground, aligned ) : NULL;
+	blendImpl_float<DSTALPHA,DSTPREMULT,SRCPREMULT>( background, foreground, srcArea, absOffset, rowFunc );
+}
+
+void blend_u8( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset, bool allowSimd )
 {
 	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );	
 	if( background->hasAlpha() ) {
 		if( background->isPremultiplied() ) {
 			if( foreground.isPremultiplied() )
-				blendImpl_u8<true, true, true>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_u8<true, true, true>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 			else
-				blendImpl_u8<true, true, false>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_u8<true, true, false>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 		}
 		else { // background unpremult
 			if( foreground.isPremultiplied() )
-				blendImpl_u8<true, false, true>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_u8<true, false, true>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 			else
-				blendImpl_u8<true, false, false>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_u8<true, false, false>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 		}
 	}
 	else { // background no alpha
 		if( foreground.isPremultiplied() )
-			blendImpl_u8<false, false, true>( background, foreground, srcDst.first, srcDst.second );
+			blendRows_u8<false, false, true>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 		else
-			blendImpl_u8<false, false, false>( background, foreground, srcDst.first, srcDst.second );	
+			blendRows_u8<false, false, false>( background, foreground, srcDst.first, srcDst.second, allowSimd );	
 	}
 }
 
-void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+void blend_float( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset, bool allowSimd )
 {
 	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );
 	if( background->hasAlpha() ) {
 		if( background->isPremultiplied() ) {
 			if( foreground.isPremultiplied() )
-				blendImpl_float<true, true, true>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_float<true, true, true>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 			else
-				blendImpl_float<true, true, false>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_float<true, true, false>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 		}
 		else {
 			if( foreground.isPremultiplied() )
-				blendImpl_float<true, false, true>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_float<true, false, true>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 			else
-				blendImpl_float<true, false, false>( background, foreground, srcDst.first, srcDst.second );
+				blendRows_float<true, false, false>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 		}
 	}
 	else { // background no alpha
 		if( foreground.isPremultiplied() )
-			blendImpl_float<false, false, true>( background, foreground, srcDst.first, srcDst.second );
+			blendRows_float<false, false, true>( background, foreground, srcDst.first, srcDst.second, allowSimd );
 		else
-			blendImpl_float<false, false, false>( background, foreground, srcDst.first, srcDst.second );	
+			blendRows_float<false, false, false>( background, foreground, srcDst.first, srcDst.second, allowSimd );	
 	}
 }
 
-} } // namespace cinder::ip
\ No newline at end of file
+void blend( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+{
+	blend_u8( background, foreground, srcArea, dstRelativeOffset, true );
+}
+
+void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+{
+	blend_float( background, foreground, srcArea, dstRelativeOffset, true );
+}
+
+void blendScalar( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+{
+	blend_u8( background, foreground, srcArea, dstRelativeOffset, false );
+}
+
+void blendScalar( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+{
+	blend_float( background, foreground, srcArea, dstRelativeOffset, false );
+}
+
+} } // namespace cinder::ip
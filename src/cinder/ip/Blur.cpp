@@ -0,0 +1,330 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Blur.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/ChanTraits.h"
+
+#include "ImagePlane.h"
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+using std::vector;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+template<typename T> inline T fromFloat( float v );
+template<> inline uint8_t fromFloat<uint8_t>( float v ) { return ( v <= 0 ) ? 0 : ( ( v >= 255 ) ? 255 : static_cast<uint8_t>( v + 0.5f ) ); }
+template<> inline float fromFloat<float>( float v ) { return v; }
+
+// Repeats the first and last of the \a width pixels in \a row into the \a pad pixels on either side of them
+inline void padRow( float *row, int32_t width, int32_t numChannels, int32_t pad )
+{
+	const float *first = row + pad * numChannels, *last = row + ( pad + width - 1 ) * numChannels;
+	for( int32_t p = 0; p < pad; ++p ) {
+		for( int32_t c = 0; c < numChannels; ++c ) {
+			row[p * numChannels + c] = first[c];
+			row[( pad + width + p ) * numChannels + c] = last[c];
+		}
+	}
+}
+
+// Stacked box filters, each pass maintaining a running sum so its cost is independent of the radius
+class BoxRowFilter {
+  public:
+	explicit BoxRowFilter( const vector<int32_t> &radii )
+		: mRadii( radii ), mPad( *std::max_element( radii.begin(), radii.end() ) )
+	{}
+
+	int32_t		getPad() const { return mPad; }
+
+	// Filters the \a width pixels of \a a, which are padded by getPad() pixels on either side, using \a b as scratch space of the same size.
+	// Returns whichever of the two holds the result.
+	float*		apply( float *a, float *b, int32_t width, int32_t numChannels ) const
+	{
+		for( size_t pass = 0; pass < mRadii.size(); ++pass ) {
+			padRow( a, width, numChannels, mPad );
+			const int32_t radius = mRadii[pass];
+			const float scale = 1.0f / ( 2 * radius + 1 );
+			for( int32_t c = 0; c < numChannels; ++c ) {
+				const float *in = a + mPad * numChannels + c;
+				float *out = b + mPad * numChannels + c;
+				float sum = 0;
+				for( int32_t k = -radius; k <= radius; ++k )
+					sum += in[k * numChannels];
+				for( int32_t x = 0; x < width; ++x ) {
+					out[x * numChannels] = sum * scale;
+					sum += in[( x + radius + 1 ) * numChannels] - in[( x - radius ) * numChannels];
+				}
+			}
+			std::swap( a, b );
+		}
+		
+		return a;
+	}
+
+  private:
+	vector<int32_t>		mRadii;
+	int32_t				mPad;
+};
+
+// A symmetric kernel of odd size, applied directly
+class KernelRowFilter {
+  public:
+	explicit KernelRowFilter( const vector<float> &weights )
+		: mWeights( weights ), mPad( (int32_t)weights.size() / 2 )
+	{}
+
+	int32_t		getPad() const { return mPad; }
+
+	float*		apply( float *a, float *b, int32_t width, int32_t numChannels ) const
+	{
+		padRow( a, width, numChannels, mPad );
+		const int32_t size = (int32_t)mWeights.size();
+		for( int32_t x = 0; x < width; ++x ) {
+			for( int32_t c = 0; c < numChannels; ++c ) {
+				const float *in = a + x * numChannels + c;
+				float sum = 0;
+				for( int32_t k = 0; k < size; ++k )
+					sum += mWeights[k] * in[k * numChannels];
+				b[( mPad + x ) * numChannels + c] = sum;
+			}
+		}
+		
+		return b;
+	}
+
+  private:
+	vector<float>		mWeights;
+	int32_t				mPad;
+};
+
+// Filters rows [y1, y2) of a source plane \a width pixels wide into the same rows of the destination plane, which may be the same image
+template<typename T, typename FILTER>
+class RowPass {
+  public:
+	RowPass( const FILTER *filter, const ImagePlane *src, const ImagePlane *dst, int32_t width )
+		: mFilter( filter ), mSrc( src ), mDst( dst ), mWidth( width )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t numChannels = mSrc->mNumChannels, pad = mFilter->getPad();
+		// the extra trailing pixel is read, but never used, by the final step of a running sum
+		vector<float> a( ( mWidth + 2 * pad + 1 ) * numChannels ), b( a.size() );
+		for( int32_t y = y1; y < y2; ++y ) {
+			const T *src = reinterpret_cast<const T*>( mSrc->mData + y * mSrc->mRowBytes );
+			float *row = &a[pad * numChannels];
+			for( int32_t x = 0; x < mWidth; ++x, src += mSrc->mPixelInc )
+				for( int32_t c = 0; c < numChannels; ++c )
+					row[x * numChannels + c] = static_cast<float>( src[mSrc->mOffsets[c]] );
+
+			const float *result = mFilter->apply( &a[0], &b[0], mWidth, numChannels ) + pad * numChannels;
+			T *dst = reinterpret_cast<T*>( mDst->mData + y * mDst->mRowBytes );
+			for( int32_t x = 0; x < mWidth; ++x, dst += mDst->mPixelInc )
+				for( int32_t c = 0; c < numChannels; ++c )
+					dst[mDst->mOffsets[c]] = fromFloat<T>( result[x * numChannels + c] );
+		}
+	}
+
+  private:
+	const FILTER		*mFilter;
+	const ImagePlane	*mSrc, *mDst;
+	int32_t				mWidth;
+};
+
+// Filters columns [x1, x2) of a plane \a height pixels tall in place. Columns are copied out STRIP_WIDTH at a time, so that each row is read
+// a cache line or so at a time and the scratch space doesn't grow with the width of the image.
+template<typename T, typename FILTER>
+class ColumnPass {
+  public:
+	enum { STRIP_WIDTH = 16 };
+
+	ColumnPass( const FILTER *filter, const ImagePlane *plane, int32_t height )
+		: mFilter( filter ), mPlane( plane ), mHeight( height )
+	{}
+
+	void operator()( int32_t x1, int32_t x2 ) const
+	{
+		const int32_t numChannels = mPlane->mNumChannels, pad = mFilter->getPad();
+		const int32_t columnSize = ( mHeight + 2 * pad + 1 ) * numChannels;
+		vector<float> strip( STRIP_WIDTH * columnSize ), scratch( columnSize );
+		for( int32_t stripX = x1; stripX < x2; stripX += STRIP_WIDTH ) {
+			const int32_t stripWidth = std::min<int32_t>( STRIP_WIDTH, x2 - stripX );
+			for( int32_t y = 0; y < mHeight; ++y ) {
+				const T *src = reinterpret_cast<const T*>( mPlane->mData + y * mPlane->mRowBytes ) + stripX * mPlane->mPixelInc;
+				for( int32_t i = 0; i < stripWidth; ++i, src += mPlane->mPixelInc )
+					for( int32_t c = 0; c < numChannels; ++c )
+						strip[i * columnSize + ( pad + y ) * numChannels + c] = static_cast<float>( src[mPlane->mOffsets[c]] );
+			}
+
+			for( int32_t i = 0; i < stripWidth; ++i ) {
+				const float *result = mFilter->apply( &strip[i * columnSize], &scratch[0], mHeight, numChannels ) + pad * numChannels;
+				uint8_t *dstColumn = mPlane->mData + ( stripX + i ) * mPlane->mPixelInc * sizeof(T);
+				for( int32_t y = 0; y < mHeight; ++y, dstColumn += mPlane->mRowBytes ) {
+					T *dst = reinterpret_cast<T*>( dstColumn );
+					for( int32_t c = 0; c < numChannels; ++c )
+						dst[mPlane->mOffsets[c]] = fromFloat<T>( result[y * numChannels + c] );
+				}
+			}
+		}
+	}
+
+  private:
+	const FILTER		*mFilter;
+	const ImagePlane	*mPlane;
+	int32_t				mHeight;
+};
+
+template<typename T, typename FILTER>
+void separableBlur( const ImagePlane &src, const ImagePlane &dst, int32_t width, int32_t height, const FILTER &filter )
+{
+	if( ( width <= 0 ) || ( height <= 0 ) )
+		return;
+
+	// The rows are filtered into the destination, whose columns are then filtered in place. This needs no intermediate image and lets the source
+	// and destination be the same image, at the cost of rounding 8-bit images between the two passes.
+	parallelRows( 0, height, RowPass<T,FILTER>( &filter, &src, &dst, width ), std::max<int32_t>( 1, 16384 / width ) );
+	parallelRows( 0, width, ColumnPass<T,FILTER>( &filter, &dst, height ), std::max<int32_t>( ColumnPass<T,FILTER>::STRIP_WIDTH, 16384 / height ) );
+}
+
+template<typename T, typename FILTER>
+void blurSurface( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FILTER &filter )
+{
+	ImagePlane src( srcSurface.getData(), srcSurface.getRowBytes(), srcSurface.getPixelInc() );
+	ImagePlane dst( dstSurface->getData(), dstSurface->getRowBytes(), dstSurface->getPixelInc() );
+	src.addChannel( srcSurface.getRedOffset() ); dst.addChannel( dstSurface->getRedOffset() );
+	src.addChannel( srcSurface.getGreenOffset() ); dst.addChannel( dstSurface->getGreenOffset() );
+	src.addChannel( srcSurface.getBlueOffset() ); dst.addChannel( dstSurface->getBlueOffset() );
+	if( srcSurface.hasAlpha() && dstSurface->hasAlpha() ) {
+		src.addChannel( srcSurface.getAlphaOffset() );
+		dst.addChannel( dstSurface->getAlphaOffset() );
+	}
+
+	separableBlur<T>( src, dst, std::min( srcSurface.getWidth(), dstSurface->getWidth() ), std::min( srcSurface.getHeight(), dstSurface->getHeight() ), filter );
+}
+
+template<typename T, typename FILTER>
+void blurChannel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FILTER &filter )
+{
+	ImagePlane src( srcChannel.getData(), srcChannel.getRowBytes(), srcChannel.getIncrement() );
+	ImagePlane dst( dstChannel->getData(), dstChannel->getRowBytes(), dstChannel->getIncrement() );
+	src.addChannel( 0 );
+	dst.addChannel( 0 );
+
+	separableBlur<T>( src, dst, std::min( srcChannel.getWidth(), dstChannel->getWidth() ), std::min( srcChannel.getHeight(), dstChannel->getHeight() ), filter );
+}
+
+vector<int32_t> boxRadii( int32_t radius )
+{
+	return vector<int32_t>( 1, std::max<int32_t>( radius, 0 ) );
+}
+
+// Radii of three box filters whose combined variance best matches that of a Gaussian of standard deviation \a sigma.
+// After Kovesi, "Fast Almost-Gaussian Filtering"
+vector<int32_t> gaussianBoxRadii( float sigma )
+{
+	const int32_t passes = 3;
+	const float variance = std::max( sigma, 0.0f ) * std::max( sigma, 0.0f );
+	int32_t lower = (int32_t)floor( sqrt( 12 * variance / passes + 1 ) );
+	if( lower % 2 == 0 )
+		--lower;
+	const int32_t upper = lower + 2;
+	const int32_t numLower = (int32_t)floor( ( 12 * variance - passes * lower * lower - 4 * passes * lower - 3 * passes ) / ( -4.0f * lower - 4 ) + 0.5f );
+
+	vector<int32_t> result;
+	for( int32_t pass = 0; pass < passes; ++pass )
+		result.push_back( ( ( pass < numLower ) ? lower : upper ) / 2 );
+	return result;
+}
+
+vector<float> gaussianWeights( float sigma )
+{
+	if( sigma <= 0 )
+		return vector<float>( 1, 1.0f );
+
+	const int32_t radius = std::max<int32_t>( 1, (int32_t)ceil( 3 * sigma ) );
+	vector<float> result( 2 * radius + 1 );
+	float sum = 0;
+	for( int32_t k = -radius; k <= radius; ++k ) {
+		result[k + radius] = exp( -( k * k ) / ( 2 * sigma * sigma ) );
+		sum += result[k + radius];
+	}
+	for( size_t k = 0; k < result.size(); ++k )
+		result[k] /= sum;
+
+	return result;
+}
+
+} // anonymous namespace
+
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius )
+{
+	blurSurface( srcSurface, dstSurface, BoxRowFilter( boxRadii( radius ) ) );
+}
+
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius )
+{
+	blurChannel( srcChannel, dstChannel, BoxRowFilter( boxRadii( radius ) ) );
+}
+
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma )
+{
+	blurSurface( srcSurface, dstSurface, BoxRowFilter( gaussianBoxRadii( sigma ) ) );
+}
+
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma )
+{
+	blurChannel( srcChannel, dstChannel, BoxRowFilter( gaussianBoxRadii( sigma ) ) );
+}
+
+template<typename T>
+void gaussianBlurExact( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma )
+{
+	blurSurface( srcSurface, dstSurface, KernelRowFilter( gaussianWeights( sigma ) ) );
+}
+
+template<typename T>
+void gaussianBlurExact( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma )
+{
+	blurChannel( srcChannel, dstChannel, KernelRowFilter( gaussianWeights( sigma ) ) );
+}
+
+#define blur_PROTOTYPES(r,data,T)\
+	template void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius ); \
+	template void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius ); \
+	template void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma ); \
+	template void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma ); \
+	template void gaussianBlurExact( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma ); \
+	template void gaussianBlurExact( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma );
+
+BOOST_PP_SEQ_FOR_EACH( blur_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
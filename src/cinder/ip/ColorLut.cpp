@@ -0,0 +1,388 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/ColorLut.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/Buffer.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+// Lattice colors in fixed point, for 8-bit Surfaces. Since there are only 256 inputs per channel, each one's lattice offset and fraction are precomputed.
+struct ColorLut3d::FixedTable {
+	FixedTable( const ColorLut3d &lut );
+
+	static const int32_t FRACTION_BITS = 12, FRACTION_ONE = 1 << FRACTION_BITS;
+
+	int32_t					mStrideG, mStrideB;
+	std::vector<int16_t>	mValues; // in 1/128ths of an 8-bit level, 3 per lattice color
+	int32_t					mOffsets[3][256], mFractions[3][256];
+};
+
+namespace {
+
+// Orders the fractions \a fr, \a fg and \a fb of a point within a lattice cell from largest to smallest into \a f. The tetrahedron containing
+// the point runs from the cell's first corner along the corresponding edges; \a steps receives the offsets of its second and third corners.
+// The order is looked up from the three comparisons rather than branched on, as it is effectively random from one pixel to the next.
+template<typename F>
+inline void sortTetrahedron( F fr, F fg, F fb, int32_t strideG, int32_t strideB, F f[3], int32_t steps[2] )
+{
+	// indexed by ( fr > fg ) | ( fg > fb ) << 1 | ( fr > fb ) << 2; entries 3 and 4 are contradictory and unused
+	static const uint8_t orders[8][3] = { { 2, 1, 0 }, { 2, 0, 1 }, { 1, 2, 0 }, { 0, 1, 2 }, { 2, 1, 0 }, { 0, 2, 1 }, { 1, 0, 2 }, { 0, 1, 2 } };
+	const uint8_t *order = orders[( fr > fg ) | ( ( fg > fb ) << 1 ) | ( ( fr > fb ) << 2 )];
+	const F fractions[3] = { fr, fg, fb };
+	const int32_t strides[3] = { 1, strideG, strideB };
+	f[0] = fractions[order[0]];
+	f[1] = fractions[order[1]];
+	f[2] = fractions[order[2]];
+	steps[0] = strides[order[0]];
+	steps[1] = steps[0] + strides[order[1]];
+}
+
+// Interpolates float colors directly from the table
+class FloatMapper {
+  public:
+	FloatMapper( const ColorLut3d &lut )
+		: mValues( &lut.getValue( 0, 0, 0 ) ), mSize( lut.getSize() ), mStrideG( mSize ), mStrideB( mSize * mSize ), mDomainMin( lut.getDomainMin() )
+	{
+		for( int c = 0; c < 3; ++c )
+			mScale[c] = ( mSize - 1 ) / ( lut.getDomainMax()[c] - mDomainMin[c] );
+	}
+
+	template<bool TETRAHEDRAL>
+	void map( float r, float g, float b, float out[3] ) const
+	{
+		float fr, fg, fb;
+		const Colorf *c = &mValues[locate( r, 0, &fr ) + locate( g, 1, &fg ) * mStrideG + locate( b, 2, &fb ) * mStrideB];
+		Colorf result;
+		if( TETRAHEDRAL ) {
+			float f[3];
+			int32_t steps[2];
+			sortTetrahedron( fr, fg, fb, mStrideG, mStrideB, f, steps );
+			const Colorf &c0 = c[0], &c1 = c[steps[0]], &c2 = c[steps[1]], &c3 = c[1 + mStrideG + mStrideB];
+			result = c0 + ( c1 - c0 ) * f[0] + ( c2 - c1 ) * f[1] + ( c3 - c2 ) * f[2];
+		}
+		else {
+			const Colorf c00 = c[0].lerp( fr, c[1] ), c10 = c[mStrideG].lerp( fr, c[mStrideG + 1] );
+			const Colorf c01 = c[mStrideB].lerp( fr, c[mStrideB + 1] ), c11 = c[mStrideG + mStrideB].lerp( fr, c[mStrideG + mStrideB + 1] );
+			result = c00.lerp( fg, c10 ).lerp( fb, c01.lerp( fg, c11 ) );
+		}
+		out[0] = result.r;
+		out[1] = result.g;
+		out[2] = result.b;
+	}
+
+  private:
+	// Returns the index of the lattice cell containing \a v along \a axis, and the position of \a v across it in \a fraction
+	int32_t locate( float v, int axis, float *fraction ) const
+	{
+		const float t = constrain<float>( ( v - mDomainMin[axis] ) * mScale[axis], 0, (float)( mSize - 1 ) );
+		const int32_t index = std::min<int32_t>( static_cast<int32_t>( t ), mSize - 2 );
+		*fraction = t - index;
+		return index;
+	}
+
+	const Colorf	*mValues;
+	int32_t			mSize, mStrideG, mStrideB;
+	Colorf			mDomainMin;
+	float			mScale[3];
+};
+
+// Interpolates 8-bit colors from the table's cached fixed-point copy
+class FixedMapper {
+  public:
+	FixedMapper( const ColorLut3d &lut )
+		: mTable( lut.getFixedTable() ), mValues( &mTable->mValues[0] ), mOffsets( mTable->mOffsets ), mFractions( mTable->mFractions ),
+		mStrideG( mTable->mStrideG ), mStrideB( mTable->mStrideB )
+	{}
+
+	template<bool TETRAHEDRAL>
+	void map( uint8_t r, uint8_t g, uint8_t b, uint8_t out[3] ) const
+	{
+		static const int32_t FRACTION_BITS = ColorLut3d::FixedTable::FRACTION_BITS, FRACTION_ONE = ColorLut3d::FixedTable::FRACTION_ONE;
+		const int16_t *c = mValues + mOffsets[0][r] + mOffsets[1][g] + mOffsets[2][b];
+		const int32_t fr = mFractions[0][r], fg = mFractions[1][g], fb = mFractions[2][b];
+		if( TETRAHEDRAL ) {
+			int32_t f[3], steps[2];
+			sortTetrahedron( fr, fg, fb, mStrideG, mStrideB, f, steps );
+			const int16_t *c1 = c + steps[0] * 3, *c2 = c + steps[1] * 3, *c3 = c + ( 1 + mStrideG + mStrideB ) * 3;
+			// the weights sum to FRACTION_ONE and the colors are within [0,255*128], so this stays within [0,255]
+			for( int k = 0; k < 3; ++k )
+				out[k] = static_cast<uint8_t>( ( ( c[k] << FRACTION_BITS ) + f[0] * ( c1[k] - c[k] ) + f[1] * ( c2[k] - c1[k] ) + f[2] * ( c3[k] - c2[k] ) + ( 1 << ( FRACTION_BITS + 6 ) ) ) >> ( FRACTION_BITS + 7 ) );
+		}
+		else {
+			// The weights of the 8 corners are computed once for all three channels. Each split truncates one side and gives the remainder
+			// to the other, which keeps the weights non-negative and summing to exactly FRACTION_ONE, so the result stays within [0,255].
+			const int32_t g3 = mStrideG * 3, b3 = mStrideB * 3;
+			const int32_t w11 = ( fr * fg ) >> FRACTION_BITS, w01 = ( ( FRACTION_ONE - fr ) * fg ) >> FRACTION_BITS;
+			const int32_t w10 = fr - w11, w00 = FRACTION_ONE - fr - w01;
+			const int32_t w111 = ( w11 * fb ) >> FRACTION_BITS, w011 = ( w01 * fb ) >> FRACTION_BITS, w101 = ( w10 * fb ) >> FRACTION_BITS, w001 = ( w00 * fb ) >> FRACTION_BITS;
+			const int32_t w110 = w11 - w111, w010 = w01 - w011, w100 = w10 - w101, w000 = w00 - w001;
+			for( int k = 0; k < 3; ++k )
+				out[k] = static_cast<uint8_t>( ( w000 * c[k] + w100 * c[3 + k] + w010 * c[g3 + k] + w110 * c[g3 + 3 + k]
+					+ w001 * c[b3 + k] + w101 * c[b3 + 3 + k] + w011 * c[g3 + b3 + k] + w111 * c[g3 + b3 + 3 + k] + ( 1 << ( FRACTION_BITS + 6 ) ) ) >> ( FRACTION_BITS + 7 ) );
+		}
+	}
+
+  private:
+	std::shared_ptr<const ColorLut3d::FixedTable>	mTable;
+	const int16_t		*mValues;
+	const int32_t		(*mOffsets)[256], (*mFractions)[256];
+	int32_t				mStrideG, mStrideB;
+};
+
+template<typename T> struct LutMapper {};
+template<> struct LutMapper<uint8_t> { typedef FixedMapper Type; };
+template<> struct LutMapper<float> { typedef FloatMapper Type; };
+
+// Maps rows [y1, y2) of \a area of \a src through \a mapper into \a dst
+template<typename T, bool TETRAHEDRAL>
+class LutBand {
+  public:
+	typedef typename LutMapper<T>::Type	Mapper;
+
+	LutBand( const SurfaceT<T> *src, SurfaceT<T> *dst, const Area &area, const Mapper *mapper )
+		: mSrc( src ), mDst( dst ), mArea( area ), mMapper( mapper )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const uint8_t srcInc = mSrc->getPixelInc(), dstInc = mDst->getPixelInc();
+		const uint8_t sR = mSrc->getRedOffset(), sG = mSrc->getGreenOffset(), sB = mSrc->getBlueOffset(), sA = mSrc->getAlphaOffset();
+		const uint8_t dR = mDst->getRedOffset(), dG = mDst->getGreenOffset(), dB = mDst->getBlueOffset(), dA = mDst->getAlphaOffset();
+		const bool copyAlpha = mSrc->hasAlpha() && mDst->hasAlpha() && ( mSrc->getData() != mDst->getData() );
+		// a local copy, as otherwise the compiler reloads the mapper's members after every store through a uint8_t pointer
+		const Mapper mapper( *mMapper );
+		for( int32_t y = y1; y < y2; ++y ) {
+			const T *src = mSrc->getData( Vec2i( mArea.x1, y ) );
+			T *dst = mDst->getData( Vec2i( mArea.x1, y ) );
+			for( int32_t x = mArea.x1; x < mArea.x2; ++x, src += srcInc, dst += dstInc ) {
+				T out[3];
+				mapper.template map<TETRAHEDRAL>( src[sR], src[sG], src[sB], out );
+				dst[dR] = out[0];
+				dst[dG] = out[1];
+				dst[dB] = out[2];
+				if( copyAlpha )
+					dst[dA] = src[sA];
+			}
+		}
+	}
+
+  private:
+	const SurfaceT<T>	*mSrc;
+	SurfaceT<T>			*mDst;
+	Area				mArea;
+	const Mapper		*mMapper;
+};
+
+// Advances \a p past spaces and tabs
+inline const char* skipBlanks( const char *p )
+{
+	while( *p == ' ' || *p == '\t' )
+		++p;
+	return p;
+}
+
+// Whether the line at \a p begins with the keyword \a keyword, in which case \a p is advanced past it
+bool parseKeyword( const char **p, const char *keyword )
+{
+	const size_t length = strlen( keyword );
+	if( strncmp( *p, keyword, length ) != 0 || ( (*p)[length] != ' ' && (*p)[length] != '\t' ) )
+		return false;
+	*p += length;
+	return true;
+}
+
+// Parses \a count numbers from the line at \a p, throwing if any are missing
+void parseFloats( const char *p, float *values, int count )
+{
+	for( int i = 0; i < count; ++i ) {
+		p = skipBlanks( p );
+		char *end;
+		values[i] = static_cast<float>( strtod( p, &end ) );
+		if( end == p || *p == '\r' || *p == '\n' )
+			throw ColorLutExcInvalidFile();
+		p = end;
+	}
+}
+
+} // anonymous namespace
+
+ColorLut3d::ColorLut3d( int32_t size )
+	: mObj( new Obj )
+{
+	mObj->mSize = std::max<int32_t>( size, 2 );
+	mObj->mDomainMin = Colorf( 0, 0, 0 );
+	mObj->mDomainMax = Colorf( 1, 1, 1 );
+	mObj->mValues.resize( mObj->mSize * mObj->mSize * mObj->mSize );
+	const float scale = 1.0f / ( mObj->mSize - 1 );
+	Colorf *value = &mObj->mValues[0];
+	for( int32_t b = 0; b < mObj->mSize; ++b )
+		for( int32_t g = 0; g < mObj->mSize; ++g )
+			for( int32_t r = 0; r < mObj->mSize; ++r )
+				*value++ = Colorf( r * scale, g * scale, b * scale );
+}
+
+ColorLut3d::ColorLut3d( DataSourceRef dataSource )
+	: mObj( new Obj )
+{
+	mObj->mSize = 0;
+	mObj->mDomainMin = Colorf( 0, 0, 0 );
+	mObj->mDomainMax = Colorf( 1, 1, 1 );
+
+	// parse in place from a null-terminated copy of the file
+	Buffer &buffer = dataSource->getBuffer();
+	vector<char> text( static_cast<const char*>( buffer.getData() ), static_cast<const char*>( buffer.getData() ) + buffer.getDataSize() );
+	text.push_back( 0 );
+
+	size_t numValues = 0;
+	for( const char *line = &text[0]; *line; ) {
+		const char *p = skipBlanks( line );
+		const char *next = p + strcspn( p, "\r\n" );
+		if( *p == '#' || p == next ) {
+			// comment or blank line
+		}
+		else if( ( *p >= '0' && *p <= '9' ) || *p == '-' || *p == '+' || *p == '.' ) { // a lattice color
+			if( numValues >= mObj->mValues.size() )
+				throw ColorLutExcInvalidFile();
+			parseFloats( p, &mObj->mValues[numValues].r, 3 );
+			++numValues;
+		}
+		else if( parseKeyword( &p, "TITLE" ) ) {
+			p = skipBlanks( p );
+			const char *end = next;
+			if( *p == '"' ) {
+				++p;
+				end = std::find( p, next, '"' );
+			}
+			mObj->mTitle.assign( p, end );
+		}
+		else if( parseKeyword( &p, "LUT_3D_SIZE" ) ) {
+			mObj->mSize = atoi( p );
+			if( mObj->mSize < 2 || mObj->mSize > 256 || numValues > 0 )
+				throw ColorLutExcInvalidFile();
+			mObj->mValues.resize( mObj->mSize * mObj->mSize * mObj->mSize );
+		}
+		else if( parseKeyword( &p, "DOMAIN_MIN" ) )
+			parseFloats( p, &mObj->mDomainMin.r, 3 );
+		else if( parseKeyword( &p, "DOMAIN_MAX" ) )
+			parseFloats( p, &mObj->mDomainMax.r, 3 );
+		else if( parseKeyword( &p, "LUT_3D_INPUT_RANGE" ) ) { // Resolve's single range for every channel
+			float range[2];
+			parseFloats( p, range, 2 );
+			mObj->mDomainMin = Colorf( range[0], range[0], range[0] );
+			mObj->mDomainMax = Colorf( range[1], range[1], range[1] );
+		}
+		else if( parseKeyword( &p, "LUT_1D_SIZE" ) )
+			throw ColorLutExcInvalidFile();
+		// other keywords are skipped, as the format asks of readers
+
+		line = next + strspn( next, "\r\n" );
+	}
+
+	if( mObj->mSize == 0 || numValues != mObj->mValues.size() )
+		throw ColorLutExcInvalidFile();
+	for( int c = 0; c < 3; ++c )
+		if( ! ( mObj->mDomainMax[c] > mObj->mDomainMin[c] ) )
+			throw ColorLutExcInvalidFile();
+}
+
+void ColorLut3d::setValue( int32_t r, int32_t g, int32_t b, const Colorf &color )
+{
+	mObj->mValues[( b * mObj->mSize + g ) * mObj->mSize + r] = color;
+
+	std::lock_guard<std::mutex> lock( mObj->mFixedTableMutex );
+	mObj->mFixedTable.reset();
+}
+
+std::shared_ptr<const ColorLut3d::FixedTable> ColorLut3d::getFixedTable() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mFixedTableMutex );
+	if( ! mObj->mFixedTable )
+		mObj->mFixedTable = std::shared_ptr<const FixedTable>( new FixedTable( *this ) );
+	return mObj->mFixedTable;
+}
+
+ColorLut3d::FixedTable::FixedTable( const ColorLut3d &lut )
+	: mStrideG( lut.getSize() ), mStrideB( lut.getSize() * lut.getSize() )
+{
+	const int32_t size = lut.getSize(), numValues = size * size * size;
+	const Colorf *values = &lut.getValue( 0, 0, 0 );
+	mValues.resize( numValues * 3 );
+	for( int32_t i = 0; i < numValues; ++i )
+		for( int c = 0; c < 3; ++c )
+			mValues[i * 3 + c] = static_cast<int16_t>( constrain<float>( values[i][c], 0, 1 ) * ( 255 * 128 ) + 0.5f );
+
+	const int32_t strides[3] = { 1, mStrideG, mStrideB };
+	for( int c = 0; c < 3; ++c ) {
+		const float scale = ( size - 1 ) / ( lut.getDomainMax()[c] - lut.getDomainMin()[c] );
+		for( int v = 0; v < 256; ++v ) {
+			const float t = constrain<float>( ( v / 255.0f - lut.getDomainMin()[c] ) * scale, 0, (float)( size - 1 ) );
+			const int32_t index = std::min<int32_t>( static_cast<int32_t>( t ), size - 2 );
+			mOffsets[c][v] = index * strides[c] * 3;
+			mFractions[c][v] = static_cast<int32_t>( ( t - index ) * FRACTION_ONE + 0.5f );
+		}
+	}
+}
+
+Colorf ColorLut3d::lookup( const Colorf &color, Interpolation interpolation ) const
+{
+	float out[3];
+	FloatMapper mapper( *this );
+	if( interpolation == TETRAHEDRAL )
+		mapper.map<true>( color.r, color.g, color.b, out );
+	else
+		mapper.map<false>( color.r, color.g, color.b, out );
+	return Colorf( out[0], out[1], out[2] );
+}
+
+template<typename T>
+void applyLut( SurfaceT<T> *surface, const ColorLut3d &lut, ColorLut3d::Interpolation interpolation )
+{
+	applyLut( *surface, surface, lut, interpolation );
+}
+
+template<typename T>
+void applyLut( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ColorLut3d &lut, ColorLut3d::Interpolation interpolation )
+{
+	const Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
+	const typename LutMapper<T>::Type mapper( lut );
+	if( interpolation == ColorLut3d::TETRAHEDRAL )
+		parallelRows( area.y1, area.y2, LutBand<T,true>( &srcSurface, dstSurface, area, &mapper ) );
+	else
+		parallelRows( area.y1, area.y2, LutBand<T,false>( &srcSurface, dstSurface, area, &mapper ) );
+}
+
+#define applyLut_PROTOTYPES(r,data,T)\
+	template void applyLut( SurfaceT<T> *surface, const ColorLut3d &lut, ColorLut3d::Interpolation interpolation );\
+	template void applyLut( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ColorLut3d &lut, ColorLut3d::Interpolation interpolation );
+
+BOOST_PP_SEQ_FOR_EACH( applyLut_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -0,0 +1,722 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/ColorSpace.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/Color.h"
+#include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/SimdDispatch.h"
+
+#include <boost/thread/once.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// The number of pixels converted at once. Rows are gathered into planes of this many components, converted, then scattered back.
+const int32_t BLOCK_SIZE = 256;
+
+// Fixed-point matrices are scaled by 2^13, leaving room for the largest coefficient, 2.11, of limited-range BT.709's inverse
+const int32_t FIXED_BITS = 13;
+
+// The sRGB primaries to CIE XYZ under D65
+const double SRGB_TO_XYZ[3][3] = {	{ 0.4124564, 0.3575761, 0.1804375 },
+									{ 0.2126729, 0.7151522, 0.0721750 },
+									{ 0.0193339, 0.1191920, 0.9503041 } };
+
+// Where CIE Lab's cube root gives way to a line, and that line's slope and intercept
+const float LAB_EPSILON = 216.0f / 24389.0f, LAB_SLOPE = 841.0f / 108.0f, LAB_INTERCEPT = 4.0f / 29.0f, LAB_DELTA = 6.0f / 29.0f;
+
+// The affine map from one color space's components to another's, with a fixed-point copy for 8-bit components
+struct ColorTransform {
+	ColorTransform( ColorSpace space, bool toRgb );
+
+	ColorSpace	mSpace;
+	bool		mToRgb;
+	// YCbCr's affine map, or the map from linear RGB to XYZ relative to the white point for CS_LAB
+	float		mMatrix[3][3], mOffset[3];
+	// the matrix and offset scaled by 2^FIXED_BITS for 8-bit components, with rounding folded into the offset
+	int32_t		mFixedMatrix[3][3], mFixedOffset[3];
+};
+
+// Replaces \a matrix with its inverse
+void invert( double matrix[3][3] )
+{
+	const double m[3][3] = {	{ matrix[0][0], matrix[0][1], matrix[0][2] },
+								{ matrix[1][0], matrix[1][1], matrix[1][2] },
+								{ matrix[2][0], matrix[2][1], matrix[2][2] } };
+	const double det = m[0][0] * ( m[1][1] * m[2][2] - m[1][2] * m[2][1] ) - m[0][1] * ( m[1][0] * m[2][2] - m[1][2] * m[2][0] ) + m[0][2] * ( m[1][0] * m[2][1] - m[1][1] * m[2][0] );
+	for( int i = 0; i < 3; ++i )
+		for( int j = 0; j < 3; ++j ) // the cofactor of m[j][i]
+			matrix[i][j] = ( m[( j + 1 ) % 3][( i + 1 ) % 3] * m[( j + 2 ) % 3][( i + 2 ) % 3] - m[( j + 1 ) % 3][( i + 2 ) % 3] * m[( j + 2 ) % 3][( i + 1 ) % 3] ) / det;
+}
+
+// Replaces \a offset, added after the inverse of \a inverse, with the offset subtracted before it
+void invertOffset( const double inverse[3][3], double offset[3] )
+{
+	const double o[3] = { offset[0], offset[1], offset[2] };
+	for( int i = 0; i < 3; ++i )
+		offset[i] = -( inverse[i][0] * o[0] + inverse[i][1] * o[1] + inverse[i][2] * o[2] );
+}
+
+ColorTransform::ColorTransform( ColorSpace space, bool toRgb )
+	: mSpace( space ), mToRgb( toRgb )
+{
+	// offsets are kept separately for float components and 8-bit ones, which center chroma on 128 rather than 127.5
+	double matrix[3][3], offset[3] = { 0, 0, 0 }, offset8[3] = { 0, 0, 0 };
+	if( space == CS_LAB ) {
+		// normalizing each row by its sum maps white to ( 1, 1, 1 )
+		for( int i = 0; i < 3; ++i )
+			for( int j = 0; j < 3; ++j )
+				matrix[i][j] = SRGB_TO_XYZ[i][j] / ( SRGB_TO_XYZ[i][0] + SRGB_TO_XYZ[i][1] + SRGB_TO_XYZ[i][2] );
+	}
+	else if( space != CS_HSV ) {
+		const bool bt709 = ( space == CS_YCBCR_709 ) || ( space == CS_YCBCR_709_LIMITED );
+		const bool limited = ( space == CS_YCBCR_601_LIMITED ) || ( space == CS_YCBCR_709_LIMITED );
+		const double kr = ( bt709 ) ? 0.2126 : 0.299, kb = ( bt709 ) ? 0.0722 : 0.114, kg = 1 - kr - kb;
+		const double lumaScale = ( limited ) ? 219 / 255.0 : 1, chromaScale = ( limited ) ? 224 / 255.0 : 1;
+		const double rows[3][3] = {	{ kr, kg, kb },
+									{ -kr / ( 2 * ( 1 - kb ) ), -kg / ( 2 * ( 1 - kb ) ), 0.5 },
+									{ 0.5, -kg / ( 2 * ( 1 - kr ) ), -kb / ( 2 * ( 1 - kr ) ) } };
+		for( int j = 0; j < 3; ++j ) {
+			matrix[0][j] = rows[0][j] * lumaScale;
+			matrix[1][j] = rows[1][j] * chromaScale;
+			matrix[2][j] = rows[2][j] * chromaScale;
+		}
+		// limited range is defined in 8-bit codes, which float components follow
+		offset8[0] = ( limited ) ? 16 : 0;
+		offset8[1] = offset8[2] = 128;
+		offset[0] = offset8[0] / 255;
+		offset[1] = offset[2] = ( limited ) ? 128 / 255.0 : 0.5;
+	}
+	else {
+		for( int i = 0; i < 3; ++i )
+			for( int j = 0; j < 3; ++j )
+				matrix[i][j] = ( i == j ) ? 1 : 0;
+	}
+
+	if( toRgb ) {
+		invert( matrix );
+		invertOffset( matrix, offset );
+		invertOffset( matrix, offset8 );
+	}
+
+	for( int i = 0; i < 3; ++i ) {
+		for( int j = 0; j < 3; ++j ) {
+			mMatrix[i][j] = static_cast<float>( matrix[i][j] );
+			mFixedMatrix[i][j] = static_cast<int32_t>( floor( matrix[i][j] * ( 1 << FIXED_BITS ) + 0.5 ) );
+		}
+		mOffset[i] = static_cast<float>( offset[i] );
+		mFixedOffset[i] = static_cast<int32_t>( floor( offset8[i] * ( 1 << FIXED_BITS ) + 0.5 ) ) + ( 1 << ( FIXED_BITS - 1 ) );
+	}
+}
+
+// Returns \a v rounded and clamped to [0,255]
+inline uint8_t clampRound( float v )
+{
+	return ( v <= 0 ) ? 0 : ( ( v >= 255 ) ? 255 : static_cast<uint8_t>( v + 0.5f ) );
+}
+
+inline float labF( float t )
+{
+	return ( t > LAB_EPSILON ) ? powf( t, 1.0f / 3.0f ) : t * LAB_SLOPE + LAB_INTERCEPT;
+}
+
+inline float labFInverse( float f )
+{
+	return ( f > LAB_DELTA ) ? f * f * f : ( f - LAB_INTERCEPT ) * ( 1 / LAB_SLOPE );
+}
+
+inline double srgbToLinear( double c )
+{
+	return ( c <= 0.04045 ) ? c / 12.92 : pow( ( c + 0.055 ) / 1.055, 2.4 );
+}
+
+inline float linearToSrgb( float l )
+{
+	return ( l <= 0.0031308f ) ? l * 12.92f : 1.055f * powf( l, 1 / 2.4f ) - 0.055f;
+}
+
+// The transfer curves and cube roots of CIE Lab, tabulated. The float tables are sampled finely enough to interpolate linearly.
+// At about 70KB, they are built by the first Lab conversion rather than during static initialization.
+class LabTables {
+  public:
+	static const int32_t CURVE_SIZE = 4096, LINEAR_ONE = 1 << 15;
+
+	// Returns the tables, building them thread-safely on the first call
+	static const LabTables&	get() { boost::call_once( &LabTables::build, sOnce ); return sInstance; }
+
+	// Linearizes the sRGB component \a c, interpolating between samples over [0,1]
+	float linearize( float c ) const
+	{
+		if( c < 0 || c > 1 )
+			return static_cast<float>( srgbToLinear( c ) );
+		return interpolate( mLinearize, c * CURVE_SIZE );
+	}
+
+	// Returns labF() of \a t / LINEAR_ONE
+	float f( int32_t t ) const
+	{
+		return interpolate( mF, t * ( CURVE_SIZE / (float)LINEAR_ONE ) );
+	}
+
+	int32_t		mLinear8[256];		// 8-bit sRGB to linear, scaled by LINEAR_ONE
+	float		mL8[256], mA8[256], mB8[256];	// 8-bit L, a and b to the cube roots of Y, and the offsets of X's and Z's from it
+	uint8_t		mSrgb8[LINEAR_ONE + 1];	// linear, scaled by LINEAR_ONE, to 8-bit sRGB
+
+  private:
+	static void build()
+	{
+		LabTables &t = sInstance;
+		for( int32_t i = 0; i <= CURVE_SIZE; ++i ) {
+			t.mLinearize[i] = static_cast<float>( srgbToLinear( i / (double)CURVE_SIZE ) );
+			t.mF[i] = labF( i / (float)CURVE_SIZE );
+		}
+		for( int32_t v = 0; v < 256; ++v ) {
+			t.mLinear8[v] = static_cast<int32_t>( floor( srgbToLinear( v / 255.0 ) * LINEAR_ONE + 0.5 ) );
+			t.mL8[v] = ( v * ( 100 / 255.0f ) + 16 ) * ( 1 / 116.0f );
+			t.mA8[v] = ( v - 128 ) * ( 1 / 500.0f );
+			t.mB8[v] = ( v - 128 ) * ( 1 / 200.0f );
+		}
+		for( int32_t i = 0; i <= LINEAR_ONE; ++i )
+			t.mSrgb8[i] = clampRound( linearToSrgb( i / (float)LINEAR_ONE ) * 255 );
+	}
+
+	static float interpolate( const float *table, float position )
+	{
+		const int32_t i = std::min( static_cast<int32_t>( position ), CURVE_SIZE - 1 );
+		return table[i] + ( table[i + 1] - table[i] ) * ( position - i );
+	}
+
+	float		mLinearize[CURVE_SIZE + 1], mF[CURVE_SIZE + 1];
+
+	// both are constant-initialized, as in DispatchTable
+	static LabTables			sInstance;
+	static boost::once_flag		sOnce;
+};
+
+LabTables LabTables::sInstance;
+boost::once_flag LabTables::sOnce = BOOST_ONCE_INIT;
+
+// Reciprocals for the 8-bit HSV conversion, scaled by 2^14: 255 / v for saturation and 255 / 6v for hue, with 0 for v = 0. Built on first use.
+class HsvTables {
+  public:
+	static const int32_t BITS = 14;
+
+	static const HsvTables&	get() { boost::call_once( &HsvTables::build, sOnce ); return sInstance; }
+
+	int32_t		mSaturation[256], mHue[256];
+
+  private:
+	static void build()
+	{
+		HsvTables &t = sInstance;
+		t.mSaturation[0] = t.mHue[0] = 0;
+		for( int32_t v = 1; v < 256; ++v ) {
+			t.mSaturation[v] = ( ( 255 << BITS ) + v / 2 ) / v;
+			t.mHue[v] = ( ( 255 << BITS ) + 3 * v ) / ( 6 * v );
+		}
+	}
+
+	static HsvTables			sInstance;
+	static boost::once_flag		sOnce;
+};
+
+HsvTables HsvTables::sInstance;
+boost::once_flag HsvTables::sOnce = BOOST_ONCE_INIT;
+
+// SIMD kernels. Each converts as many leading pixels of its planes as it can and returns that count; the caller finishes with the scalar code.
+// Every pixel's source components are read before its destination is written, so \a dst may be \a src.
+typedef int32_t (*ConvertFunc_u8)( const uint8_t *const src[3], uint8_t *const dst[3], int32_t count, const ColorTransform &transform );
+typedef int32_t (*ConvertFunc_float)( const float *const src[3], float *const dst[3], int32_t count, const ColorTransform &transform );
+
+#if defined( CINDER_SSE2 )
+
+// Returns \a a where \a mask is set and \a b elsewhere
+inline __m128 select_ps( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+// Returns the cube roots of positive \a x: a first guess from dividing the exponent by 3, refined twice by Halley's method
+inline __m128 cbrt_ps( __m128 x )
+{
+	const __m128 guessBits = _mm_mul_ps( _mm_cvtepi32_ps( _mm_castps_si128( x ) ), _mm_set1_ps( 1.0f / 3.0f ) );
+	__m128 y = _mm_castsi128_ps( _mm_add_epi32( _mm_cvttps_epi32( guessBits ), _mm_set1_epi32( 709921077 ) ) );
+	for( int i = 0; i < 2; ++i ) {
+		const __m128 y3 = _mm_mul_ps( _mm_mul_ps( y, y ), y );
+		y = _mm_mul_ps( y, _mm_div_ps( _mm_add_ps( y3, _mm_add_ps( x, x ) ), _mm_add_ps( _mm_add_ps( y3, y3 ), x ) ) );
+	}
+	return y;
+}
+
+int32_t affine_sse2( const uint8_t *const src[3], uint8_t *const dst[3], int32_t count, const ColorTransform &transform )
+{
+	// red and green are multiplied in pairs by madd, blue alongside a 0
+	const __m128i zero = _mm_setzero_si128();
+	__m128i redGreen[3], blue[3], offset[3];
+	for( int k = 0; k < 3; ++k ) {
+		redGreen[k] = _mm_set1_epi32( ( transform.mFixedMatrix[k][1] << 16 ) | ( transform.mFixedMatrix[k][0] & 0xFFFF ) );
+		blue[k] = _mm_set1_epi32( transform.mFixedMatrix[k][2] & 0xFFFF );
+		offset[k] = _mm_set1_epi32( transform.mFixedOffset[k] );
+	}
+	int32_t x = 0;
+	for( ; x + 8 <= count; x += 8 ) {
+		const __m128i r = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src[0] + x ) ), zero );
+		const __m128i g = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src[1] + x ) ), zero );
+		const __m128i b = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src[2] + x ) ), zero );
+		const __m128i rgLo = _mm_unpacklo_epi16( r, g ), rgHi = _mm_unpackhi_epi16( r, g ), bLo = _mm_unpacklo_epi16( b, zero ), bHi = _mm_unpackhi_epi16( b, zero );
+		__m128i results[3];
+		for( int k = 0; k < 3; ++k ) {
+			const __m128i lo = _mm_srai_epi32( _mm_add_epi32( _mm_add_epi32( _mm_madd_epi16( rgLo, redGreen[k] ), _mm_madd_epi16( bLo, blue[k] ) ), offset[k] ), FIXED_BITS );
+			const __m128i hi = _mm_srai_epi32( _mm_add_epi32( _mm_add_epi32( _mm_madd_epi16( rgHi, redGreen[k] ), _mm_madd_epi16( bHi, blue[k] ) ), offset[k] ), FIXED_BITS );
+			const __m128i packed = _mm_packs_epi32( lo, hi );
+			results[k] = _mm_packus_epi16( packed, packed );
+		}
+		for( int k = 0; k < 3; ++k )
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( dst[k] + x ), results[k] );
+	}
+	return x;
+}
+
+int32_t affine_sse( const float *const src[3], float *const dst[3], int32_t count, const ColorTransform &transform )
+{
+	__m128 matrix[3][3], offset[3];
+	for( int i = 0; i < 3; ++i ) {
+		for( int j = 0; j < 3; ++j )
+			matrix[i][j] = _mm_set1_ps( transform.mMatrix[i][j] );
+		offset[i] = _mm_set1_ps( transform.mOffset[i] );
+	}
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		const __m128 r = _mm_loadu_ps( src[0] + x ), g = _mm_loadu_ps( src[1] + x ), b = _mm_loadu_ps( src[2] + x );
+		__m128 results[3];
+		for( int k = 0; k < 3; ++k )
+			results[k] = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( matrix[k][0], r ), _mm_mul_ps( matrix[k][1], g ) ), _mm_mul_ps( matrix[k][2], b ) ), offset[k] );
+		for( int k = 0; k < 3; ++k )
+			_mm_storeu_ps( dst[k] + x, results[k] );
+	}
+	return x;
+}
+
+// Matches rgbToHSV() exactly
+int32_t rgbToHsv_sse( const float *const src[3], float *const dst[3], int32_t count, const ColorTransform & )
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1 ), two = _mm_set1_ps( 2 ), four = _mm_set1_ps( 4 ), six = _mm_set1_ps( 6 );
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		const __m128 r = _mm_loadu_ps( src[0] + x ), g = _mm_loadu_ps( src[1] + x ), b = _mm_loadu_ps( src[2] + x );
+		const __m128 max = _mm_max_ps( _mm_max_ps( r, g ), b ), min = _mm_min_ps( _mm_min_ps( r, g ), b );
+		const __m128 range = _mm_sub_ps( max, min );
+		// the divisions by zero these make are masked away
+		const __m128 sat = _mm_and_ps( _mm_cmpneq_ps( max, zero ), _mm_div_ps( range, max ) );
+		const __m128 isRed = _mm_cmpeq_ps( r, max ), isGreen = _mm_cmpeq_ps( g, max );
+		__m128 h = select_ps( isGreen, _mm_add_ps( two, _mm_div_ps( _mm_sub_ps( b, r ), range ) ), _mm_add_ps( four, _mm_div_ps( _mm_sub_ps( r, g ), range ) ) );
+		h = _mm_div_ps( select_ps( isRed, _mm_div_ps( _mm_sub_ps( g, b ), range ), h ), six );
+		h = _mm_add_ps( h, _mm_and_ps( _mm_cmplt_ps( h, zero ), one ) );
+		_mm_storeu_ps( dst[0] + x, _mm_and_ps( _mm_cmpneq_ps( sat, zero ), h ) );
+		_mm_storeu_ps( dst[1] + x, sat );
+		_mm_storeu_ps( dst[2] + x, max );
+	}
+	return x;
+}
+
+// Matches hsvToRGB() exactly
+int32_t hsvToRgb_sse( const float *const src[3], float *const dst[3], int32_t count, const ColorTransform & )
+{
+	const __m128 one = _mm_set1_ps( 1 ), six = _mm_set1_ps( 6 );
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		const __m128 hue = _mm_loadu_ps( src[0] + x ), sat = _mm_loadu_ps( src[1] + x ), val = _mm_loadu_ps( src[2] + x );
+		const __m128 h = _mm_andnot_ps( _mm_cmpeq_ps( hue, one ), _mm_mul_ps( hue, six ) );
+		// floor( h ), correcting truncation for negative hues
+		__m128i i = _mm_cvttps_epi32( h );
+		i = _mm_add_epi32( i, _mm_castps_si128( _mm_cmpgt_ps( _mm_cvtepi32_ps( i ), h ) ) );
+		const __m128 f = _mm_sub_ps( h, _mm_cvtepi32_ps( i ) );
+		const __m128 p = _mm_mul_ps( val, _mm_sub_ps( one, sat ) );
+		const __m128 q = _mm_mul_ps( val, _mm_sub_ps( one, _mm_mul_ps( sat, f ) ) );
+		const __m128 t = _mm_mul_ps( val, _mm_sub_ps( one, _mm_mul_ps( sat, _mm_sub_ps( one, f ) ) ) );
+		// each sector's red, green and blue, as in hsvToRGB()
+		const __m128 sectors[6][3] = { { val, t, p }, { q, val, p }, { p, val, t }, { p, q, val }, { t, p, val }, { val, p, q } };
+		__m128 results[3] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+		for( int s = 0; s < 6; ++s ) {
+			const __m128 inSector = _mm_castsi128_ps( _mm_cmpeq_epi32( i, _mm_set1_epi32( s ) ) );
+			for( int k = 0; k < 3; ++k )
+				results[k] = _mm_or_ps( results[k], _mm_and_ps( inSector, sectors[s][k] ) );
+		}
+		for( int k = 0; k < 3; ++k )
+			_mm_storeu_ps( dst[k] + x, results[k] );
+	}
+	return x;
+}
+
+// Converts linear RGB to Lab
+int32_t linearToLab_sse( const float *const src[3], float *const dst[3], int32_t count, const ColorTransform &transform )
+{
+	const __m128 epsilon = _mm_set1_ps( LAB_EPSILON ), slope = _mm_set1_ps( LAB_SLOPE ), intercept = _mm_set1_ps( LAB_INTERCEPT );
+	__m128 matrix[3][3];
+	for( int i = 0; i < 3; ++i )
+		for( int j = 0; j < 3; ++j )
+			matrix[i][j] = _mm_set1_ps( transform.mMatrix[i][j] );
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		const __m128 r = _mm_loadu_ps( src[0] + x ), g = _mm_loadu_ps( src[1] + x ), b = _mm_loadu_ps( src[2] + x );
+		__m128 f[3];
+		for( int k = 0; k < 3; ++k ) {
+			const __m128 t = _mm_add_ps( _mm_add_ps( _mm_mul_ps( matrix[k][0], r ), _mm_mul_ps( matrix[k][1], g ) ), _mm_mul_ps( matrix[k][2], b ) );
+			f[k] = select_ps( _mm_cmpgt_ps( t, epsilon ), cbrt_ps( t ), _mm_add_ps( _mm_mul_ps( t, slope ), intercept ) );
+		}
+		_mm_storeu_ps( dst[0] + x, _mm_sub_ps( _mm_mul_ps( f[1], _mm_set1_ps( 116 ) ), _mm_set1_ps( 16 ) ) );
+		_mm_storeu_ps( dst[1] + x, _mm_mul_ps( _mm_sub_ps( f[0], f[1] ), _mm_set1_ps( 500 ) ) );
+		_mm_storeu_ps( dst[2] + x, _mm_mul_ps( _mm_sub_ps( f[1], f[2] ), _mm_set1_ps( 200 ) ) );
+	}
+	return x;
+}
+
+// Converts Lab to sRGB. Since 1 / 2.4 = 1 / 4 + 1 / 6, the transfer curve's power is two square roots times the square root of a cube root.
+int32_t labToRgb_sse( const float *const src[3], float *const dst[3], int32_t count, const ColorTransform &transform )
+{
+	const __m128 delta = _mm_set1_ps( LAB_DELTA ), inverseSlope = _mm_set1_ps( 1 / LAB_SLOPE ), intercept = _mm_set1_ps( LAB_INTERCEPT );
+	const __m128 linearLimit = _mm_set1_ps( 0.0031308f );
+	__m128 matrix[3][3];
+	for( int i = 0; i < 3; ++i )
+		for( int j = 0; j < 3; ++j )
+			matrix[i][j] = _mm_set1_ps( transform.mMatrix[i][j] );
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		const __m128 fy = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( src[0] + x ), _mm_set1_ps( 16 ) ), _mm_set1_ps( 1 / 116.0f ) );
+		const __m128 f[3] = { _mm_add_ps( fy, _mm_mul_ps( _mm_loadu_ps( src[1] + x ), _mm_set1_ps( 1 / 500.0f ) ) ), fy,
+								_mm_sub_ps( fy, _mm_mul_ps( _mm_loadu_ps( src[2] + x ), _mm_set1_ps( 1 / 200.0f ) ) ) };
+		__m128 t[3];
+		for( int k = 0; k < 3; ++k )
+			t[k] = select_ps( _mm_cmpgt_ps( f[k], delta ), _mm_mul_ps( _mm_mul_ps( f[k], f[k] ), f[k] ), _mm_mul_ps( _mm_sub_ps( f[k], intercept ), inverseSlope ) );
+		__m128 results[3];
+		for( int k = 0; k < 3; ++k ) {
+			const __m128 l = _mm_add_ps( _mm_add_ps( _mm_mul_ps( matrix[k][0], t[0] ), _mm_mul_ps( matrix[k][1], t[1] ) ), _mm_mul_ps( matrix[k][2], t[2] ) );
+			const __m128 power = _mm_mul_ps( _mm_sqrt_ps( _mm_sqrt_ps( l ) ), _mm_sqrt_ps( cbrt_ps( l ) ) );
+			results[k] = select_ps( _mm_cmple_ps( l, linearLimit ), _mm_mul_ps( l, _mm_set1_ps( 12.92f ) ), _mm_sub_ps( _mm_mul_ps( power, _mm_set1_ps( 1.055f ) ), _mm_set1_ps( 0.055f ) ) );
+		}
+		for( int k = 0; k < 3; ++k )
+			_mm_storeu_ps( dst[k] + x, results[k] );
+	}
+	return x;
+}
+
+#endif // defined( CINDER_SSE2 )
+
+// The SIMD kernels, resolved per machine through DispatchTable; NULL where there is none
+struct ColorSpaceKernels {
+	ConvertFunc_u8		mAffine_u8;
+	ConvertFunc_float	mAffine_float, mRgbToHsv_float, mHsvToRgb_float, mLinearToLab_float, mLabToRgb_float;
+
+	static void resolve( System::SimdLevel level, ColorSpaceKernels *table )
+	{
+		table->mAffine_u8 = NULL;
+		table->mAffine_float = table->mRgbToHsv_float = table->mHsvToRgb_float = table->mLinearToLab_float = table->mLabToRgb_float = NULL;
+#if defined( CINDER_SSE2 )
+		if( level >= System::SIMD_SSE2 ) {
+			table->mAffine_u8 = &affine_sse2;
+			table->mAffine_float = &affine_sse;
+			table->mRgbToHsv_float = &rgbToHsv_sse;
+			table->mHsvToRgb_float = &hsvToRgb_sse;
+			table->mLinearToLab_float = &linearToLab_sse;
+			table->mLabToRgb_float = &labToRgb_sse;
+		}
+#endif
+	}
+};
+
+template<typename T>
+inline int32_t runKernel( int32_t (*func)( const T *const src[3], T *const dst[3], int32_t count, const ColorTransform &transform ),
+							const T *const src[3], T *const dst[3], int32_t count, const ColorTransform &transform )
+{
+	return ( func ) ? (*func)( src, dst, count, transform ) : 0;
+}
+
+// Converts \a count pixels of the planes \a src into \a dst, which may be the same
+void convertPixels( const ColorTransform &transform, const uint8_t *const src[3], uint8_t *const dst[3], int32_t count )
+{
+	const ColorSpaceKernels &kernels = DispatchTable<ColorSpaceKernels>::get();
+	int32_t x = 0;
+	if( transform.mSpace == CS_HSV && ! transform.mToRgb ) {
+		const HsvTables &hsv = HsvTables::get();
+		for( ; x < count; ++x ) {
+			const int32_t r = src[0][x], g = src[1][x], b = src[2][x];
+			const int32_t max = std::max( std::max( r, g ), b ), range = max - std::min( std::min( r, g ), b );
+			// the hue in sixths of a turn times range, then scaled to 255 per turn; a range of 0 leaves a hue and saturation of 0. Colors rarely
+			// repeat from one pixel to the next, so the sextant is selected with masks rather than branches, and negative hues wrapped likewise.
+			const int32_t redMax = -( r == max ), greenMax = -( g == max ) & ~redMax, blueMax = ~( redMax | greenMax );
+			const int32_t sixths = ( redMax & ( g - b ) ) | ( greenMax & ( b - r + 2 * range ) ) | ( blueMax & ( r - g + 4 * range ) );
+			const int32_t negative = -( sixths < 0 );
+			const int32_t h = ( ( ( sixths ^ negative ) - negative ) * hsv.mHue[range] + ( 1 << ( HsvTables::BITS - 1 ) ) ) >> HsvTables::BITS;
+			dst[0][x] = static_cast<uint8_t>( ( ( h ^ negative ) - negative ) + ( negative & 255 ) );
+			dst[1][x] = static_cast<uint8_t>( ( range * hsv.mSaturation[max] + ( 1 << ( HsvTables::BITS - 1 ) ) ) >> HsvTables::BITS );
+			dst[2][x] = static_cast<uint8_t>( max );
+		}
+	}
+	else if( transform.mSpace == CS_HSV ) {
+		for( ; x < count; ++x ) {
+			// each channel falls from v to v( 1 - s ) over a sixth of a turn, 255 per sixth here, starting a third of a turn after the previous one
+			const int32_t hue = src[0][x] * 6, s = src[1][x], v = src[2][x];
+			for( int k = 0; k < 3; ++k ) {
+				const int32_t position = ( ( 5 - 2 * k ) * 255 + hue ) % ( 6 * 255 );
+				const int32_t fall = constrain<int32_t>( std::min( position, 4 * 255 - position ), 0, 255 );
+				dst[k][x] = static_cast<uint8_t>( ( v * ( 255 * 255 - s * fall ) + 255 * 255 / 2 ) / ( 255 * 255 ) );
+			}
+		}
+	}
+	else if( transform.mSpace == CS_LAB && ! transform.mToRgb ) {
+		const LabTables &lab = LabTables::get();
+		for( ; x < count; ++x ) {
+			const int32_t linear[3] = { lab.mLinear8[src[0][x]], lab.mLinear8[src[1][x]], lab.mLinear8[src[2][x]] };
+			float f[3];
+			for( int k = 0; k < 3; ++k ) {
+				const int32_t t = ( transform.mFixedMatrix[k][0] * linear[0] + transform.mFixedMatrix[k][1] * linear[1] + transform.mFixedMatrix[k][2] * linear[2] + ( 1 << ( FIXED_BITS - 1 ) ) ) >> FIXED_BITS;
+				f[k] = lab.f( ( t < LabTables::LINEAR_ONE ) ? t : LabTables::LINEAR_ONE );
+			}
+			dst[0][x] = clampRound( ( f[1] * 116 - 16 ) * 2.55f );
+			dst[1][x] = clampRound( ( f[0] - f[1] ) * 500 + 128 );
+			dst[2][x] = clampRound( ( f[1] - f[2] ) * 200 + 128 );
+		}
+	}
+	else if( transform.mSpace == CS_LAB ) {
+		const LabTables &lab = LabTables::get();
+		for( ; x < count; ++x ) {
+			const float fy = lab.mL8[src[0][x]];
+			const float t[3] = { labFInverse( fy + lab.mA8[src[1][x]] ), labFInverse( fy ), labFInverse( fy - lab.mB8[src[2][x]] ) };
+			uint8_t results[3];
+			for( int k = 0; k < 3; ++k ) {
+				const float l = transform.mMatrix[k][0] * t[0] + transform.mMatrix[k][1] * t[1] + transform.mMatrix[k][2] * t[2];
+				results[k] = lab.mSrgb8[static_cast<int32_t>( constrain<float>( l, 0, 1 ) * LabTables::LINEAR_ONE + 0.5f )];
+			}
+			for( int k = 0; k < 3; ++k )
+				dst[k][x] = results[k];
+		}
+	}
+	else {
+		for( x += runKernel( kernels.mAffine_u8, src, dst, count, transform ); x < count; ++x ) {
+			const int32_t r = src[0][x], g = src[1][x], b = src[2][x];
+			uint8_t results[3];
+			for( int k = 0; k < 3; ++k ) {
+				const int32_t v = ( transform.mFixedMatrix[k][0] * r + transform.mFixedMatrix[k][1] * g + transform.mFixedMatrix[k][2] * b + transform.mFixedOffset[k] ) >> FIXED_BITS;
+				results[k] = static_cast<uint8_t>( constrain<int32_t>( v, 0, 255 ) );
+			}
+			for( int k = 0; k < 3; ++k )
+				dst[k][x] = results[k];
+		}
+	}
+}
+
+void convertPixels( const ColorTransform &transform, const float *const src[3], float *const dst[3], int32_t count )
+{
+	const ColorSpaceKernels &kernels = DispatchTable<ColorSpaceKernels>::get();
+	int32_t x = 0;
+	if( transform.mSpace == CS_HSV && ! transform.mToRgb ) {
+		for( x += runKernel( kernels.mRgbToHsv_float, src, dst, count, transform ); x < count; ++x ) {
+			const Vec3f hsv = rgbToHSV( Colorf( src[0][x], src[1][x], src[2][x] ) );
+			dst[0][x] = hsv.x;
+			dst[1][x] = hsv.y;
+			dst[2][x] = hsv.z;
+		}
+	}
+	else if( transform.mSpace == CS_HSV ) {
+		for( x += runKernel( kernels.mHsvToRgb_float, src, dst, count, transform ); x < count; ++x ) {
+			const Colorf rgb = hsvToRGB( Vec3f( src[0][x], src[1][x], src[2][x] ) );
+			dst[0][x] = rgb.r;
+			dst[1][x] = rgb.g;
+			dst[2][x] = rgb.b;
+		}
+	}
+	else if( transform.mSpace == CS_LAB && ! transform.mToRgb ) {
+		// linearized in place in dst, whose planes then feed the Lab kernel
+		const LabTables &lab = LabTables::get();
+		for( int32_t i = 0; i < count; ++i )
+			for( int k = 0; k < 3; ++k )
+				dst[k][i] = lab.linearize( src[k][i] );
+		for( x += runKernel( kernels.mLinearToLab_float, dst, dst, count, transform ); x < count; ++x ) {
+			float f[3];
+			for( int k = 0; k < 3; ++k )
+				f[k] = labF( transform.mMatrix[k][0] * dst[0][x] + transform.mMatrix[k][1] * dst[1][x] + transform.mMatrix[k][2] * dst[2][x] );
+			dst[0][x] = f[1] * 116 - 16;
+			dst[1][x] = ( f[0] - f[1] ) * 500;
+			dst[2][x] = ( f[1] - f[2] ) * 200;
+		}
+	}
+	else if( transform.mSpace == CS_LAB ) {
+		for( x += runKernel( kernels.mLabToRgb_float, src, dst, count, transform ); x < count; ++x ) {
+			const float fy = ( src[0][x] + 16 ) * ( 1 / 116.0f );
+			const float t[3] = { labFInverse( fy + src[1][x] * ( 1 / 500.0f ) ), labFInverse( fy ), labFInverse( fy - src[2][x] * ( 1 / 200.0f ) ) };
+			for( int k = 0; k < 3; ++k )
+				dst[k][x] = linearToSrgb( transform.mMatrix[k][0] * t[0] + transform.mMatrix[k][1] * t[1] + transform.mMatrix[k][2] * t[2] );
+		}
+	}
+	else {
+		for( x += runKernel( kernels.mAffine_float, src, dst, count, transform ); x < count; ++x ) {
+			const float r = src[0][x], g = src[1][x], b = src[2][x];
+			for( int k = 0; k < 3; ++k )
+				dst[k][x] = transform.mMatrix[k][0] * r + transform.mMatrix[k][1] * g + transform.mMatrix[k][2] * b + transform.mOffset[k];
+		}
+	}
+}
+
+// Copies \a count values from \a src to \a dst, stepping by \a srcInc and \a dstInc. Pixels' usual increments get loops of their own.
+template<typename T>
+void copyStrided( const T *src, uint8_t srcInc, T *dst, uint8_t dstInc, int32_t count )
+{
+	if( srcInc == 1 && dstInc == 3 )
+		for( int32_t i = 0; i < count; ++i ) dst[i * 3] = src[i];
+	else if( srcInc == 1 && dstInc == 4 )
+		for( int32_t i = 0; i < count; ++i ) dst[i * 4] = src[i];
+	else if( srcInc == 3 && dstInc == 1 )
+		for( int32_t i = 0; i < count; ++i ) dst[i] = src[i * 3];
+	else if( srcInc == 4 && dstInc == 1 )
+		for( int32_t i = 0; i < count; ++i ) dst[i] = src[i * 4];
+	else
+		for( int32_t i = 0; i < count; ++i ) dst[i * dstInc] = src[i * srcInc];
+}
+
+// Converts rows [y1, y2) of \a area from the planes \a src to \a dst a block at a time, gathering and scattering planes which are not contiguous.
+// Copies \a srcAlpha to \a dstAlpha if both are non-NULL.
+template<typename T>
+class ColorSpaceBand {
+  public:
+	ColorSpaceBand( const ChannelT<T> *const src[3], ChannelT<T> *const dst[3], const ChannelT<T> *srcAlpha, ChannelT<T> *dstAlpha, const Area &area, const ColorTransform *transform )
+		: mSrcAlpha( srcAlpha ), mDstAlpha( dstAlpha ), mArea( area ), mTransform( transform )
+	{
+		std::copy( src, src + 3, mSrc );
+		std::copy( dst, dst + 3, mDst );
+	}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		T srcBlock[3][BLOCK_SIZE], dstBlock[3][BLOCK_SIZE];
+		for( int32_t y = y1; y < y2; ++y ) {
+			for( int32_t x1 = mArea.x1; x1 < mArea.x2; x1 += BLOCK_SIZE ) {
+				const int32_t count = std::min( BLOCK_SIZE, mArea.x2 - x1 );
+				const T *src[3];
+				T *dst[3];
+				for( int k = 0; k < 3; ++k ) {
+					const T *srcRow = mSrc[k]->getData( x1, y );
+					if( mSrc[k]->getIncrement() == 1 )
+						src[k] = srcRow;
+					else {
+						copyStrided( srcRow, mSrc[k]->getIncrement(), srcBlock[k], 1, count );
+						src[k] = srcBlock[k];
+					}
+					dst[k] = ( mDst[k]->getIncrement() == 1 ) ? mDst[k]->getData( x1, y ) : dstBlock[k];
+				}
+
+				convertPixels( *mTransform, src, dst, count );
+
+				for( int k = 0; k < 3; ++k )
+					if( mDst[k]->getIncrement() != 1 )
+						copyStrided( dstBlock[k], 1, mDst[k]->getData( x1, y ), mDst[k]->getIncrement(), count );
+			}
+
+			if( mSrcAlpha && mDstAlpha )
+				copyStrided( mSrcAlpha->getData( mArea.x1, y ), mSrcAlpha->getIncrement(), mDstAlpha->getData( mArea.x1, y ), mDstAlpha->getIncrement(), mArea.getWidth() );
+		}
+	}
+
+  private:
+	const ChannelT<T>		*mSrc[3];
+	ChannelT<T>				*mDst[3];
+	const ChannelT<T>		*mSrcAlpha;
+	ChannelT<T>				*mDstAlpha;
+	Area					mArea;
+	const ColorTransform	*mTransform;
+};
+
+template<typename T>
+void convert( const ChannelT<T> *const src[3], ChannelT<T> *const dst[3], const ChannelT<T> *srcAlpha, ChannelT<T> *dstAlpha, ColorSpace space, bool toRgb )
+{
+	Area area = src[0]->getBounds();
+	for( int k = 0; k < 3; ++k )
+		area = area.getClipBy( src[k]->getBounds() ).getClipBy( dst[k]->getBounds() );
+	const ColorTransform transform( space, toRgb );
+	parallelRows( area.y1, area.y2, ColorSpaceBand<T>( src, dst, srcAlpha, dstAlpha, area, &transform ) );
+}
+
+// The alpha Channels of \a srcSurface and \a dstSurface if both have one and they are not the same
+template<typename T>
+void alphaChannels( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ChannelT<T> **srcAlpha, ChannelT<T> **dstAlpha )
+{
+	const bool copyAlpha = srcSurface.hasAlpha() && dstSurface->hasAlpha() && ( srcSurface.getData() != dstSurface->getData() );
+	*srcAlpha = ( copyAlpha ) ? &srcSurface.getChannelAlpha() : NULL;
+	*dstAlpha = ( copyAlpha ) ? &dstSurface->getChannelAlpha() : NULL;
+}
+
+} // anonymous namespace
+
+template<typename T>
+void rgbToColorSpace( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, ColorSpace space )
+{
+	const ChannelT<T> *src[3] = { &srcSurface.getChannelRed(), &srcSurface.getChannelGreen(), &srcSurface.getChannelBlue() };
+	ChannelT<T> *dst[3] = { &dstSurface->getChannelRed(), &dstSurface->getChannelGreen(), &dstSurface->getChannelBlue() };
+	const ChannelT<T> *srcAlpha;
+	ChannelT<T> *dstAlpha;
+	alphaChannels( srcSurface, dstSurface, &srcAlpha, &dstAlpha );
+	convert( src, dst, srcAlpha, dstAlpha, space, false );
+}
+
+template<typename T>
+void rgbToColorSpace( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel0, ChannelT<T> *dstChannel1, ChannelT<T> *dstChannel2, ColorSpace space )
+{
+	const ChannelT<T> *src[3] = { &srcSurface.getChannelRed(), &srcSurface.getChannelGreen(), &srcSurface.getChannelBlue() };
+	ChannelT<T> *dst[3] = { dstChannel0, dstChannel1, dstChannel2 };
+	convert<T>( src, dst, NULL, NULL, space, false );
+}
+
+template<typename T>
+void colorSpaceToRgb( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, ColorSpace space )
+{
+	const ChannelT<T> *src[3] = { &srcSurface.getChannelRed(), &srcSurface.getChannelGreen(), &srcSurface.getChannelBlue() };
+	ChannelT<T> *dst[3] = { &dstSurface->getChannelRed(), &dstSurface->getChannelGreen(), &dstSurface->getChannelBlue() };
+	const ChannelT<T> *srcAlpha;
+	ChannelT<T> *dstAlpha;
+	alphaChannels( srcSurface, dstSurface, &srcAlpha, &dstAlpha );
+	convert( src, dst, srcAlpha, dstAlpha, space, true );
+}
+
+template<typename T>
+void colorSpaceToRgb( const ChannelT<T> &srcChannel0, const ChannelT<T> &srcChannel1, const ChannelT<T> &srcChannel2, SurfaceT<T> *dstSurface, ColorSpace space )
+{
+	const ChannelT<T> *src[3] = { &srcChannel0, &srcChannel1, &srcChannel2 };
+	ChannelT<T> *dst[3] = { &dstSurface->getChannelRed(), &dstSurface->getChannelGreen(), &dstSurface->getChannelBlue() };
+	convert<T>( src, dst, NULL, NULL, space, true );
+}
+
+#define colorSpace_PROTOTYPES(r,data,T)\
+	template void rgbToColorSpace( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, ColorSpace space );\
+	template void rgbToColorSpace( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel0, ChannelT<T> *dstChannel1, ChannelT<T> *dstChannel2, ColorSpace space );\
+	template void colorSpaceToRgb( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, ColorSpace space );\
+	template void colorSpaceToRgb( const ChannelT<T> &srcChannel0, const ChannelT<T> &srcChannel1, const ChannelT<T> &srcChannel2, SurfaceT<T> *dstSurface, ColorSpace space );
+
+BOOST_PP_SEQ_FOR_EACH( colorSpace_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -0,0 +1,475 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Convolve.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include "ImagePlane.h"
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+using std::vector;
+
+namespace cinder { namespace ip {
+
+ConvolutionKernel::ConvolutionKernel( int32_t width, int32_t height, const float *weights, float bias )
+	: mWidth( width ), mHeight( height ), mWeights( weights, weights + width * height ), mBias( bias ), mSeparable( false )
+{
+	findFactors();
+}
+
+ConvolutionKernel::ConvolutionKernel( const vector<float> &horizontal, const vector<float> &vertical, float bias )
+	: mWidth( (int32_t)horizontal.size() ), mHeight( (int32_t)vertical.size() ), mHorizontal( horizontal ), mVertical( vertical ), mBias( bias ), mSeparable( true )
+{
+	for( int32_t y = 0; y < mHeight; ++y )
+		for( int32_t x = 0; x < mWidth; ++x )
+			mWeights.push_back( horizontal[x] * vertical[y] );
+}
+
+// A kernel is separable when it has rank one, in which case every row is a multiple of the row holding the largest weight
+void ConvolutionKernel::findFactors()
+{
+	if( mWeights.empty() )
+		return;
+
+	size_t pivot = 0;
+	for( size_t i = 1; i < mWeights.size(); ++i )
+		if( fabs( mWeights[i] ) > fabs( mWeights[pivot] ) )
+			pivot = i;
+	const float pivotWeight = mWeights[pivot];
+	if( pivotWeight == 0 )
+		return;
+
+	const int32_t pivotX = (int32_t)pivot % mWidth, pivotY = (int32_t)pivot / mWidth;
+	vector<float> horizontal( mWeights.begin() + pivotY * mWidth, mWeights.begin() + ( pivotY + 1 ) * mWidth ), vertical( mHeight );
+	for( int32_t y = 0; y < mHeight; ++y )
+		vertical[y] = mWeights[y * mWidth + pivotX] / pivotWeight;
+
+	const float tolerance = 1.0e-5f * fabs( pivotWeight );
+	for( int32_t y = 0; y < mHeight; ++y )
+		for( int32_t x = 0; x < mWidth; ++x )
+			if( fabs( horizontal[x] * vertical[y] - mWeights[y * mWidth + x] ) > tolerance )
+				return;
+
+	mHorizontal.swap( horizontal );
+	mVertical.swap( vertical );
+	mSeparable = true;
+}
+
+namespace {
+
+int32_t borderIndex( int32_t i, int32_t size, BorderMode border )
+{
+	if( ( i >= 0 ) && ( i < size ) )
+		return i;
+
+	switch( border ) {
+		case BORDER_WRAP:
+			i %= size;
+			return ( i < 0 ) ? i + size : i;
+		case BORDER_MIRROR: {
+			if( size == 1 )
+				return 0;
+			const int32_t period = 2 * size - 2;
+			i %= period;
+			if( i < 0 )
+				i += period;
+			return ( i < size ) ? i : period - i;
+		}
+		default:
+			return ( i < 0 ) ? 0 : size - 1;
+	}
+}
+
+// Source lines are held as int16_t with int32_t sums for fixed-point 8u convolution, and as float otherwise
+template<typename LINET>
+struct ACCUMTRAIT {
+	typedef float ACCT;
+};
+
+template<>
+struct ACCUMTRAIT<int16_t> {
+	typedef int32_t ACCT;
+};
+
+/* Weights and shifts for applying a kernel. In fixed point, a separable kernel's horizontal pass leaves its results scaled by 2^(intermediate bits)
+   in an int16_t, which the vertical pass multiplies by weights scaled by 2^(vertical bits); mFinalShift removes both scales. */
+template<typename LINET>
+struct ConvolvePlan {
+	typedef typename ACCUMTRAIT<LINET>::ACCT ACCT;
+
+	ConvolvePlan() : mSeparable( false ), mKernelWidth( 0 ), mKernelHeight( 0 ), mHorizontalShift( 0 ), mFinalShift( 0 ), mFinalOffset( 0 ) {}
+
+	bool			mSeparable;
+	int32_t			mKernelWidth, mKernelHeight;
+	vector<LINET>	mWeights;		// row-major weights of a 2D kernel, or the vertical factor of a separable one
+	vector<LINET>	mHorizontal;	// the horizontal factor of a separable kernel
+	int32_t			mHorizontalShift, mFinalShift;
+	ACCT			mFinalOffset;	// bias and rounding, added before mFinalShift
+};
+
+float sumOfAbs( const vector<float> &weights )
+{
+	float result = 0;
+	for( size_t i = 0; i < weights.size(); ++i )
+		result += fabs( weights[i] );
+	return result;
+}
+
+float maxAbs( const vector<float> &weights )
+{
+	float result = 0;
+	for( size_t i = 0; i < weights.size(); ++i )
+		result = std::max( result, fabs( weights[i] ) );
+	return result;
+}
+
+// Returns the largest number of fractional bits, up to 14, for which every weight fits in an int16_t and \a maxSum stays below 2^30
+int32_t fixedPointBits( float maxWeight, float maxSum )
+{
+	int32_t bits = 14;
+	while( ( bits >= 0 ) && ( ( maxWeight * ( 1 << bits ) > 32767 ) || ( maxSum * ( 1 << bits ) > ( 1 << 30 ) ) ) )
+		--bits;
+	return bits;
+}
+
+// Rounds \a weights to \a bits fractional bits, adjusting the largest so the rounded weights sum to the rounded original sum, as makeWeightTable() does in Resize.cpp
+vector<int16_t> quantizeWeights( const vector<float> &weights, int32_t bits )
+{
+	vector<int16_t> result( weights.size() );
+	float sum = 0;
+	int32_t quantizedSum = 0;
+	size_t largest = 0;
+	for( size_t i = 0; i < weights.size(); ++i ) {
+		result[i] = static_cast<int16_t>( floor( weights[i] * ( 1 << bits ) + 0.5f ) );
+		sum += weights[i];
+		quantizedSum += result[i];
+		if( fabs( weights[i] ) > fabs( weights[largest] ) )
+			largest = i;
+	}
+	const int32_t adjusted = result[largest] + (int32_t)floor( sum * ( 1 << bits ) + 0.5f ) - quantizedSum;
+	result[largest] = static_cast<int16_t>( std::min( std::max( adjusted, -32767 ), 32767 ) );
+	
+	return result;
+}
+
+int32_t roundedOffset( float bias, int32_t shift )
+{
+	return (int32_t)floor( bias * ( 1 << shift ) + 0.5f ) + ( ( shift > 0 ) ? ( 1 << ( shift - 1 ) ) : 0 );
+}
+
+// Returns false when the kernel's weights would lose too much precision in fixed point
+bool makeFixedPointPlan( const ConvolutionKernel &kernel, ConvolvePlan<int16_t> *plan )
+{
+	const float absBias = fabs( kernel.getBias() );
+	plan->mKernelWidth = kernel.getWidth();
+	plan->mKernelHeight = kernel.getHeight();
+	plan->mSeparable = kernel.isSeparable() && ( kernel.getWidth() > 1 ) && ( kernel.getHeight() > 1 );
+	if( plan->mSeparable ) {
+		const vector<float> &horizontal = kernel.getHorizontal(), &vertical = kernel.getVertical();
+		const float horizontalSum = sumOfAbs( horizontal );
+		int32_t intermediateBits = 7;
+		while( ( intermediateBits >= 0 ) && ( 255 * horizontalSum * ( 1 << intermediateBits ) > 32767 ) )
+			--intermediateBits;
+		const int32_t horizontalBits = fixedPointBits( maxAbs( horizontal ), 255 * horizontalSum );
+		const float intermediateMax = 255 * horizontalSum * ( 1 << intermediateBits ) + 1;
+		const int32_t verticalBits = fixedPointBits( maxAbs( vertical ), intermediateMax * sumOfAbs( vertical ) + absBias * ( 1 << intermediateBits ) );
+		if( ( intermediateBits < 4 ) || ( horizontalBits < 8 ) || ( horizontalBits < intermediateBits ) || ( verticalBits < 6 ) )
+			return false;
+
+		plan->mHorizontal = quantizeWeights( horizontal, horizontalBits );
+		plan->mWeights = quantizeWeights( vertical, verticalBits );
+		plan->mHorizontalShift = horizontalBits - intermediateBits;
+		plan->mFinalShift = intermediateBits + verticalBits;
+	}
+	else {
+		const int32_t bits = fixedPointBits( maxAbs( kernel.getWeights() ), 255 * sumOfAbs( kernel.getWeights() ) + absBias );
+		if( bits < 8 )
+			return false;
+
+		plan->mWeights = quantizeWeights( kernel.getWeights(), bits );
+		plan->mFinalShift = bits;
+	}
+	plan->mFinalOffset = roundedOffset( kernel.getBias(), plan->mFinalShift );
+	
+	return true;
+}
+
+ConvolvePlan<float> makeFloatPlan( const ConvolutionKernel &kernel )
+{
+	ConvolvePlan<float> plan;
+	plan.mKernelWidth = kernel.getWidth();
+	plan.mKernelHeight = kernel.getHeight();
+	plan.mSeparable = kernel.isSeparable() && ( kernel.getWidth() > 1 ) && ( kernel.getHeight() > 1 );
+	plan.mWeights = ( plan.mSeparable ) ? kernel.getVertical() : kernel.getWeights();
+	if( plan.mSeparable )
+		plan.mHorizontal = kernel.getHorizontal();
+	plan.mFinalOffset = kernel.getBias();
+	
+	return plan;
+}
+
+#if defined( CINDER_SSE2 )
+// Sums pairs of taps with a single multiply-add over interleaved 16-bit lanes, 8 pixels per iteration
+int32_t accumulateTaps_sse2( const int16_t *const *taps, const int16_t *weights, int32_t numTaps, int32_t width, int32_t *acc )
+{
+	const int32_t simdWidth = width & ~7;
+	for( int32_t x = 0; x < simdWidth; x += 8 ) {
+		__m128i sumLo = _mm_setzero_si128(), sumHi = _mm_setzero_si128();
+		for( int32_t k = 0; k < numTaps; k += 2 ) {
+			const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( taps[k] + x ) );
+			const __m128i b = ( k + 1 < numTaps ) ? _mm_loadu_si128( reinterpret_cast<const __m128i*>( taps[k + 1] + x ) ) : _mm_setzero_si128();
+			const uint32_t packed = (uint16_t)weights[k] | ( ( k + 1 < numTaps ) ? ( (uint32_t)(uint16_t)weights[k + 1] << 16 ) : 0 );
+			const __m128i w = _mm_set1_epi32( (int32_t)packed );
+			sumLo = _mm_add_epi32( sumLo, _mm_madd_epi16( _mm_unpacklo_epi16( a, b ), w ) );
+			sumHi = _mm_add_epi32( sumHi, _mm_madd_epi16( _mm_unpackhi_epi16( a, b ), w ) );
+		}
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( acc + x ), sumLo );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( acc + x + 4 ), sumHi );
+	}
+	
+	return simdWidth;
+}
+
+int32_t accumulateTaps_sse2( const float *const *taps, const float *weights, int32_t numTaps, int32_t width, float *acc )
+{
+	const int32_t simdWidth = width & ~7;
+	for( int32_t x = 0; x < simdWidth; x += 8 ) {
+		__m128 sumLo = _mm_setzero_ps(), sumHi = _mm_setzero_ps();
+		for( int32_t k = 0; k < numTaps; ++k ) {
+			const __m128 w = _mm_set1_ps( weights[k] );
+			sumLo = _mm_add_ps( sumLo, _mm_mul_ps( w, _mm_loadu_ps( taps[k] + x ) ) );
+			sumHi = _mm_add_ps( sumHi, _mm_mul_ps( w, _mm_loadu_ps( taps[k] + x + 4 ) ) );
+		}
+		_mm_storeu_ps( acc + x, sumLo );
+		_mm_storeu_ps( acc + x + 4, sumHi );
+	}
+	
+	return simdWidth;
+}
+#endif
+
+// acc[x] = sum of weights[k] * taps[k][x] over the \a numTaps taps
+template<typename LINET, typename ACCT>
+void accumulateTaps( const LINET *const *taps, const LINET *weights, int32_t numTaps, int32_t width, ACCT *acc, bool useSse )
+{
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( useSse )
+		x = accumulateTaps_sse2( taps, weights, numTaps, width, acc );
+#endif
+	for( ; x < width; ++x ) {
+		ACCT sum = 0;
+		for( int32_t k = 0; k < numTaps; ++k )
+			sum += weights[k] * taps[k][x];
+		acc[x] = sum;
+	}
+}
+
+void accumToIntermediate( const int32_t *acc, int32_t width, int32_t shift, int16_t *out )
+{
+	const int32_t round = ( shift > 0 ) ? ( 1 << ( shift - 1 ) ) : 0;
+	for( int32_t x = 0; x < width; ++x )
+		out[x] = static_cast<int16_t>( std::min( std::max( ( acc[x] + round ) >> shift, -32768 ), 32767 ) );
+}
+
+void accumToIntermediate( const float *acc, int32_t width, int32_t /*shift*/, float *out )
+{
+	std::copy( acc, acc + width, out );
+}
+
+void accumToChannel( const int32_t *acc, int32_t width, int32_t shift, int32_t offset, uint8_t *dst, uint8_t pixelInc )
+{
+	for( int32_t x = 0; x < width; ++x, dst += pixelInc )
+		*dst = static_cast<uint8_t>( std::min( std::max( ( acc[x] + offset ) >> shift, 0 ), 255 ) );
+}
+
+void accumToChannel( const float *acc, int32_t width, int32_t /*shift*/, float bias, uint8_t *dst, uint8_t pixelInc )
+{
+	for( int32_t x = 0; x < width; ++x, dst += pixelInc ) {
+		const float v = acc[x] + bias;
+		*dst = ( v <= 0 ) ? 0 : ( ( v >= 255 ) ? 255 : static_cast<uint8_t>( v + 0.5f ) );
+	}
+}
+
+void accumToChannel( const float *acc, int32_t width, int32_t /*shift*/, float bias, float *dst, uint8_t pixelInc )
+{
+	for( int32_t x = 0; x < width; ++x, dst += pixelInc )
+		*dst = acc[x] + bias;
+}
+
+// Convolves rows [y1, y2) of every channel
+template<typename T, typename LINET>
+class ConvolveBand {
+  public:
+	typedef typename ACCUMTRAIT<LINET>::ACCT ACCT;
+
+	ConvolveBand( const ConvolvePlan<LINET> *plan, const ImagePlane *src, const ImagePlane *dst, const vector<int32_t> *srcColumns, int32_t width, int32_t height, BorderMode border, bool useSse )
+		: mPlan( plan ), mSrc( src ), mDst( dst ), mSrcColumns( srcColumns ), mWidth( width ), mHeight( height ), mBorder( border ), mUseSse( useSse )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const ConvolvePlan<LINET> &plan = *mPlan;
+		const int32_t kernelWidth = plan.mKernelWidth, kernelHeight = plan.mKernelHeight;
+		const int32_t paddedWidth = mWidth + kernelWidth - 1;
+		// a ring of the source rows contributing to the current output row: padded rows for 2D kernels, horizontally filtered rows for separable ones
+		const int32_t ringWidth = ( plan.mSeparable ) ? mWidth : paddedWidth;
+		vector<LINET> ring( ringWidth * kernelHeight ), padded( paddedWidth );
+		vector<int32_t> ringRows( kernelHeight );
+		vector<ACCT> acc( mWidth );
+		vector<const LINET*> horizontalTaps( kernelWidth ), taps( ( plan.mSeparable ) ? kernelHeight : kernelWidth * kernelHeight );
+		for( int32_t i = 0; i < kernelWidth; ++i )
+			horizontalTaps[i] = &padded[i];
+
+		for( uint8_t c = 0; c < mSrc->mNumChannels; ++c ) {
+			std::fill( ringRows.begin(), ringRows.end(), std::numeric_limits<int32_t>::min() );
+			for( int32_t y = y1; y < y2; ++y ) {
+				for( int32_t j = 0; j < kernelHeight; ++j ) {
+					// slots are assigned by unmapped row so the rows of one window never collide, whatever the border mode
+					const int32_t row = y + j - kernelHeight / 2;
+					const int32_t slot = ( ( row % kernelHeight ) + kernelHeight ) % kernelHeight;
+					LINET *line = &ring[slot * ringWidth];
+					if( ringRows[slot] != row ) {
+						const T *src = reinterpret_cast<const T*>( mSrc->mData + borderIndex( row, mHeight, mBorder ) * mSrc->mRowBytes ) + mSrc->mOffsets[c];
+						LINET *dstLine = ( plan.mSeparable ) ? &padded[0] : line;
+						for( int32_t p = 0; p < paddedWidth; ++p )
+							dstLine[p] = static_cast<LINET>( src[(*mSrcColumns)[p]] );
+						if( plan.mSeparable ) {
+							accumulateTaps( &horizontalTaps[0], &plan.mHorizontal[0], kernelWidth, mWidth, &acc[0], mUseSse );
+							accumToIntermediate( &acc[0], mWidth, plan.mHorizontalShift, line );
+						}
+						ringRows[slot] = row;
+					}
+					if( plan.mSeparable )
+						taps[j] = line;
+					else
+						for( int32_t i = 0; i < kernelWidth; ++i )
+							taps[j * kernelWidth + i] = line + i;
+				}
+
+				accumulateTaps( &taps[0], &plan.mWeights[0], (int32_t)taps.size(), mWidth, &acc[0], mUseSse );
+				T *dst = reinterpret_cast<T*>( mDst->mData + y * mDst->mRowBytes ) + mDst->mOffsets[c];
+				accumToChannel( &acc[0], mWidth, plan.mFinalShift, plan.mFinalOffset, dst, mDst->mPixelInc );
+			}
+		}
+	}
+
+  private:
+	const ConvolvePlan<LINET>	*mPlan;
+	const ImagePlane			*mSrc, *mDst;
+	const vector<int32_t>		*mSrcColumns;
+	int32_t						mWidth, mHeight;
+	BorderMode					mBorder;
+	bool						mUseSse;
+};
+
+template<typename T, typename LINET>
+void convolveImpl( const ConvolvePlan<LINET> &plan, const ImagePlane &src, const ImagePlane &dst, int32_t width, int32_t height, BorderMode border )
+{
+	// maps each pixel of a padded row to the offset of its source pixel
+	vector<int32_t> srcColumns( width + plan.mKernelWidth - 1 );
+	for( size_t p = 0; p < srcColumns.size(); ++p )
+		srcColumns[p] = borderIndex( (int32_t)p - plan.mKernelWidth / 2, width, border ) * src.mPixelInc;
+
+	bool useSse = false;
+#if defined( CINDER_SSE2 )
+	useSse = System::hasSse2();
+#endif
+
+	parallelRows( 0, height, ConvolveBand<T,LINET>( &plan, &src, &dst, &srcColumns, width, height, border, useSse ), std::max<int32_t>( 1, 4096 / width ) );
+}
+
+template<typename T>
+struct ConvolveDispatch;
+
+template<>
+struct ConvolveDispatch<uint8_t> {
+	static void run( const ConvolutionKernel &kernel, const ImagePlane &src, const ImagePlane &dst, int32_t width, int32_t height, BorderMode border )
+	{
+		ConvolvePlan<int16_t> fixedPlan;
+		if( makeFixedPointPlan( kernel, &fixedPlan ) )
+			convolveImpl<uint8_t,int16_t>( fixedPlan, src, dst, width, height, border );
+		else
+			convolveImpl<uint8_t,float>( makeFloatPlan( kernel ), src, dst, width, height, border );
+	}
+};
+
+template<>
+struct ConvolveDispatch<float> {
+	static void run( const ConvolutionKernel &kernel, const ImagePlane &src, const ImagePlane &dst, int32_t width, int32_t height, BorderMode border )
+	{
+		convolveImpl<float,float>( makeFloatPlan( kernel ), src, dst, width, height, border );
+	}
+};
+
+} // anonymous namespace
+
+template<typename T>
+void convolve( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border )
+{
+	if( kernel.getWeights().empty() )
+		return;
+
+	ImagePlane src( srcSurface.getData(), srcSurface.getRowBytes(), srcSurface.getPixelInc() );
+	ImagePlane dst( dstSurface->getData(), dstSurface->getRowBytes(), dstSurface->getPixelInc() );
+	src.addChannel( srcSurface.getRedOffset() ); dst.addChannel( dstSurface->getRedOffset() );
+	src.addChannel( srcSurface.getGreenOffset() ); dst.addChannel( dstSurface->getGreenOffset() );
+	src.addChannel( srcSurface.getBlueOffset() ); dst.addChannel( dstSurface->getBlueOffset() );
+	if( srcSurface.hasAlpha() && dstSurface->hasAlpha() ) {
+		src.addChannel( srcSurface.getAlphaOffset() );
+		dst.addChannel( dstSurface->getAlphaOffset() );
+	}
+
+	const int32_t width = std::min( srcSurface.getWidth(), dstSurface->getWidth() ), height = std::min( srcSurface.getHeight(), dstSurface->getHeight() );
+	if( ( width > 0 ) && ( height > 0 ) )
+		ConvolveDispatch<T>::run( kernel, src, dst, width, height, border );
+}
+
+template<typename T>
+void convolve( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border )
+{
+	if( kernel.getWeights().empty() )
+		return;
+
+	ImagePlane src( srcChannel.getData(), srcChannel.getRowBytes(), srcChannel.getIncrement() );
+	ImagePlane dst( dstChannel->getData(), dstChannel->getRowBytes(), dstChannel->getIncrement() );
+	src.addChannel( 0 );
+	dst.addChannel( 0 );
+
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( ( width > 0 ) && ( height > 0 ) )
+		ConvolveDispatch<T>::run( kernel, src, dst, width, height, border );
+}
+
+#define convolve_PROTOTYPES(r,data,T)\
+	template void convolve( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ConvolutionKernel &kernel, BorderMode border ); \
+	template void convolve( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ConvolutionKernel &kernel, BorderMode border );
+
+BOOST_PP_SEQ_FOR_EACH( convolve_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -0,0 +1,231 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/DistanceTransform.h"
+#include "cinder/ip/Parallel.h"
+
+#include <vector>
+#include <limits>
+#include <cmath>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// First pass: the distance down each column to the nearest target pixel, which is a foreground pixel or, if \a invert, a background pixel.
+// Whole rows of a band of columns are scanned at a time. Columns without a target are left at \a far.
+class ColumnPass {
+  public:
+	ColumnPass( const Channel8u *src, Channel32f *dst, int32_t height, uint8_t threshold, bool invert, float far )
+		: mSrc( src ), mDst( dst ), mHeight( height ), mThreshold( threshold ), mInvert( invert ), mFar( far )
+	{}
+
+	void operator()( int32_t x1, int32_t x2 ) const
+	{
+		const int8_t srcInc = mSrc->getIncrement(), dstInc = mDst->getIncrement();
+		for( int32_t y = 0; y < mHeight; ++y ) {
+			const uint8_t *src = mSrc->getData( x1, y );
+			float *dst = mDst->getData( x1, y );
+			if( y == 0 ) {
+				for( int32_t x = x1; x < x2; ++x, src += srcInc, dst += dstInc )
+					*dst = ( ( *src > mThreshold ) != mInvert ) ? 0 : mFar;
+			}
+			else {
+				const float *above = mDst->getData( x1, y - 1 );
+				for( int32_t x = x1; x < x2; ++x, src += srcInc, dst += dstInc, above += dstInc )
+					*dst = ( ( *src > mThreshold ) != mInvert ) ? 0 : std::min( *above + 1, mFar );
+			}
+		}
+		for( int32_t y = mHeight - 2; y >= 0; --y ) {
+			float *dst = mDst->getData( x1, y );
+			const float *below = mDst->getData( x1, y + 1 );
+			for( int32_t x = x1; x < x2; ++x, dst += dstInc, below += dstInc )
+				*dst = std::min( *dst, *below + 1 );
+		}
+	}
+
+  private:
+	const Channel8u		*mSrc;
+	Channel32f			*mDst;
+	int32_t				mHeight;
+	uint8_t				mThreshold;
+	bool				mInvert;
+	float				mFar;
+};
+
+// Second pass: the exact distance along each row, the lower envelope of the parabolas centered on each column's distance (Felzenszwalb & Huttenlocher).
+// For a signed distance the rows of \a inside are transformed as well and subtracted.
+class EuclideanRowPass {
+  public:
+	EuclideanRowPass( Channel32f *dst, Channel32f *inside, int32_t width, float far )
+		: mDst( dst ), mInside( inside ), mWidth( width ), mFar( far )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		std::vector<double> f( mWidth ), z( mWidth + 1 );
+		std::vector<int32_t> v( mWidth );
+		std::vector<float> outside( mWidth ), inside( ( mInside ) ? mWidth : 0 );
+		const int8_t inc = mDst->getIncrement();
+		for( int32_t y = y1; y < y2; ++y ) {
+			envelope( mDst->getData( 0, y ), inc, &f[0], &z[0], &v[0], &outside[0] );
+			if( mInside )
+				envelope( mInside->getData( 0, y ), mInside->getIncrement(), &f[0], &z[0], &v[0], &inside[0] );
+
+			float *dst = mDst->getData( 0, y );
+			for( int32_t x = 0; x < mWidth; ++x, dst += inc )
+				*dst = ( mInside ) ? outside[x] - inside[x] : outside[x];
+		}
+	}
+
+  private:
+	// Writes to \a result the distances along the row of column distances \a g
+	void envelope( const float *g, int8_t inc, double *f, double *z, int32_t *v, float *result ) const
+	{
+		const double infinity = std::numeric_limits<double>::infinity(), far = (double)mFar * mFar;
+		for( int32_t x = 0; x < mWidth; ++x, g += inc )
+			f[x] = (double)*g * *g;
+
+		int32_t k = 0;
+		v[0] = 0;
+		z[0] = -infinity;
+		z[1] = infinity;
+		for( int32_t q = 1; q < mWidth; ++q ) {
+			// z[0] is -infinity, so the first parabola is never removed
+			double s = intersection( f, q, v[k] );
+			while( s <= z[k] )
+				s = intersection( f, q, v[--k] );
+			++k;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = infinity;
+		}
+
+		k = 0;
+		for( int32_t q = 0; q < mWidth; ++q ) {
+			while( z[k + 1] < q )
+				++k;
+			const double d = (double)( q - v[k] ) * ( q - v[k] ) + f[v[k]];
+			// only columns without a target reach the far distance
+			result[q] = ( d >= far ) ? std::numeric_limits<float>::infinity() : (float)std::sqrt( d );
+		}
+	}
+
+	// Returns where the parabolas centered on \a q and \a p intersect
+	static double intersection( const double *f, int32_t q, int32_t p ) { return ( ( f[q] + (double)q * q ) - ( f[p] + (double)p * p ) ) / ( 2.0 * ( q - p ) ); }
+
+	Channel32f		*mDst, *mInside;
+	int32_t			mWidth;
+	float			mFar;
+};
+
+// The 3-4 chamfer distance to the nearest target pixel, in a forward and a backward raster scan
+void chamfer( const Channel8u &src, Channel32f *dst, int32_t width, int32_t height, uint8_t threshold, bool invert )
+{
+	const float far = 4.0f * ( width + height );
+	const int8_t srcInc = src.getIncrement(), inc = dst->getIncrement();
+	for( int32_t y = 0; y < height; ++y ) {
+		const uint8_t *srcRow = src.getData( 0, y );
+		float *row = dst->getData( 0, y );
+		const float *above = ( y > 0 ) ? dst->getData( 0, y - 1 ) : 0;
+		for( int32_t x = 0; x < width; ++x ) {
+			float d = 0;
+			if( ( srcRow[x * srcInc] > threshold ) == invert ) {
+				d = far;
+				if( x > 0 )
+					d = std::min( d, row[( x - 1 ) * inc] + 3 );
+				if( above ) {
+					d = std::min( d, above[x * inc] + 3 );
+					if( x > 0 )
+						d = std::min( d, above[( x - 1 ) * inc] + 4 );
+					if( x + 1 < width )
+						d = std::min( d, above[( x + 1 ) * inc] + 4 );
+				}
+			}
+			row[x * inc] = d;
+		}
+	}
+
+	for( int32_t y = height - 1; y >= 0; --y ) {
+		float *row = dst->getData( 0, y );
+		const float *below = ( y + 1 < height ) ? dst->getData( 0, y + 1 ) : 0;
+		for( int32_t x = width - 1; x >= 0; --x ) {
+			float d = row[x * inc];
+			if( x + 1 < width )
+				d = std::min( d, row[( x + 1 ) * inc] + 3 );
+			if( below ) {
+				d = std::min( d, below[x * inc] + 3 );
+				if( x > 0 )
+					d = std::min( d, below[( x - 1 ) * inc] + 4 );
+				if( x + 1 < width )
+					d = std::min( d, below[( x + 1 ) * inc] + 4 );
+			}
+			row[x * inc] = d;
+		}
+	}
+
+	for( int32_t y = 0; y < height; ++y ) {
+		float *row = dst->getData( 0, y );
+		for( int32_t x = 0; x < width; ++x )
+			row[x * inc] = ( row[x * inc] >= far ) ? std::numeric_limits<float>::infinity() : row[x * inc] / 3;
+	}
+}
+
+} // anonymous namespace
+
+void distanceTransform( const Channel8u &srcChannel, Channel32f *dstChannel, const DistanceTransformOptions &options )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( ( width <= 0 ) || ( height <= 0 ) )
+		return;
+	const uint8_t threshold = options.getThreshold();
+	const bool isSigned = options.isSignedDistance();
+	Channel32f inside;
+	if( isSigned )
+		inside = Channel32f( width, height );
+
+	if( options.getMetric() == DistanceTransformOptions::EUCLIDEAN ) {
+		// no distance within the Channel reaches width + height
+		const float far = (float)( width + height );
+		// bands narrower than a few cache lines would share lines between threads
+		parallelRows( 0, width, ColumnPass( &srcChannel, dstChannel, height, threshold, false, far ), 64 );
+		if( isSigned )
+			parallelRows( 0, width, ColumnPass( &srcChannel, &inside, height, threshold, true, far ), 64 );
+		parallelRows( 0, height, EuclideanRowPass( dstChannel, ( isSigned ) ? &inside : 0, width, far ) );
+	}
+	else {
+		chamfer( srcChannel, dstChannel, width, height, threshold, false );
+		if( isSigned ) {
+			chamfer( srcChannel, &inside, width, height, threshold, true );
+			const int8_t inc = dstChannel->getIncrement();
+			for( int32_t y = 0; y < height; ++y ) {
+				float *dst = dstChannel->getData( 0, y );
+				const float *in = inside.getData( 0, y );
+				for( int32_t x = 0; x < width; ++x )
+					dst[x * inc] -= in[x];
+			}
+		}
+	}
+}
+
+} } // namespace cinder::ip
@@ -23,6 +23,9 @@
 #include "cinder/ip/EdgeDetect.h"
 #include "cinder/Surface.h"
 #include "cinder/CinderMath.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
 
 namespace cinder { namespace ip {
 
@@ -51,7 +54,7 @@ void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const
 //			sumX = -srcLine[-srcRowPixels-srcPixelStride] + srcLine[-srcRowPixels+srcPixelStride] - 2 * srcLine[-srcPixelStride] + 2 * srcLine[srcPixelStride] - srcLine[srcRowPixels-srcPixelStride] + srcLine[srcRowPixels+srcPixelStride];
 			sumX = -*(T*)(srcLine-srcRowBytes-srcPixelBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - 2 * *(T*)(srcLine-srcPixelBytes) + 2 * *(T*)(srcLine+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) + *(T*)(srcLine+srcRowBytes+srcPixelBytes);
 //			sumY = srcLine[-srcRowPixels-srcPixelStride] + 2 * srcLine[-srcRowPixels] + srcLine[-srcRowPixels + srcPixelStride]				- srcLine[srcRowPixels-srcPixelStride] - 2 * srcLine[srcRowPixels] - srcLine[srcRowPixels+srcPixelStride];
-			sumY = *(T*)(srcLine-srcRowBytes-srcPixelBytes) + 2 * *(T*)(srcLine-srcRowBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) - 2 * *(T*)(srcLine+srcPixelBytes) - *(T*)(srcLine+srcRowBytes+srcPixelBytes);
+			sumY = *(T*)(srcLine-srcRowBytes-srcPixelBytes) + 2 * *(T*)(srcLine-srcRowBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) - 2 * *(T*)(srcLine+srcRowBytes) - *(T*)(srcLine+srcRowBytes+srcPixelBytes);
 			sumX = static_cast<typename CHANTRAIT<T>::Sum>( math<float>::sqrt( float( sumX * sumX + sumY * sumY ) ) );
 			if( sumX > maxValue ) sumX = maxValue;
 			*dstLine = static_cast<uint8_t>( sumX );
@@ -83,6 +86,278 @@ void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSuface )
 	edgeDetectSobel( srcSurface, srcSurface.getBounds(), Vec2i::zero(), dstSuface );
 }
 
+namespace {
+
+// The Sobel gradient of pixel \a x from the rows above and below it, with its neighbors \a left and \a right pixels away
+inline void sobelPixel( const uint8_t *above, const uint8_t *row, const uint8_t *below, int32_t x, int32_t left, int32_t right, int8_t inc, float *gx, float *gy )
+{
+	const int32_t l = ( x - left ) * inc, c = x * inc, r = ( x + right ) * inc;
+	*gx = (float)( ( above[r] - above[l] ) + 2 * ( row[r] - row[l] ) + ( below[r] - below[l] ) );
+	*gy = (float)( ( below[l] + 2 * below[c] + below[r] ) - ( above[l] + 2 * above[c] + above[r] ) );
+}
+
+// atan2() to about 0.0002, from a polynomial approximation of atan() on [0,1]
+inline float fastAtan2( float y, float x )
+{
+	const float ax = math<float>::abs( x ), ay = math<float>::abs( y );
+	const float a = std::min( ax, ay ) / std::max( std::max( ax, ay ), 1e-30f ), s = a * a;
+	float r = ( ( -0.0464964749f * s + 0.15931422f ) * s - 0.327622764f ) * s * a + a;
+	if( ay > ax )
+		r = 1.57079637f - r;
+	if( x < 0 )
+		r = 3.14159274f - r;
+	return ( y < 0 ) ? -r : r;
+}
+
+// Quantizes the gradient direction for non-maximum suppression: 0 is horizontal, 1 down-right, 2 vertical and 3 up-right
+inline uint8_t directionSector( float gx, float gy )
+{
+	const float ax = math<float>::abs( gx ), ay = math<float>::abs( gy );
+	if( ay >= 2.41421356f * ax ) // tan( 67.5 )
+		return 2;
+	else if( ay <= 0.41421356f * ax ) // tan( 22.5 )
+		return 0;
+	return ( ( gx < 0 ) == ( gy < 0 ) ) ? 1 : 3;
+}
+
+#if defined( CINDER_SSE2 )
+inline __m128i loadWiden( const uint8_t *p )
+{
+	return _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( p ) ), _mm_setzero_si128() );
+}
+
+inline __m128 select_ps( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+// The Sobel gradients of pixels x through x + 7, none of which is in the first or last column, as two vectors of four
+inline void sobel8( const uint8_t *above, const uint8_t *row, const uint8_t *below, int32_t x, __m128 *gx, __m128 *gy )
+{
+	const __m128i aL = loadWiden( above + x - 1 ), aC = loadWiden( above + x ), aR = loadWiden( above + x + 1 );
+	const __m128i rL = loadWiden( row + x - 1 ), rR = loadWiden( row + x + 1 );
+	const __m128i bL = loadWiden( below + x - 1 ), bC = loadWiden( below + x ), bR = loadWiden( below + x + 1 );
+	const __m128i x16 = _mm_add_epi16( _mm_add_epi16( _mm_sub_epi16( aR, aL ), _mm_sub_epi16( bR, bL ) ), _mm_slli_epi16( _mm_sub_epi16( rR, rL ), 1 ) );
+	const __m128i y16 = _mm_sub_epi16( _mm_add_epi16( _mm_add_epi16( bL, bR ), _mm_slli_epi16( bC, 1 ) ), _mm_add_epi16( _mm_add_epi16( aL, aR ), _mm_slli_epi16( aC, 1 ) ) );
+	// sign-extend to 32 bits
+	gx[0] = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( x16, x16 ), 16 ) );
+	gx[1] = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( x16, x16 ), 16 ) );
+	gy[0] = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( y16, y16 ), 16 ) );
+	gy[1] = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpackhi_epi16( y16, y16 ), 16 ) );
+}
+
+inline __m128 fastAtan2_ps( __m128 y, __m128 x )
+{
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	const __m128 ax = _mm_andnot_ps( signMask, x ), ay = _mm_andnot_ps( signMask, y );
+	const __m128 a = _mm_div_ps( _mm_min_ps( ax, ay ), _mm_max_ps( _mm_max_ps( ax, ay ), _mm_set1_ps( 1e-30f ) ) ), s = _mm_mul_ps( a, a );
+	__m128 r = _mm_add_ps( _mm_mul_ps( _mm_sub_ps( _mm_mul_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( -0.0464964749f ), s ), _mm_set1_ps( 0.15931422f ) ), s ), _mm_set1_ps( 0.327622764f ) ), _mm_mul_ps( s, a ) ), a );
+	r = select_ps( _mm_cmpgt_ps( ay, ax ), _mm_sub_ps( _mm_set1_ps( 1.57079637f ), r ), r );
+	r = select_ps( _mm_cmplt_ps( x, _mm_setzero_ps() ), _mm_sub_ps( _mm_set1_ps( 3.14159274f ), r ), r );
+	return _mm_xor_ps( r, _mm_and_ps( y, signMask ) );
+}
+
+inline __m128i directionSector_epi32( __m128 gx, __m128 gy )
+{
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	const __m128 ax = _mm_andnot_ps( signMask, gx ), ay = _mm_andnot_ps( signMask, gy );
+	const __m128i vertical = _mm_castps_si128( _mm_cmpge_ps( ay, _mm_mul_ps( ax, _mm_set1_ps( 2.41421356f ) ) ) );
+	const __m128i horizontal = _mm_castps_si128( _mm_cmple_ps( ay, _mm_mul_ps( ax, _mm_set1_ps( 0.41421356f ) ) ) );
+	// 1 when the signs match, otherwise 3
+	const __m128i diagonal = _mm_add_epi32( _mm_set1_epi32( 1 ), _mm_slli_epi32( _mm_srli_epi32( _mm_castps_si128( _mm_xor_ps( gx, gy ) ), 31 ), 1 ) );
+	const __m128i sector = _mm_andnot_si128( horizontal, diagonal );
+	return _mm_or_si128( _mm_and_si128( vertical, _mm_set1_epi32( 2 ) ), _mm_andnot_si128( vertical, sector ) );
+}
+#endif
+
+// The gradient magnitude and, optionally, direction or direction sector of a band of rows. The rows beyond the edges replicate the edge rows,
+// so only the first and last columns need their neighbors clamped.
+class SobelBand {
+  public:
+	SobelBand( const Channel8u *src, Channel32f *magnitude, Channel32f *direction, Channel8u *sectors, int32_t width, int32_t height )
+		: mSrc( src ), mMagnitude( magnitude ), mDirection( direction ), mSectors( sectors ), mWidth( width ), mHeight( height ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int8_t srcInc = mSrc->getIncrement(), magInc = mMagnitude->getIncrement();
+		const int8_t dirInc = ( mDirection ) ? mDirection->getIncrement() : 1, sectorInc = ( mSectors ) ? mSectors->getIncrement() : 1;
+		const bool simd = mSimd && ( srcInc == 1 ) && ( magInc == 1 ) && ( dirInc == 1 ) && ( sectorInc == 1 );
+		for( int32_t y = y1; y < y2; ++y ) {
+			const uint8_t *above = mSrc->getData( 0, std::max( y - 1, 0 ) ), *row = mSrc->getData( 0, y ), *below = mSrc->getData( 0, std::min( y + 1, mHeight - 1 ) );
+			float *magnitude = mMagnitude->getData( 0, y );
+			float *direction = ( mDirection ) ? mDirection->getData( 0, y ) : 0;
+			uint8_t *sectors = ( mSectors ) ? mSectors->getData( 0, y ) : 0;
+
+			int32_t x = 0;
+			if( mWidth > 0 )
+				pixel( above, row, below, x++, srcInc, magnitude, magInc, direction, dirInc, sectors, sectorInc );
+#if defined( CINDER_SSE2 )
+			if( simd ) {
+				for( ; x + 8 < mWidth; x += 8 ) {
+					__m128 gx[2], gy[2];
+					sobel8( above, row, below, x, gx, gy );
+					for( int i = 0; i < 2; ++i )
+						_mm_storeu_ps( magnitude + x + 4 * i, _mm_sqrt_ps( _mm_add_ps( _mm_mul_ps( gx[i], gx[i] ), _mm_mul_ps( gy[i], gy[i] ) ) ) );
+					if( direction ) {
+						_mm_storeu_ps( direction + x, fastAtan2_ps( gy[0], gx[0] ) );
+						_mm_storeu_ps( direction + x + 4, fastAtan2_ps( gy[1], gx[1] ) );
+					}
+					if( sectors ) {
+						const __m128i packed = _mm_packs_epi32( directionSector_epi32( gx[0], gy[0] ), directionSector_epi32( gx[1], gy[1] ) );
+						_mm_storel_epi64( reinterpret_cast<__m128i*>( sectors + x ), _mm_packus_epi16( packed, packed ) );
+					}
+				}
+			}
+#endif
+			for( ; x < mWidth; ++x )
+				pixel( above, row, below, x, srcInc, magnitude, magInc, direction, dirInc, sectors, sectorInc );
+		}
+	}
+
+  private:
+	void pixel( const uint8_t *above, const uint8_t *row, const uint8_t *below, int32_t x, int8_t srcInc, float *magnitude, int8_t magInc,
+				float *direction, int8_t dirInc, uint8_t *sectors, int8_t sectorInc ) const
+	{
+		float gx, gy;
+		sobelPixel( above, row, below, x, ( x > 0 ) ? 1 : 0, ( x + 1 < mWidth ) ? 1 : 0, srcInc, &gx, &gy );
+		magnitude[x * magInc] = math<float>::sqrt( gx * gx + gy * gy );
+		if( direction )
+			direction[x * dirInc] = fastAtan2( gy, gx );
+		if( sectors )
+			sectors[x * sectorInc] = directionSector( gx, gy );
+	}
+
+	const Channel8u		*mSrc;
+	Channel32f			*mMagnitude, *mDirection;
+	Channel8u			*mSectors;
+	int32_t				mWidth, mHeight;
+	bool				mSimd;
+};
+
+const uint8_t CANNY_WEAK = 1, CANNY_STRONG = 255;
+
+// Thins the gradient to its maxima along the gradient direction and classifies them against the thresholds. The outermost pixels are never edges.
+class SuppressBand {
+  public:
+	SuppressBand( const Channel32f *magnitude, const Channel8u *sectors, Channel8u *dst, int32_t width, int32_t height, float lowThreshold, float highThreshold )
+		: mMagnitude( magnitude ), mSectors( sectors ), mDst( dst ), mWidth( width ), mHeight( height ), mLow( lowThreshold ), mHigh( highThreshold )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		// offsets of the neighbors along each sector's direction, in pixels of the contiguous magnitude Channel
+		const int32_t stride = mMagnitude->getRowBytes() / sizeof(float);
+		const int32_t offsets[4] = { 1, stride + 1, stride, -stride + 1 };
+		const int8_t inc = mDst->getIncrement();
+		for( int32_t y = y1; y < y2; ++y ) {
+			uint8_t *dst = mDst->getData( 0, y );
+			if( ( y == 0 ) || ( y == mHeight - 1 ) ) {
+				for( int32_t x = 0; x < mWidth; ++x )
+					dst[x * inc] = 0;
+				continue;
+			}
+			const float *magnitude = mMagnitude->getData( 0, y );
+			const uint8_t *sectors = mSectors->getData( 0, y );
+			dst[0] = 0;
+			for( int32_t x = 1; x < mWidth - 1; ++x ) {
+				const float m = magnitude[x];
+				uint8_t result = 0;
+				if( m >= mLow ) {
+					const int32_t offset = offsets[sectors[x]];
+					// ties are broken towards the neighbor in the direction of the gradient
+					if( ( m > magnitude[x - offset] ) && ( m >= magnitude[x + offset] ) )
+						result = ( m >= mHigh ) ? CANNY_STRONG : CANNY_WEAK;
+				}
+				dst[x * inc] = result;
+			}
+			if( mWidth > 1 )
+				dst[( mWidth - 1 ) * inc] = 0;
+		}
+	}
+
+  private:
+	const Channel32f	*mMagnitude;
+	const Channel8u		*mSectors;
+	Channel8u			*mDst;
+	int32_t				mWidth, mHeight;
+	float				mLow, mHigh;
+};
+
+// Discards the weak edges which hysteresis didn't connect to a strong one
+class ClearWeakBand {
+  public:
+	ClearWeakBand( Channel8u *dst, int32_t width )
+		: mDst( dst ), mWidth( width )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int8_t inc = mDst->getIncrement();
+		for( int32_t y = y1; y < y2; ++y ) {
+			uint8_t *dst = mDst->getData( 0, y );
+			for( int32_t x = 0; x < mWidth; ++x )
+				if( dst[x * inc] == CANNY_WEAK )
+					dst[x * inc] = 0;
+		}
+	}
+
+  private:
+	Channel8u	*mDst;
+	int32_t		mWidth;
+};
+
+} // anonymous namespace
+
+void edgeDetectSobel( const Channel8u &srcChannel, Channel32f *magnitude, Channel32f *direction )
+{
+	int32_t width = std::min( srcChannel.getWidth(), magnitude->getWidth() ), height = std::min( srcChannel.getHeight(), magnitude->getHeight() );
+	if( direction ) {
+		width = std::min( width, direction->getWidth() );
+		height = std::min( height, direction->getHeight() );
+	}
+	parallelRows( 0, height, SobelBand( &srcChannel, magnitude, direction, 0, width, height ) );
+}
+
+void Canny::detect( const Channel8u &srcChannel, Channel8u *dstChannel, float lowThreshold, float highThreshold )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( ( ! mMagnitude ) || ( mMagnitude.getWidth() != width ) || ( mMagnitude.getHeight() != height ) ) {
+		mMagnitude = Channel32f( width, height );
+		mSectors = Channel8u( width, height );
+	}
+
+	parallelRows( 0, height, SobelBand( &srcChannel, &mMagnitude, 0, &mSectors, width, height ) );
+	parallelRows( 0, height, SuppressBand( &mMagnitude, &mSectors, dstChannel, width, height, lowThreshold, highThreshold ) );
+
+	// hysteresis: flood from each strong edge through the weak ones it touches. The outermost pixels are never edges, so neighbors are always in bounds.
+	const int8_t inc = dstChannel->getIncrement();
+	const int32_t rowBytes = dstChannel->getRowBytes();
+	const int32_t neighbors[8] = { -rowBytes - inc, -rowBytes, -rowBytes + inc, -inc, inc, rowBytes - inc, rowBytes, rowBytes + inc };
+	uint8_t *base = dstChannel->getData();
+	mStack.clear();
+	for( int32_t y = 1; y < height - 1; ++y ) {
+		for( int32_t x = 1; x < width - 1; ++x ) {
+			const int32_t offset = y * rowBytes + x * inc;
+			if( base[offset] != CANNY_STRONG )
+				continue;
+			mStack.push_back( offset );
+			while( ! mStack.empty() ) {
+				const int32_t p = mStack.back();
+				mStack.pop_back();
+				for( int n = 0; n < 8; ++n ) {
+					if( base[p + neighbors[n]] == CANNY_WEAK ) {
+						base[p + neighbors[n]] = CANNY_STRONG;
+						mStack.push_back( p + neighbors[n] );
+					}
+				}
+			}
+		}
+	}
+
+	parallelRows( 0, height, ClearWeakBand( dstChannel, width ) );
+}
+
 
 #define edgeDetect_PROTOTYPES(r,data,T)\
 	template void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel ); \
@@ -21,9 +21,244 @@
 */
 
 #include "cinder/ip/Flip.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include "ImagePlane.h"
+
+#include <algorithm>
 
 namespace cinder { namespace ip {
 
+namespace {
+
+// A Surface as its red, green, blue and any alpha channel, or a Channel as its single one
+template<typename T>
+ImagePlane surfacePlane( const SurfaceT<T> &surface )
+{
+	ImagePlane result( surface.getData(), surface.getRowBytes(), surface.getPixelInc() );
+	result.addChannel( surface.getRedOffset() );
+	result.addChannel( surface.getGreenOffset() );
+	result.addChannel( surface.getBlueOffset() );
+	if( surface.hasAlpha() )
+		result.addChannel( surface.getAlphaOffset() );
+	return result;
+}
+
+template<typename T>
+ImagePlane channelPlane( const ChannelT<T> &channel )
+{
+	ImagePlane result( channel.getData(), channel.getRowBytes(), channel.getIncrement() );
+	result.addChannel( 0 );
+	return result;
+}
+
+// The values of T moved with each pixel: all of a Surface's, including any padding, but only its own of a Channel
+inline uint8_t pixelSize( const ImagePlane &plane )
+{
+	return ( plane.mNumChannels == 1 ) ? 1 : plane.mPixelInc;
+}
+
+// Whether pixels are 4 bytes and tightly packed, as the SIMD kernels require
+template<typename T>
+bool isPacked4( const ImagePlane &plane )
+{
+	return ( plane.mPixelInc == pixelSize( plane ) ) && ( plane.mPixelInc * sizeof(T) == 4 );
+}
+
+// Whether pixels of \a a and \a b hold the same channels in the same places, so that they can be copied whole
+inline bool sameLayout( const ImagePlane &a, const ImagePlane &b )
+{
+	return ( a.mPixelInc == b.mPixelInc ) && ( a.mNumChannels == b.mNumChannels ) && std::equal( a.mOffsets, a.mOffsets + a.mNumChannels, b.mOffsets );
+}
+
+#if defined( CINDER_SSE2 )
+// Swaps the 4-byte pixels x of \a a with pixels width - 1 - x of \a b, four at a time while x < count. Returns the number swapped.
+int32_t swapReversed4( uint8_t *a, uint8_t *b, int32_t width, int32_t count )
+{
+	int32_t x = 0;
+	for( ; x + 4 <= count; x += 4 ) {
+		__m128i *left = reinterpret_cast<__m128i*>( a + x * 4 ), *right = reinterpret_cast<__m128i*>( b + ( width - 4 - x ) * 4 );
+		const __m128i l = _mm_loadu_si128( left ), r = _mm_loadu_si128( right );
+		_mm_storeu_si128( left, _mm_shuffle_epi32( r, _MM_SHUFFLE( 0, 1, 2, 3 ) ) );
+		_mm_storeu_si128( right, _mm_shuffle_epi32( l, _MM_SHUFFLE( 0, 1, 2, 3 ) ) );
+	}
+	return x;
+}
+
+// Writes a 4x4 block of 4-byte pixels to the rows at \a dst, \a dstRowBytes apart, from the source columns at \a src, \a srcColumnStep
+// apart. Each source column holds its 4 pixels consecutively, running backwards from \a src when REVERSE.
+template<bool REVERSE>
+inline void transpose4x4( const uint8_t *src, ptrdiff_t srcColumnStep, uint8_t *dst, ptrdiff_t dstRowBytes )
+{
+	// no arithmetic is done on these, so any bit pattern passes through the float registers untouched
+	__m128 c[4];
+	for( int i = 0; i < 4; ++i ) {
+		c[i] = _mm_loadu_ps( reinterpret_cast<const float*>( src + i * srcColumnStep - ( REVERSE ? 12 : 0 ) ) );
+		if( REVERSE )
+			c[i] = _mm_shuffle_ps( c[i], c[i], _MM_SHUFFLE( 0, 1, 2, 3 ) );
+	}
+	_MM_TRANSPOSE4_PS( c[0], c[1], c[2], c[3] );
+	for( int j = 0; j < 4; ++j )
+		_mm_storeu_ps( reinterpret_cast<float*>( dst + j * dstRowBytes ), c[j] );
+}
+#else
+inline int32_t swapReversed4( uint8_t*, uint8_t*, int32_t, int32_t ) { return 0; }
+#endif
+
+// Swaps pixel x of row \a a with pixel width - 1 - x of row \a b for every x, or for the left half when they are the same row,
+// which reverses it in place
+template<typename T>
+void swapReversed( const ImagePlane &plane, int32_t width, T *a, T *b, bool simd )
+{
+	const int32_t count = ( a == b ) ? width / 2 : width;
+	const uint8_t inc = plane.mPixelInc, size = pixelSize( plane );
+	int32_t x = ( simd ) ? swapReversed4( reinterpret_cast<uint8_t*>( a ), reinterpret_cast<uint8_t*>( b ), width, count ) : 0;
+	for( ; x < count; ++x )
+		std::swap_ranges( a + x * inc, a + x * inc + size, b + ( width - 1 - x ) * inc );
+}
+
+// Reverses rows [y1, y2) of \a plane, which is \a size pixels, or for a rotation by 180 degrees, swaps each of those rows reversed with its mirror from the bottom
+template<typename T>
+class ReverseBand {
+  public:
+	ReverseBand( const ImagePlane &plane, const Vec2i &size, bool rotate )
+		: mPlane( plane ), mSize( size ), mRotate( rotate ), mSimd( isPacked4<T>( plane ) && System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		for( int32_t y = y1; y < y2; ++y )
+			swapReversed( mPlane, mSize.x, mPlane.getRow<T>( y ), mPlane.getRow<T>( ( mRotate ) ? mSize.y - 1 - y : y ), mSimd );
+	}
+
+  private:
+	ImagePlane	mPlane;
+	Vec2i		mSize;
+	bool		mRotate, mSimd;
+};
+
+// Copies \a src into \a dst through a rotation or transposition: destination pixel (x, y) is the source pixel at
+// mOrigin + x * mColumnStep + y * mRowStep bytes. Each band of destination rows is split recursively into tiles small
+// enough that the source and destination of a tile share the cache, whatever its size.
+template<typename T>
+class TransformBand {
+  public:
+	TransformBand( const ImagePlane &src, const ImagePlane &dst, int32_t width, const uint8_t *origin, ptrdiff_t columnStep, ptrdiff_t rowStep )
+		: mSrc( src ), mDst( dst ), mWidth( width ), mOrigin( origin ), mColumnStep( columnStep ), mRowStep( rowStep ), mNumChannels( 0 )
+	{
+		// pixels of differing layouts, such as Surfaces of differing channel orders, are copied a channel at a time
+		if( ! sameLayout( src, dst ) )
+			mNumChannels = std::min( src.mNumChannels, dst.mNumChannels );
+		mSimd = ( mNumChannels == 0 ) && isPacked4<T>( src ) && isPacked4<T>( dst ) && ( mRowStep == 4 || mRowStep == -4 ) && System::hasSse2();
+	}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		copyBlock( 0, y1, mWidth, y2 );
+	}
+
+  private:
+	static const int32_t LEAF_SIZE = 32;
+
+	void copyBlock( int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) const
+	{
+		// halve the longer side, keeping the split on a multiple of 4 for the SIMD kernel
+		if( ( x2 - x1 > LEAF_SIZE ) && ( x2 - x1 >= y2 - y1 ) ) {
+			const int32_t mid = x1 + ( ( ( x2 - x1 ) / 2 ) & ~3 );
+			copyBlock( x1, y1, mid, y2 );
+			copyBlock( mid, y1, x2, y2 );
+		}
+		else if( y2 - y1 > LEAF_SIZE ) {
+			const int32_t mid = y1 + ( ( ( y2 - y1 ) / 2 ) & ~3 );
+			copyBlock( x1, y1, x2, mid );
+			copyBlock( x1, mid, x2, y2 );
+		}
+		else
+			copyLeaf( x1, y1, x2, y2 );
+	}
+
+	void copyLeaf( int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) const
+	{
+#if defined( CINDER_SSE2 )
+		if( mSimd ) {
+			const int32_t simdX2 = x1 + ( ( x2 - x1 ) & ~3 ), simdY2 = y1 + ( ( y2 - y1 ) & ~3 );
+			for( int32_t y = y1; y < simdY2; y += 4 ) {
+				uint8_t *dst = mDst.getRow<uint8_t>( y );
+				for( int32_t x = x1; x < simdX2; x += 4 ) {
+					const uint8_t *src = mOrigin + x * mColumnStep + y * mRowStep;
+					if( mRowStep < 0 )
+						transpose4x4<true>( src, mColumnStep, dst + x * 4, mDst.mRowBytes );
+					else
+						transpose4x4<false>( src, mColumnStep, dst + x * 4, mDst.mRowBytes );
+				}
+			}
+			copyPixels( simdX2, y1, x2, simdY2 );
+			y1 = simdY2;
+		}
+#endif
+		copyPixels( x1, y1, x2, y2 );
+	}
+
+	void copyPixels( int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) const
+	{
+		for( int32_t y = y1; y < y2; ++y ) {
+			T *dst = mDst.getRow<T>( y ) + x1 * mDst.mPixelInc;
+			for( int32_t x = x1; x < x2; ++x, dst += mDst.mPixelInc ) {
+				const T *src = reinterpret_cast<const T*>( mOrigin + x * mColumnStep + y * mRowStep );
+				if( mNumChannels ) {
+					for( uint8_t c = 0; c < mNumChannels; ++c )
+						dst[mDst.mOffsets[c]] = src[mSrc.mOffsets[c]];
+				}
+				else
+					std::copy( src, src + pixelSize( mSrc ), dst );
+			}
+		}
+	}
+
+	ImagePlane		mSrc, mDst;
+	int32_t			mWidth;
+	const uint8_t	*mOrigin;
+	ptrdiff_t		mColumnStep, mRowStep;
+	uint8_t			mNumChannels;
+	bool			mSimd;
+};
+
+enum Transform { TRANSPOSE, ROTATE_90, ROTATE_270 };
+
+template<typename T>
+void transform( const ImagePlane &src, const Vec2i &srcSize, const ImagePlane &dst, const Vec2i &dstSize, Transform transform )
+{
+	// each of these swaps width and height
+	const int32_t width = std::min( dstSize.x, srcSize.y ), height = std::min( dstSize.y, srcSize.x );
+	const ptrdiff_t pixelBytes = src.mPixelInc * sizeof(T);
+	const uint8_t *data = reinterpret_cast<const uint8_t*>( src.mData );
+	const uint8_t *origin;
+	ptrdiff_t columnStep, rowStep;
+	switch( transform ) {
+		case TRANSPOSE: // (x, y) from (y, x)
+			origin = data;
+			columnStep = src.mRowBytes;
+			rowStep = pixelBytes;
+		break;
+		case ROTATE_90: // (x, y) from (y, height - 1 - x)
+			origin = data + ( srcSize.y - 1 ) * src.mRowBytes;
+			columnStep = -src.mRowBytes;
+			rowStep = pixelBytes;
+		break;
+		default: // (x, y) from (width - 1 - y, x)
+			origin = data + ( srcSize.x - 1 ) * pixelBytes;
+			columnStep = src.mRowBytes;
+			rowStep = -pixelBytes;
+		break;
+	}
+	
+	parallelRows( 0, height, TransformBand<T>( src, dst, width, origin, columnStep, rowStep ), 32 );
+}
+
+} // anonymous namespace
+
 template<typename T>
 void flipVertical( SurfaceT<T> *surface )
 {
@@ -41,9 +276,94 @@ void flipVertical( SurfaceT<T> *surface )
 	delete [] buffer;
 }
 
+template<typename T>
+void flipVertical( ChannelT<T> *channel )
+{
+	const int32_t width = channel->getWidth();
+	const uint8_t inc = channel->getIncrement();
+	int32_t lastRow = channel->getHeight() - 1;
+	int32_t halfHeight = channel->getHeight() / 2;
+	for( int32_t y = 0; y < halfHeight; ++y ) {
+		T *top = channel->getData( 0, y ), *bottom = channel->getData( 0, lastRow - y );
+		for( int32_t x = 0; x < width; ++x, top += inc, bottom += inc )
+			std::swap( *top, *bottom );
+	}
+}
+
+template<typename T>
+void flipHorizontal( SurfaceT<T> *surface )
+{
+	parallelRows( 0, surface->getHeight(), ReverseBand<T>( surfacePlane( *surface ), surface->getSize(), false ) );
+}
+
+template<typename T>
+void flipHorizontal( ChannelT<T> *channel )
+{
+	parallelRows( 0, channel->getHeight(), ReverseBand<T>( channelPlane( *channel ), channel->getSize(), false ) );
+}
+
+template<typename T>
+void rotate180( SurfaceT<T> *surface )
+{
+	// the middle row of an odd height is swapped with itself, which reverses it
+	parallelRows( 0, ( surface->getHeight() + 1 ) / 2, ReverseBand<T>( surfacePlane( *surface ), surface->getSize(), true ) );
+}
+
+template<typename T>
+void rotate180( ChannelT<T> *channel )
+{
+	parallelRows( 0, ( channel->getHeight() + 1 ) / 2, ReverseBand<T>( channelPlane( *channel ), channel->getSize(), true ) );
+}
+
+template<typename T>
+void rotate90( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	transform<T>( surfacePlane( srcSurface ), srcSurface.getSize(), surfacePlane( *dstSurface ), dstSurface->getSize(), ROTATE_90 );
+}
+
+template<typename T>
+void rotate90( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel )
+{
+	transform<T>( channelPlane( srcChannel ), srcChannel.getSize(), channelPlane( *dstChannel ), dstChannel->getSize(), ROTATE_90 );
+}
+
+template<typename T>
+void rotate270( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	transform<T>( surfacePlane( srcSurface ), srcSurface.getSize(), surfacePlane( *dstSurface ), dstSurface->getSize(), ROTATE_270 );
+}
+
+template<typename T>
+void rotate270( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel )
+{
+	transform<T>( channelPlane( srcChannel ), srcChannel.getSize(), channelPlane( *dstChannel ), dstChannel->getSize(), ROTATE_270 );
+}
+
+template<typename T>
+void transpose( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	transform<T>( surfacePlane( srcSurface ), srcSurface.getSize(), surfacePlane( *dstSurface ), dstSurface->getSize(), TRANSPOSE );
+}
+
+template<typename T>
+void transpose( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel )
+{
+	transform<T>( channelPlane( srcChannel ), srcChannel.getSize(), channelPlane( *dstChannel ), dstChannel->getSize(), TRANSPOSE );
+}
 
 #define flip_PROTOTYPES(r,data,T)\
-	template void flipVertical<T>( SurfaceT<T> *surface );
+	template void flipVertical<T>( SurfaceT<T> *surface ); \
+	template void flipVertical<T>( ChannelT<T> *channel ); \
+	template void flipHorizontal<T>( SurfaceT<T> *surface ); \
+	template void flipHorizontal<T>( ChannelT<T> *channel ); \
+	template void rotate180<T>( SurfaceT<T> *surface ); \
+	template void rotate180<T>( ChannelT<T> *channel ); \
+	template void rotate90<T>( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ); \
+	template void rotate90<T>( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel ); \
+	template void rotate270<T>( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ); \
+	template void rotate270<T>( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel ); \
+	template void transpose<T>( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ); \
+	template void transpose<T>( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );
 
 BOOST_PP_SEQ_FOR_EACH( flip_PROTOTYPES, ~, CHANNEL_TYPES )
 
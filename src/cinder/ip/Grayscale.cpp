@@ -21,10 +21,256 @@
 */
 
 #include "cinder/ip/Grayscale.h"
+#include "cinder/ip/Parallel.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/SimdDispatch.h"
+
+#include <algorithm>
 
 namespace cinder { namespace ip {
 
+namespace {
+
+// The fixed-point weights of the 8-bit conversions, which sum to 256
+const int16_t RED_WEIGHT = 74, GREEN_WEIGHT = 147, BLUE_WEIGHT = 35;
+
+// SIMD row kernels. Each converts as many leading pixels of a row as it can and returns that count; the caller finishes the row
+// with the scalar code. \a weights holds each channel's weight at its offset within a pixel, 0 elsewhere, repeated for two pixels.
+typedef int32_t (*GrayRowFunc)( const uint8_t *src, uint8_t *dst, int32_t width, const int16_t *weights );
+typedef int32_t (*GrayDownsampleRowFunc)( const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int32_t srcWidth, const int16_t *weights );
+
+#if defined( CINDER_SSE2 )
+
+// Loads four pixels of INC bytes each, widened to 4 bytes apiece
+template<int INC>
+__m128i loadPixels4( const uint8_t *src );
+
+template<>
+inline __m128i loadPixels4<4>( const uint8_t *src )
+{
+	return _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+}
+
+#if defined( CINDER_SSSE3 )
+template<>
+inline __m128i loadPixels4<3>( const uint8_t *src )
+{
+	const __m128i expand = _mm_setr_epi8( 0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128 );
+	return _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ), expand );
+}
+#endif
+
+// Returns the weighted sums of the four pixels in \a v as 32-bit integers
+inline __m128i graySums4( __m128i v, __m128i weights )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = _mm_madd_epi16( _mm_unpacklo_epi8( v, zero ), weights ), hi = _mm_madd_epi16( _mm_unpackhi_epi8( v, zero ), weights );
+	// madd leaves each pixel's sum in two halves; adding the odd lanes onto the even ones completes them
+	const __m128 l = _mm_castsi128_ps( _mm_add_epi32( lo, _mm_srli_epi64( lo, 32 ) ) ), h = _mm_castsi128_ps( _mm_add_epi32( hi, _mm_srli_epi64( hi, 32 ) ) );
+	return _mm_castps_si128( _mm_shuffle_ps( l, h, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+// Adds each pair of neighboring lanes in \a a and then \a b
+inline __m128i pairSums( __m128i a, __m128i b )
+{
+	const __m128 l = _mm_castsi128_ps( _mm_add_epi32( a, _mm_srli_epi64( a, 32 ) ) ), h = _mm_castsi128_ps( _mm_add_epi32( b, _mm_srli_epi64( b, 32 ) ) );
+	return _mm_castps_si128( _mm_shuffle_ps( l, h, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+// Whether the 16-byte load of the last of the four pixels ending at \a end lies within a row of \a width pixels
+template<int INC>
+inline bool loadFits( int32_t end, int32_t width )
+{
+	return ( end - 4 ) * INC + 16 <= width * INC;
+}
+
+template<int INC>
+int32_t grayRow_sse( const uint8_t *src, uint8_t *dst, int32_t width, const int16_t *weightValues )
+{
+	const __m128i weights = _mm_loadu_si128( reinterpret_cast<const __m128i*>( weightValues ) );
+	int32_t x = 0;
+	for( ; loadFits<INC>( x + 16, width ); x += 16 ) {
+		__m128i sums[4];
+		for( int k = 0; k < 4; ++k )
+			sums[k] = _mm_srli_epi32( graySums4( loadPixels4<INC>( src + ( x + k * 4 ) * INC ), weights ), 8 );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), _mm_packus_epi16( _mm_packs_epi32( sums[0], sums[1] ), _mm_packs_epi32( sums[2], sums[3] ) ) );
+	}
+	return x;
+}
+
+template<int INC>
+int32_t grayDownsampleRow_sse( const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int32_t srcWidth, const int16_t *weightValues )
+{
+	const __m128i weights = _mm_loadu_si128( reinterpret_cast<const __m128i*>( weightValues ) ), round = _mm_set1_epi32( 512 );
+	int32_t x = 0;
+	for( ; loadFits<INC>( 2 * x + 16, srcWidth ); x += 8 ) {
+		// the sums of the two rows for source pixels 2x through 2x + 15, then of their 2x2 blocks
+		__m128i sums[4];
+		for( int k = 0; k < 4; ++k ) {
+			const int32_t offset = ( 2 * x + k * 4 ) * INC;
+			sums[k] = _mm_add_epi32( graySums4( loadPixels4<INC>( row0 + offset ), weights ), graySums4( loadPixels4<INC>( row1 + offset ), weights ) );
+		}
+		const __m128i lo = _mm_srli_epi32( _mm_add_epi32( pairSums( sums[0], sums[1] ), round ), 10 );
+		const __m128i hi = _mm_srli_epi32( _mm_add_epi32( pairSums( sums[2], sums[3] ), round ), 10 );
+		const __m128i packed = _mm_packs_epi32( lo, hi );
+		_mm_storel_epi64( reinterpret_cast<__m128i*>( dst + x ), _mm_packus_epi16( packed, packed ) );
+	}
+	return x;
+}
+
+#endif // defined( CINDER_SSE2 )
+
+// The row kernels for 3- and 4-channel pixels, resolved per machine through DispatchTable; NULL where there is none
+struct GrayKernels {
+	GrayRowFunc				mRow3, mRow4;
+	GrayDownsampleRowFunc	mDownsampleRow3, mDownsampleRow4;
+
+	static void resolve( System::SimdLevel level, GrayKernels *table )
+	{
+		table->mRow3 = table->mRow4 = NULL;
+		table->mDownsampleRow3 = table->mDownsampleRow4 = NULL;
+#if defined( CINDER_SSE2 )
+		if( level >= System::SIMD_SSE2 ) {
+			table->mRow4 = &grayRow_sse<4>;
+			table->mDownsampleRow4 = &grayDownsampleRow_sse<4>;
+		}
+#endif
+#if defined( CINDER_SSSE3 )
+		if( level >= System::SIMD_SSSE3 ) {
+			table->mRow3 = &grayRow_sse<3>;
+			table->mDownsampleRow3 = &grayDownsampleRow_sse<3>;
+		}
+#endif
+	}
+};
+
+// Fills \a weights as GrayRowFunc expects for \a surface, returning the matching row kernel
+template<typename FUNC>
+FUNC selectGrayKernel( const Surface8u &surface, FUNC row3, FUNC row4, int16_t weights[8] )
+{
+	const uint8_t inc = surface.getPixelInc();
+	std::fill( weights, weights + 8, 0 );
+	for( int p = 0; p < 2; ++p ) {
+		weights[p * 4 + surface.getRedOffset()] = RED_WEIGHT;
+		weights[p * 4 + surface.getGreenOffset()] = GREEN_WEIGHT;
+		weights[p * 4 + surface.getBlueOffset()] = BLUE_WEIGHT;
+	}
+	return ( inc == 3 ) ? row3 : ( ( inc == 4 ) ? row4 : NULL );
+}
+
+// Converts rows [y1, y2) of \a src to grayscale in \a dst
+class GrayBand {
+  public:
+	GrayBand( const Surface8u *src, Channel8u *dst, int32_t x1, int32_t x2 )
+		: mSrc( src ), mDst( dst ), mX1( x1 ), mX2( x2 )
+	{
+		const GrayKernels &kernels = DispatchTable<GrayKernels>::get();
+		mRowFunc = selectGrayKernel( *src, kernels.mRow3, kernels.mRow4, mWeights );
+		if( dst->getIncrement() != 1 )
+			mRowFunc = NULL;
+	}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const uint8_t srcPixelInc = mSrc->getPixelInc(), dstPixelInc = mDst->getIncrement();
+		const uint8_t srcRedOffset = mSrc->getRedOffset(), srcGreenOffset = mSrc->getGreenOffset(), srcBlueOffset = mSrc->getBlueOffset();
+		for( int32_t y = y1; y < y2; ++y ) {
+			uint8_t *dstPtr = mDst->getData( Vec2i( mX1, y ) );
+			const uint8_t *srcPtr = mSrc->getData( Vec2i( mX1, y ) );
+			int32_t x = mX1;
+			if( mRowFunc ) {
+				const int32_t done = (*mRowFunc)( srcPtr, dstPtr, mX2 - mX1, mWeights );
+				x += done;
+				srcPtr += done * srcPixelInc;
+				dstPtr += done;
+			}
+			for( ; x < mX2; ++x ) {
+				uint32_t sum = srcPtr[srcRedOffset] * RED_WEIGHT + srcPtr[srcGreenOffset] * GREEN_WEIGHT + srcPtr[srcBlueOffset] * BLUE_WEIGHT;
+				*dstPtr = static_cast<uint8_t>( sum >> 8 );
+				dstPtr += dstPixelInc;
+				srcPtr += srcPixelInc;
+			}
+		}
+	}
+
+  private:
+	const Surface8u		*mSrc;
+	Channel8u			*mDst;
+	int32_t				mX1, mX2;
+	GrayRowFunc			mRowFunc;
+	int16_t				mWeights[8];
+};
+
+// Runs the downsampling kernel \a rowFunc, if any, over 8-bit rows; float rows have none
+inline int32_t runDownsampleRow( GrayDownsampleRowFunc rowFunc, const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int32_t srcWidth, const int16_t *weights )
+{
+	return ( rowFunc ) ? (*rowFunc)( row0, row1, dst, srcWidth, weights ) : 0;
+}
+
+inline int32_t runDownsampleRow( GrayDownsampleRowFunc, const float*, const float*, float*, int32_t, const int16_t* )
+{
+	return 0;
+}
+
+// Converts rows [y1, y2) of \a dst from the 2x2 blocks of \a src, repeating the last column and row of \a src when its size is odd
+template<typename T>
+class GrayDownsampleBand {
+  public:
+	GrayDownsampleBand( const SurfaceT<T> *src, ChannelT<T> *dst, int32_t width )
+		: mSrc( src ), mDst( dst ), mWidth( width ), mRowFunc( NULL )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t srcWidth = mSrc->getWidth(), srcHeight = mSrc->getHeight();
+		const uint8_t inc = mSrc->getPixelInc(), dstInc = mDst->getIncrement();
+		const uint8_t r = mSrc->getRedOffset(), g = mSrc->getGreenOffset(), b = mSrc->getBlueOffset();
+		for( int32_t y = y1; y < y2; ++y ) {
+			const T *row0 = mSrc->getData( Vec2i( 0, 2 * y ) ), *row1 = mSrc->getData( Vec2i( 0, std::min( 2 * y + 1, srcHeight - 1 ) ) );
+			T *dst = mDst->getData( Vec2i( 0, y ) );
+			// the SIMD kernels never reach past the last whole 2x2 block, leaving an odd width's final pixel to the scalar loop
+			int32_t x = runDownsampleRow( mRowFunc, row0, row1, dst, std::min( srcWidth, 2 * mWidth ), mWeights );
+			for( ; x < mWidth; ++x ) {
+				const int32_t x0 = 2 * x * inc, x1 = std::min( 2 * x + 1, srcWidth - 1 ) * inc;
+				dst[x * dstInc] = mean( row0[x0 + r] + row0[x1 + r] + row1[x0 + r] + row1[x1 + r],
+										row0[x0 + g] + row0[x1 + g] + row1[x0 + g] + row1[x1 + g],
+										row0[x0 + b] + row0[x1 + b] + row1[x0 + b] + row1[x1 + b] );
+			}
+		}
+	}
+
+  private:
+	typedef typename CHANTRAIT<T>::Sum	SUMT;
+
+	// the gray of the mean of four pixels, given the sums of their red, green and blue
+	static T	mean( SUMT r, SUMT g, SUMT b ) { return CHANTRAIT<T>::grayscale( r, g, b ) * 0.25f; }
+
+	const SurfaceT<T>		*mSrc;
+	ChannelT<T>				*mDst;
+	int32_t					mWidth;
+	GrayDownsampleRowFunc	mRowFunc;
+	int16_t					mWeights[8];
+};
+
+template<>
+GrayDownsampleBand<uint8_t>::GrayDownsampleBand( const Surface8u *src, Channel8u *dst, int32_t width )
+	: mSrc( src ), mDst( dst ), mWidth( width )
+{
+	const GrayKernels &kernels = DispatchTable<GrayKernels>::get();
+	mRowFunc = selectGrayKernel( *src, kernels.mDownsampleRow3, kernels.mDownsampleRow4, mWeights );
+	if( dst->getIncrement() != 1 )
+		mRowFunc = NULL;
+}
+
+template<>
+uint8_t GrayDownsampleBand<uint8_t>::mean( uint32_t r, uint32_t g, uint32_t b )
+{
+	return static_cast<uint8_t>( ( r * RED_WEIGHT + g * GREEN_WEIGHT + b * BLUE_WEIGHT + 512 ) >> 10 );
+}
+
+} // anonymous namespace
+
 template<typename T>
 void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
 {
@@ -71,25 +317,20 @@ template<>
 void grayscale( const Surface8u &srcSurface, Channel8u *dstChannel )
 {
 	Area area = srcSurface.getBounds().getClipBy( dstChannel->getBounds() );
+	parallelRows( area.getY1(), area.getY2(), GrayBand( &srcSurface, dstChannel, area.getX1(), area.getX2() ) );
+}
 
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
-	int8_t dstPixelInc = dstChannel->getIncrement();
-	const uint8_t redWeight = 74, greenWeight = 147, blueWeight = 35;
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
-		uint8_t *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) );
-		const uint8_t *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
-		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
-			uint32_t sum = srcPtr[srcRedOffset] * redWeight + srcPtr[srcGreenOffset] * greenWeight + srcPtr[srcBlueOffset] * blueWeight;
-			*dstPtr = static_cast<uint8_t>( sum >> 8 );
-			dstPtr += dstPixelInc;
-			srcPtr += srcPixelInc;
-		}
-	}
+template<typename T>
+void grayscaleDownsample( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel )
+{
+	const int32_t width = std::min( ( srcSurface.getWidth() + 1 ) / 2, dstChannel->getWidth() );
+	const int32_t height = std::min( ( srcSurface.getHeight() + 1 ) / 2, dstChannel->getHeight() );
+	parallelRows( 0, height, GrayDownsampleBand<T>( &srcSurface, dstChannel, width ) );
 }
 
 #define grayscale_PROTOTYPES(r,data,T)\
-	template void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+	template void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );\
+	template void grayscaleDownsample( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel );
 	
 template void grayscale( const SurfaceT<float> &srcSurface, ChannelT<float> *dstChannel );
 
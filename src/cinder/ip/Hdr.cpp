@@ -20,87 +20,647 @@
  POSSIBILITY OF SUCH DAMAGE.
 */
 
+
 #include "cinder/ip/Hdr.h"
 #include "cinder/ip/Grayscale.h"
 #include "cinder/ChanTraits.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/ip/Blur.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+#include "cinder/Thread.h"
 
+#include <cmath>
+#include <limits>
 
 namespace cinder { namespace ip {
 
-void hdrNormalize( Surface32f *surface )
+namespace {
+
+// Rec. 709 luminance weights
+const float kLumRed = 0.2126f, kLumGreen = 0.7152f, kLumBlue = 0.0722f;
+// keeps the log of black pixels finite
+const float kLogDelta = 0.0001f;
+const float kInvLn2 = 1.44269504f;
+
+// Partial statistics of a band of rows, merged into the total once the band completes
+struct StatsSum {
+	StatsSum()
+		: mMin( std::numeric_limits<float>::max() ), mMax( -std::numeric_limits<float>::max() ), mMaxLuminance( -std::numeric_limits<float>::max() ),
+		mSum( 0 ), mLogSum( 0 ), mCount( 0 )
+	{}
+
+	void merge( const StatsSum &rhs )
+	{
+		mMin = std::min( mMin, rhs.mMin );
+		mMax = std::max( mMax, rhs.mMax );
+		mMaxLuminance = std::max( mMaxLuminance, rhs.mMaxLuminance );
+		mSum += rhs.mSum;
+		mLogSum += rhs.mLogSum;
+		mCount += rhs.mCount;
+	}
+
+	float		mMin, mMax, mMaxLuminance;
+	double		mSum, mLogSum; // mLogSum is in base 2
+	uint64_t	mCount;
+};
+
+#if defined( CINDER_SSE2 )
+
+inline float hmin_ps( __m128 v ) { float f[4]; _mm_storeu_ps( f, v ); return std::min( std::min( f[0], f[1] ), std::min( f[2], f[3] ) ); }
+inline float hmax_ps( __m128 v ) { float f[4]; _mm_storeu_ps( f, v ); return std::max( std::max( f[0], f[1] ), std::max( f[2], f[3] ) ); }
+inline double hsum_ps( __m128 v ) { float f[4]; _mm_storeu_ps( f, v ); return (double)f[0] + f[1] + f[2] + f[3]; }
+
+// log2 of positive, normal \a x, to within a few ulps
+inline __m128 log2_ps( __m128 x )
 {
-	// first take histogram to find the minimum and maximum values present
-	float minVal = *(surface->getDataRed( Vec2i::zero() )), maxVal = *(surface->getDataRed( Vec2i::zero() ));
-
-	const int8_t pixelInc = surface->getPixelInc();
-	const uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
-	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
-		const float *srcPtr = surface->getData( Vec2i( 0, y ) );
-		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
-			minVal = std::min( minVal, srcPtr[redOffset] );
-			maxVal = std::max( maxVal, srcPtr[redOffset] );
-			minVal = std::min( minVal, srcPtr[greenOffset] );
-			maxVal = std::max( maxVal, srcPtr[greenOffset] );
-			minVal = std::min( minVal, srcPtr[blueOffset] );
-			maxVal = std::max( maxVal, srcPtr[blueOffset] );
-
-			srcPtr += pixelInc;
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128i bits = _mm_castps_si128( x );
+	__m128 e = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) ) );
+	__m128 m = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007FFFFF ) ), _mm_castps_si128( one ) ) );
+	// center the mantissa on 1 so the series below converges quickly
+	const __m128 big = _mm_cmpgt_ps( m, _mm_set1_ps( 1.41421356f ) );
+	m = _mm_sub_ps( m, _mm_and_ps( big, _mm_mul_ps( m, _mm_set1_ps( 0.5f ) ) ) );
+	e = _mm_add_ps( e, _mm_and_ps( big, one ) );
+	// log2( m ) = 2 / ln( 2 ) * atanh( t ), where t = ( m - 1 ) / ( m + 1 )
+	const __m128 t = _mm_div_ps( _mm_sub_ps( m, one ), _mm_add_ps( m, one ) );
+	const __m128 t2 = _mm_mul_ps( t, t );
+	__m128 p = _mm_set1_ps( 2 * kInvLn2 / 7 );
+	p = _mm_add_ps( _mm_mul_ps( p, t2 ), _mm_set1_ps( 2 * kInvLn2 / 5 ) );
+	p = _mm_add_ps( _mm_mul_ps( p, t2 ), _mm_set1_ps( 2 * kInvLn2 / 3 ) );
+	p = _mm_add_ps( _mm_mul_ps( p, t2 ), _mm_set1_ps( 2 * kInvLn2 ) );
+	return _mm_add_ps( e, _mm_mul_ps( p, t ) );
+}
+
+// 2 ^ \a x, relative error below 2e-6
+inline __m128 exp2_ps( __m128 x )
+{
+	const __m128 one = _mm_set1_ps( 1.0f );
+	x = _mm_min_ps( _mm_max_ps( x, _mm_set1_ps( -126.0f ) ), _mm_set1_ps( 127.0f ) );
+	// split into integer and fractional parts, flooring rather than truncating negative values
+	__m128i n = _mm_cvttps_epi32( x );
+	__m128 f = _mm_sub_ps( x, _mm_cvtepi32_ps( n ) );
+	const __m128 negative = _mm_cmplt_ps( f, _mm_setzero_ps() );
+	n = _mm_add_epi32( n, _mm_castps_si128( negative ) );
+	f = _mm_add_ps( f, _mm_and_ps( negative, one ) );
+	// Taylor series of e ^ ( f * ln( 2 ) )
+	__m128 p = _mm_set1_ps( 1.5252734e-5f );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 1.5403530e-4f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 1.3333558e-3f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 9.6181291e-3f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 5.5504109e-2f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 2.4022651e-1f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 6.9314718e-1f ) );
+	p = _mm_add_ps( _mm_mul_ps( p, f ), one );
+	return _mm_mul_ps( p, _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( n, _mm_set1_epi32( 127 ) ), 23 ) ) );
+}
+
+// \a x ^ \a e for \a x >= 0
+inline __m128 pow_ps( __m128 x, __m128 e )
+{
+	return _mm_and_ps( _mm_cmpgt_ps( x, _mm_setzero_ps() ), exp2_ps( _mm_mul_ps( e, log2_ps( x ) ) ) );
+}
+
+inline __m128 select_ps( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+#endif // defined( CINDER_SSE2 )
+
+// Accumulates the red, green and blue values of a row of a Surface into \a stats, and their luminance when LUMINANCE
+template<bool LUMINANCE>
+void accumulateRow( const float *src, int32_t width, uint8_t pixelInc, uint8_t red, uint8_t green, uint8_t blue, bool simd, StatsSum *stats )
+{
+	float minVal = stats->mMin, maxVal = stats->mMax, maxLum = stats->mMaxLuminance;
+	double sum = 0, logSum = 0;
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( simd && ( pixelInc == 4 ) ) {
+		const __m128 wr = _mm_set1_ps( kLumRed ), wg = _mm_set1_ps( kLumGreen ), wb = _mm_set1_ps( kLumBlue ), delta = _mm_set1_ps( kLogDelta ), zero = _mm_setzero_ps();
+		__m128 vMin = _mm_set1_ps( minVal ), vMax = _mm_set1_ps( maxVal ), vMaxLum = _mm_set1_ps( maxLum ), vSum = zero, vLogSum = zero;
+		for( ; x + 4 <= width; x += 4 ) {
+			__m128 p[4] = { _mm_loadu_ps( src ), _mm_loadu_ps( src + 4 ), _mm_loadu_ps( src + 8 ), _mm_loadu_ps( src + 12 ) };
+			_MM_TRANSPOSE4_PS( p[0], p[1], p[2], p[3] );
+			const __m128 r = p[red], g = p[green], b = p[blue];
+			vMin = _mm_min_ps( vMin, _mm_min_ps( r, _mm_min_ps( g, b ) ) );
+			vMax = _mm_max_ps( vMax, _mm_max_ps( r, _mm_max_ps( g, b ) ) );
+			vSum = _mm_add_ps( vSum, _mm_add_ps( r, _mm_add_ps( g, b ) ) );
+			if( LUMINANCE ) {
+				const __m128 lum = _mm_max_ps( _mm_add_ps( _mm_mul_ps( wr, r ), _mm_add_ps( _mm_mul_ps( wg, g ), _mm_mul_ps( wb, b ) ) ), zero );
+				vMaxLum = _mm_max_ps( vMaxLum, lum );
+				vLogSum = _mm_add_ps( vLogSum, log2_ps( _mm_add_ps( lum, delta ) ) );
+			}
+			src += 16;
+		}
+		minVal = hmin_ps( vMin );
+		maxVal = hmax_ps( vMax );
+		sum = hsum_ps( vSum );
+		if( LUMINANCE ) {
+			maxLum = hmax_ps( vMaxLum );
+			logSum = hsum_ps( vLogSum );
+		}
+	}
+#endif
+	for( ; x < width; ++x ) {
+		minVal = std::min( minVal, std::min( src[red], std::min( src[green], src[blue] ) ) );
+		maxVal = std::max( maxVal, std::max( src[red], std::max( src[green], src[blue] ) ) );
+		sum += src[red] + src[green] + src[blue];
+		if( LUMINANCE ) {
+			const float lum = std::max( kLumRed * src[red] + kLumGreen * src[green] + kLumBlue * src[blue], 0.0f );
+			maxLum = std::max( maxLum, lum );
+			logSum += std::log( lum + kLogDelta ) * kInvLn2;
+		}
+		src += pixelInc;
+	}
+
+	stats->mMin = minVal;
+	stats->mMax = maxVal;
+	stats->mMaxLuminance = maxLum;
+	stats->mSum += sum;
+	stats->mLogSum += logSum;
+	stats->mCount += width;
+}
+
+// Accumulates a row of a Channel, whose values double as luminance, into \a stats
+template<bool LUMINANCE>
+void accumulateRow( const float *src, int32_t width, uint8_t increment, bool simd, StatsSum *stats )
+{
+	float minVal = stats->mMin, maxVal = stats->mMax;
+	double sum = 0, logSum = 0;
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( simd && ( increment == 1 ) ) {
+		const __m128 delta = _mm_set1_ps( kLogDelta ), zero = _mm_setzero_ps();
+		__m128 vMin = _mm_set1_ps( minVal ), vMax = _mm_set1_ps( maxVal ), vSum = zero, vLogSum = zero;
+		for( ; x + 4 <= width; x += 4 ) {
+			const __m128 v = _mm_loadu_ps( src );
+			vMin = _mm_min_ps( vMin, v );
+			vMax = _mm_max_ps( vMax, v );
+			vSum = _mm_add_ps( vSum, v );
+			if( LUMINANCE )
+				vLogSum = _mm_add_ps( vLogSum, log2_ps( _mm_add_ps( _mm_max_ps( v, zero ), delta ) ) );
+			src += 4;
+		}
+		minVal = hmin_ps( vMin );
+		maxVal = hmax_ps( vMax );
+		sum = hsum_ps( vSum );
+		if( LUMINANCE )
+			logSum = hsum_ps( vLogSum );
+	}
+#endif
+	for( ; x < width; ++x ) {
+		minVal = std::min( minVal, *src );
+		maxVal = std::max( maxVal, *src );
+		sum += *src;
+		if( LUMINANCE )
+			logSum += std::log( std::max( *src, 0.0f ) + kLogDelta ) * kInvLn2;
+		src += increment;
+	}
+
+	stats->mMin = minVal;
+	stats->mMax = maxVal;
+	stats->mMaxLuminance = std::max( stats->mMaxLuminance, maxVal );
+	stats->mSum += sum;
+	stats->mLogSum += logSum;
+	stats->mCount += width;
+}
+
+template<bool LUMINANCE>
+class SurfaceStatsBand {
+  public:
+	SurfaceStatsBand( const Surface32f *surface, StatsSum *result, std::mutex *mutex )
+		: mSurface( surface ), mResult( result ), mMutex( mutex ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const uint8_t red = mSurface->getRedOffset(), green = mSurface->getGreenOffset(), blue = mSurface->getBlueOffset();
+		StatsSum band;
+		for( int32_t y = y1; y < y2; ++y )
+			accumulateRow<LUMINANCE>( mSurface->getData( Vec2i( 0, y ) ), mSurface->getWidth(), mSurface->getPixelInc(), red, green, blue, mSimd, &band );
+
+		std::lock_guard<std::mutex> lock( *mMutex );
+		mResult->merge( band );
+	}
+
+  private:
+	const Surface32f	*mSurface;
+	StatsSum			*mResult;
+	std::mutex			*mMutex;
+	bool				mSimd;
+};
+
+template<bool LUMINANCE>
+class ChannelStatsBand {
+  public:
+	ChannelStatsBand( const Channel32f *channel, StatsSum *result, std::mutex *mutex )
+		: mChannel( channel ), mResult( result ), mMutex( mutex ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		StatsSum band;
+		for( int32_t y = y1; y < y2; ++y )
+			accumulateRow<LUMINANCE>( mChannel->getData( 0, y ), mChannel->getWidth(), mChannel->getIncrement(), mSimd, &band );
+
+		std::lock_guard<std::mutex> lock( *mMutex );
+		mResult->merge( band );
+	}
+
+  private:
+	const Channel32f	*mChannel;
+	StatsSum			*mResult;
+	std::mutex			*mMutex;
+	bool				mSimd;
+};
+
+template<bool LUMINANCE>
+StatsSum accumulate( const Surface32f &surface )
+{
+	StatsSum result;
+	std::mutex mutex;
+	parallelRows( 0, surface.getHeight(), SurfaceStatsBand<LUMINANCE>( &surface, &result, &mutex ) );
+	return result;
+}
+
+template<bool LUMINANCE>
+StatsSum accumulate( const Channel32f &channel )
+{
+	StatsSum result;
+	std::mutex mutex;
+	parallelRows( 0, channel.getHeight(), ChannelStatsBand<LUMINANCE>( &channel, &result, &mutex ) );
+	return result;
+}
+
+HdrStats toHdrStats( const StatsSum &sum, int valuesPerPixel )
+{
+	HdrStats result;
+	if( sum.mCount == 0 ) {
+		result.mMin = result.mMax = result.mMean = result.mLogAverage = result.mMaxLuminance = 0;
+		return result;
+	}
+	
+	result.mMin = sum.mMin;
+	result.mMax = sum.mMax;
+	result.mMean = (float)( sum.mSum / ( (double)sum.mCount * valuesPerPixel ) );
+	result.mLogAverage = (float)std::pow( 2.0, sum.mLogSum / (double)sum.mCount );
+	result.mMaxLuminance = sum.mMaxLuminance;
+	return result;
+}
+
+// Applies ( v - min ) * scale to the red, green and blue values of a band of rows
+class NormalizeSurfaceBand {
+  public:
+	NormalizeSurfaceBand( Surface32f *surface, float minVal, float scale )
+		: mSurface( surface ), mMin( minVal ), mScale( scale ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t width = mSurface->getWidth();
+		const uint8_t pixelInc = mSurface->getPixelInc();
+		const uint8_t redOffset = mSurface->getRedOffset(), greenOffset = mSurface->getGreenOffset(), blueOffset = mSurface->getBlueOffset();
+		for( int32_t y = y1; y < y2; ++y ) {
+			float *dstPtr = mSurface->getData( Vec2i( 0, y ) );
+			int32_t x = 0;
+#if defined( CINDER_SSE2 )
+			if( mSimd && ( pixelInc == 4 ) ) {
+				// a single pixel fills a register; the lane holding alpha or padding keeps its value
+				int32_t colorLanes[4] = { 0, 0, 0, 0 };
+				colorLanes[redOffset] = colorLanes[greenOffset] = colorLanes[blueOffset] = -1;
+				const __m128 colorMask = _mm_castsi128_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>( colorLanes ) ) );
+				const __m128 minVal = _mm_set1_ps( mMin ), scale = _mm_set1_ps( mScale );
+				for( ; x < width; ++x ) {
+					const __m128 v = _mm_loadu_ps( dstPtr );
+					_mm_storeu_ps( dstPtr, select_ps( colorMask, _mm_mul_ps( _mm_sub_ps( v, minVal ), scale ), v ) );
+					dstPtr += 4;
+				}
+			}
+#endif
+			for( ; x < width; ++x ) {
+				dstPtr[redOffset] = ( dstPtr[redOffset] - mMin ) * mScale;
+				dstPtr[greenOffset] = ( dstPtr[greenOffset] - mMin ) * mScale;
+				dstPtr[blueOffset] = ( dstPtr[blueOffset] - mMin ) * mScale;
+				dstPtr += pixelInc;
+			}
+		}
+	}
+
+  private:
+	Surface32f	*mSurface;
+	float		mMin, mScale;
+	bool		mSimd;
+};
+
+class NormalizeChannelBand {
+  public:
+	NormalizeChannelBand( Channel32f *channel, float minVal, float scale )
+		: mChannel( channel ), mMin( minVal ), mScale( scale ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t width = mChannel->getWidth();
+		const uint8_t increment = mChannel->getIncrement();
+		for( int32_t y = y1; y < y2; ++y ) {
+			float *dstPtr = mChannel->getData( 0, y );
+			int32_t x = 0;
+#if defined( CINDER_SSE2 )
+			if( mSimd && ( increment == 1 ) ) {
+				const __m128 minVal = _mm_set1_ps( mMin ), scale = _mm_set1_ps( mScale );
+				for( ; x + 4 <= width; x += 4 ) {
+					_mm_storeu_ps( dstPtr, _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( dstPtr ), minVal ), scale ) );
+					dstPtr += 4;
+				}
+			}
+#endif
+			for( ; x < width; ++x ) {
+				*dstPtr = ( *dstPtr - mMin ) * mScale;
+				dstPtr += increment;
+			}
 		}
 	}
+
+  private:
+	Channel32f	*mChannel;
+	float		mMin, mScale;
+	bool		mSimd;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tone mapping
+
+// John Hable's filmic curve, as used in Uncharted 2
+const float kFilmicA = 0.15f, kFilmicB = 0.50f, kFilmicC = 0.10f, kFilmicD = 0.20f, kFilmicE = 0.02f, kFilmicF = 0.30f;
+const float kFilmicDefaultWhite = 11.2f;
+
+inline float filmic( float x )
+{
+	return ( ( x * ( kFilmicA * x + kFilmicC * kFilmicB ) + kFilmicD * kFilmicE ) / ( x * ( kFilmicA * x + kFilmicB ) + kFilmicD * kFilmicF ) ) - kFilmicE / kFilmicF;
+}
+
+// Everything toneMap() derives from its ToneMapOptions before touching a pixel
+struct ToneMapParams {
+	float		mScale;			// 2 ^ exposure
+	float		mKeyScale;		// key / log-average luminance
+	float		mInvWhite2;		// 1 / white^2 for Reinhard, 0 for an infinite white point
+	float		mFilmicScale;	// 1 / filmic( white )
+	float		mInvGamma;
+};
+
+// Maps exposed linear color \a c to display-referred [0,1], given \a localLum, the exposed luminance of the surround for REINHARD_LOCAL
+template<int OP>
+inline void toneMapColor( float c[3], float localLum, const ToneMapParams &params )
+{
+	if( OP == ToneMapOptions::REINHARD || OP == ToneMapOptions::REINHARD_LOCAL ) {
+		// scales color by Ld / L, where Ld = Ls * ( 1 + Ls / white^2 ) / ( 1 + Ls ) and Ls = L * keyScale
+		const float lum = std::max( kLumRed * c[0] + kLumGreen * c[1] + kLumBlue * c[2], 0.0f ) * params.mKeyScale;
+		const float surround = ( OP == ToneMapOptions::REINHARD_LOCAL ) ? localLum * params.mKeyScale : lum;
+		const float ratio = params.mKeyScale * ( 1 + lum * params.mInvWhite2 ) / ( 1 + surround );
+		c[0] *= ratio; c[1] *= ratio; c[2] *= ratio;
+	}
+	else if( OP == ToneMapOptions::FILMIC ) {
+		for( int i = 0; i < 3; ++i )
+			c[i] = filmic( std::max( c[i], 0.0f ) ) * params.mFilmicScale;
+	}
+}
+
+inline uint8_t encode( float v, float invGamma )
+{
+	v = constrain<float>( v, 0, 1 );
+	if( invGamma != 1 )
+		v = std::pow( v, invGamma );
+	return (uint8_t)( v * 255 + 0.5f );
+}
+
+#if defined( CINDER_SSE2 )
+
+inline __m128 filmic_ps( __m128 x )
+{
+	const __m128 a = _mm_set1_ps( kFilmicA ), b = _mm_set1_ps( kFilmicB );
+	const __m128 num = _mm_add_ps( _mm_mul_ps( x, _mm_add_ps( _mm_mul_ps( a, x ), _mm_set1_ps( kFilmicC * kFilmicB ) ) ), _mm_set1_ps( kFilmicD * kFilmicE ) );
+	const __m128 den = _mm_add_ps( _mm_mul_ps( x, _mm_add_ps( _mm_mul_ps( a, x ), b ) ), _mm_set1_ps( kFilmicD * kFilmicF ) );
+	return _mm_sub_ps( _mm_div_ps( num, den ), _mm_set1_ps( kFilmicE / kFilmicF ) );
+}
+
+template<int OP>
+inline void toneMapColor_ps( __m128 c[3], __m128 localLum, const ToneMapParams &params )
+{
+	if( OP == ToneMapOptions::REINHARD || OP == ToneMapOptions::REINHARD_LOCAL ) {
+		const __m128 one = _mm_set1_ps( 1.0f ), keyScale = _mm_set1_ps( params.mKeyScale );
+		const __m128 lum = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( kLumRed ), c[0] ), _mm_add_ps( _mm_mul_ps( _mm_set1_ps( kLumGreen ), c[1] ), _mm_mul_ps( _mm_set1_ps( kLumBlue ), c[2] ) ) );
+		const __m128 scaledLum = _mm_mul_ps( _mm_max_ps( lum, _mm_setzero_ps() ), keyScale );
+		const __m128 surround = ( OP == ToneMapOptions::REINHARD_LOCAL ) ? _mm_mul_ps( localLum, keyScale ) : scaledLum;
+		const __m128 ratio = _mm_div_ps( _mm_mul_ps( keyScale, _mm_add_ps( one, _mm_mul_ps( scaledLum, _mm_set1_ps( params.mInvWhite2 ) ) ) ), _mm_add_ps( one, surround ) );
+		c[0] = _mm_mul_ps( c[0], ratio ); c[1] = _mm_mul_ps( c[1], ratio ); c[2] = _mm_mul_ps( c[2], ratio );
+	}
+	else if( OP == ToneMapOptions::FILMIC ) {
+		const __m128 filmicScale = _mm_set1_ps( params.mFilmicScale );
+		for( int i = 0; i < 3; ++i )
+			c[i] = _mm_mul_ps( filmic_ps( _mm_max_ps( c[i], _mm_setzero_ps() ) ), filmicScale );
+	}
+}
+
+// clamps to [0,1], gamma encodes and quantizes to [0,255] in each 32-bit lane
+inline __m128i encode_ps( __m128 v, const ToneMapParams &params )
+{
+	v = _mm_min_ps( _mm_max_ps( v, _mm_setzero_ps() ), _mm_set1_ps( 1.0f ) );
+	if( params.mInvGamma != 1 )
+		v = pow_ps( v, _mm_set1_ps( params.mInvGamma ) );
+	return _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( v, _mm_set1_ps( 255.0f ) ), _mm_set1_ps( 0.5f ) ) );
+}
+
+#endif // defined( CINDER_SSE2 )
+
+template<int OP>
+class ToneMapBand {
+  public:
+	ToneMapBand( const Surface32f *src, Surface8u *dst, const Channel32f *localLum, const Vec2i &size, const ToneMapParams *params )
+		: mSrc( src ), mDst( dst ), mLocalLum( localLum ), mSize( size ), mParams( params ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const ToneMapParams &params = *mParams;
+		const uint8_t srcInc = mSrc->getPixelInc(), dstInc = mDst->getPixelInc();
+		const uint8_t sR = mSrc->getRedOffset(), sG = mSrc->getGreenOffset(), sB = mSrc->getBlueOffset();
+		const bool copyAlpha = mSrc->hasAlpha() && mDst->hasAlpha();
+		const uint8_t sA = ( copyAlpha ) ? mSrc->getAlphaOffset() : 0;
+		const uint8_t dR = mDst->getRedOffset(), dG = mDst->getGreenOffset(), dB = mDst->getBlueOffset();
+		// a 4-channel destination without alpha has padding there, which is written as 255 as well
+		const uint8_t dA = ( mDst->hasAlpha() ) ? mDst->getAlphaOffset() : ( ( dstInc == 4 ) ? 6 - dR - dG - dB : 0 );
+		const bool writeAlpha = dstInc == 4;
+		const float exposure = params.mScale;
+
+		for( int32_t y = y1; y < y2; ++y ) {
+			const float *src = mSrc->getData( Vec2i( 0, y ) );
+			const float *local = ( OP == ToneMapOptions::REINHARD_LOCAL ) ? mLocalLum->getData( 0, y ) : 0;
+			uint8_t *dst = mDst->getData( Vec2i( 0, y ) );
+			int32_t x = 0;
+#if defined( CINDER_SSE2 )
+			if( mSimd && ( srcInc == 4 ) && ( dstInc == 4 ) ) {
+				const __m128 scale = _mm_set1_ps( exposure );
+				const __m128i shiftR = _mm_cvtsi32_si128( dR * 8 ), shiftG = _mm_cvtsi32_si128( dG * 8 ), shiftB = _mm_cvtsi32_si128( dB * 8 ), shiftA = _mm_cvtsi32_si128( dA * 8 );
+				const __m128i opaque = _mm_set1_epi32( 255 );
+				for( ; x + 4 <= mSize.x; x += 4 ) {
+					__m128 p[4] = { _mm_loadu_ps( src ), _mm_loadu_ps( src + 4 ), _mm_loadu_ps( src + 8 ), _mm_loadu_ps( src + 12 ) };
+					_MM_TRANSPOSE4_PS( p[0], p[1], p[2], p[3] );
+					__m128 c[3] = { _mm_mul_ps( p[sR], scale ), _mm_mul_ps( p[sG], scale ), _mm_mul_ps( p[sB], scale ) };
+					const __m128 localLum = ( OP == ToneMapOptions::REINHARD_LOCAL ) ? _mm_mul_ps( _mm_loadu_ps( local + x ), scale ) : _mm_setzero_ps();
+					toneMapColor_ps<OP>( c, localLum, params );
+
+					const __m128i alpha = ( copyAlpha ) ? _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_min_ps( _mm_max_ps( p[sA], _mm_setzero_ps() ), _mm_set1_ps( 1.0f ) ), _mm_set1_ps( 255.0f ) ), _mm_set1_ps( 0.5f ) ) ) : opaque;
+					__m128i result = _mm_sll_epi32( encode_ps( c[0], params ), shiftR );
+					result = _mm_or_si128( result, _mm_sll_epi32( encode_ps( c[1], params ), shiftG ) );
+					result = _mm_or_si128( result, _mm_sll_epi32( encode_ps( c[2], params ), shiftB ) );
+					result = _mm_or_si128( result, _mm_sll_epi32( alpha, shiftA ) );
+					_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), result );
+					src += 16;
+					dst += 16;
+				}
+			}
+#endif
+			for( ; x < mSize.x; ++x ) {
+				float c[3] = { src[sR] * exposure, src[sG] * exposure, src[sB] * exposure };
+				toneMapColor<OP>( c, ( OP == ToneMapOptions::REINHARD_LOCAL ) ? local[x] * exposure : 0, params );
+				dst[dR] = encode( c[0], params.mInvGamma );
+				dst[dG] = encode( c[1], params.mInvGamma );
+				dst[dB] = encode( c[2], params.mInvGamma );
+				if( writeAlpha )
+					dst[dA] = ( copyAlpha ) ? encode( src[sA], 1 ) : 255;
+				src += srcInc;
+				dst += dstInc;
+			}
+		}
+	}
+
+  private:
+	const Surface32f	*mSrc;
+	Surface8u			*mDst;
+	const Channel32f	*mLocalLum;
+	Vec2i				mSize;
+	const ToneMapParams	*mParams;
+	bool				mSimd;
+};
+
+// Writes the luminance of \a src into \a dst, the surround REINHARD_LOCAL blurs
+class LuminanceBand {
+  public:
+	LuminanceBand( const Surface32f *src, Channel32f *dst )
+		: mSrc( src ), mDst( dst )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const uint8_t pixelInc = mSrc->getPixelInc();
+		const uint8_t red = mSrc->getRedOffset(), green = mSrc->getGreenOffset(), blue = mSrc->getBlueOffset();
+		for( int32_t y = y1; y < y2; ++y ) {
+			const float *src = mSrc->getData( Vec2i( 0, y ) );
+			float *dst = mDst->getData( 0, y );
+			for( int32_t x = 0; x < mDst->getWidth(); ++x ) {
+				dst[x] = std::max( kLumRed * src[red] + kLumGreen * src[green] + kLumBlue * src[blue], 0.0f );
+				src += pixelInc;
+			}
+		}
+	}
+
+  private:
+	const Surface32f	*mSrc;
+	Channel32f			*mDst;
+};
+
+} // anonymous namespace
+
+void hdrNormalize( Surface32f *surface )
+{
+	// first take histogram to find the minimum and maximum values present
+	const StatsSum stats = accumulate<false>( *surface );
+	if( stats.mCount == 0 )
+		return;
 	
 	// if min==max then we should just fill with black
-	if( minVal == maxVal ) {
+	if( stats.mMin == stats.mMax ) {
 		fill( surface, Color( 0, 0, 0 ) );
 		return;
 	}
 	
-	float scale = 1.0f / ( maxVal - minVal );
-	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
-		float *dstPtr = surface->getData( Vec2i( 0, y ) );
-		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
-			dstPtr[redOffset] = ( dstPtr[redOffset] - minVal ) * scale;
-			dstPtr[greenOffset] = ( dstPtr[greenOffset] - minVal ) * scale;
-			dstPtr[blueOffset] = ( dstPtr[blueOffset] - minVal ) * scale;
-
-			dstPtr += pixelInc;
-		}
-	}	
+	parallelRows( 0, surface->getHeight(), NormalizeSurfaceBand( surface, stats.mMin, 1.0f / ( stats.mMax - stats.mMin ) ) );
 }
 
 void hdrNormalize( Channel32f *channel )
 {
 	// first take histogram to find the minimum and maximum values present
-	float minVal, maxVal;
-	getMinMax( *channel, &minVal, &maxVal );
+	const StatsSum stats = accumulate<false>( *channel );
+	if( stats.mCount == 0 )
+		return;
 
 	// if min==max then we should just fill with black
-	if( minVal == maxVal ) {
+	if( stats.mMin == stats.mMax ) {
 		fill<float>( channel, 0 );
 		return;
 	}
 	
-	float scale = 1.0f / ( maxVal - minVal );
-	Channel32f::Iter iter = channel->getIter();
-	while( iter.line() ) {
-		while( iter.pixel() ) {
-			iter.v() = ( iter.v() - minVal ) * scale;
-		}
-	}
+	parallelRows( 0, channel->getHeight(), NormalizeChannelBand( channel, stats.mMin, 1.0f / ( stats.mMax - stats.mMin ) ) );
 }
 
 void getMinMax( const Channel32f &channel, float *resultMin, float *resultMax )
 {
-	float minVal = *(channel.getData( Vec2i::zero() )), maxVal = *(channel.getData( Vec2i::zero() ));
-	Channel32f::ConstIter iter = channel.getIter();
-	while( iter.line() ) {
-		while( iter.pixel() ) {
-			minVal = std::min( minVal, iter.v() );
-			maxVal = std::max( maxVal, iter.v() );
+	const StatsSum stats = accumulate<false>( channel );
+	*resultMin = stats.mMin;
+	*resultMax = stats.mMax;
+}
+
+HdrStats getStats( const Surface32f &surface )
+{
+	return toHdrStats( accumulate<true>( surface ), 3 );
+}
+
+HdrStats getStats( const Channel32f &channel )
+{
+	return toHdrStats( accumulate<true>( channel ), 1 );
+}
+
+void toneMap( const Surface32f &srcSurface, Surface8u *dstSurface, const ToneMapOptions &options )
+{
+	const Vec2i size( std::min( srcSurface.getWidth(), dstSurface->getWidth() ), std::min( srcSurface.getHeight(), dstSurface->getHeight() ) );
+	if( ( size.x <= 0 ) || ( size.y <= 0 ) )
+		return;
+
+	const ToneMapOptions::Operator op = options.getOp();
+	const bool reinhard = ( op == ToneMapOptions::REINHARD ) || ( op == ToneMapOptions::REINHARD_LOCAL );
+	
+	ToneMapParams params;
+	params.mScale = std::pow( 2.0f, options.getExposure() );
+	params.mInvGamma = ( options.getGamma() > 0 ) ? 1.0f / options.getGamma() : 1.0f;
+	params.mKeyScale = 1;
+	params.mInvWhite2 = ( options.getWhite() > 0 ) ? 1.0f / ( options.getWhite() * options.getWhite() ) : 0.0f;
+	params.mFilmicScale = 1.0f / filmic( ( options.getWhite() > 0 ) ? options.getWhite() : kFilmicDefaultWhite );
+	if( reinhard ) {
+		// the log-average is measured before exposure, so exposure still brightens or darkens the result
+		const float logAverage = ( options.getLogAverage() > 0 ) ? options.getLogAverage() : getStats( srcSurface ).mLogAverage;
+		params.mKeyScale = options.getKey() / std::max( logAverage, kLogDelta );
+	}
+
+	switch( op ) {
+		case ToneMapOptions::LINEAR:
+			parallelRows( 0, size.y, ToneMapBand<ToneMapOptions::LINEAR>( &srcSurface, dstSurface, 0, size, &params ) );
+		break;
+		case ToneMapOptions::REINHARD:
+			parallelRows( 0, size.y, ToneMapBand<ToneMapOptions::REINHARD>( &srcSurface, dstSurface, 0, size, &params ) );
+		break;
+		case ToneMapOptions::REINHARD_LOCAL: {
+			Channel32f localLum( srcSurface.getWidth(), srcSurface.getHeight() );
+			parallelRows( 0, localLum.getHeight(), LuminanceBand( &srcSurface, &localLum ) );
+			gaussianBlur( localLum, &localLum, options.getLocalSigma() );
+			parallelRows( 0, size.y, ToneMapBand<ToneMapOptions::REINHARD_LOCAL>( &srcSurface, dstSurface, &localLum, size, &params ) );
 		}
+		break;
+		case ToneMapOptions::FILMIC:
+			parallelRows( 0, size.y, ToneMapBand<ToneMapOptions::FILMIC>( &srcSurface, dstSurface, 0, size, &params ) );
+		break;
 	}
-	*resultMin = minVal;
-	*resultMax = maxVal;
 }
 
 } } // namespace cinder::ip
@@ -0,0 +1,419 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Histogram.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/Thread.h"
+
+#include "ImagePlane.h"
+
+#include <vector>
+#include <cmath>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// Maps values to bins, and fractions of the range back to values
+template<typename T>
+class Binning;
+
+template<>
+class Binning<uint8_t> {
+  public:
+	int32_t		getNumBins() const { return 256; }
+	int32_t		operator()( uint8_t value ) const { return value; }
+	uint8_t		value( float fraction ) const { return static_cast<uint8_t>( fraction * 255 + 0.5f ); }
+	uint8_t		round( float value ) const { return static_cast<uint8_t>( value + 0.5f ); }
+};
+
+template<>
+class Binning<float> {
+  public:
+	Binning( int32_t numBins, float minValue, float maxValue )
+		: mNumBins( std::max<int32_t>( numBins, 1 ) ), mMin( minValue ), mRange( maxValue - minValue )
+	{
+		mScale = mNumBins / mRange;
+	}
+
+	int32_t		getNumBins() const { return mNumBins; }
+	int32_t		operator()( float value ) const
+	{
+		const float bin = ( value - mMin ) * mScale;
+		// NaN fails the comparison and lands in the first bin
+		if( ! ( bin >= 1 ) )
+			return 0;
+		else if( bin >= mNumBins )
+			return mNumBins - 1;
+		return static_cast<int32_t>( bin );
+	}
+	float		value( float fraction ) const { return mMin + fraction * mRange; }
+	float		round( float value ) const { return value; }
+
+  private:
+	int32_t		mNumBins;
+	float		mMin, mRange, mScale;
+};
+
+// A Channel, or the red, green and blue of a Surface
+template<typename T>
+ImagePlane channelPlane( const ChannelT<T> &channel )
+{
+	ImagePlane result( channel.getData(), channel.getRowBytes(), channel.getIncrement() );
+	result.addChannel( 0 );
+	return result;
+}
+
+template<typename T>
+ImagePlane surfacePlane( const SurfaceT<T> &surface )
+{
+	ImagePlane result( surface.getData(), surface.getRowBytes(), surface.getPixelInc() );
+	result.addChannel( surface.getRedOffset() );
+	result.addChannel( surface.getGreenOffset() );
+	result.addChannel( surface.getBlueOffset() );
+	return result;
+}
+
+// Counts each plane of a band of rows into a private histogram, which is added to the result once the band is done
+template<typename T>
+class HistogramBand {
+  public:
+	HistogramBand( const ImagePlane &planes, int32_t width, const Binning<T> &binning, uint32_t * const *results, std::mutex *mutex )
+		: mPlanes( planes ), mWidth( width ), mBinning( binning ), mMutex( mutex )
+	{
+		for( int32_t p = 0; p < mPlanes.mNumChannels; ++p )
+			mResults[p] = results[p];
+	}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t numBins = mBinning.getNumBins(), numPlanes = mPlanes.mNumChannels;
+		const int32_t inc = mPlanes.mPixelInc;
+		// four histograms per plane, so that runs of similar values don't serialize on one counter
+		std::vector<uint32_t> counts( numPlanes * 4 * numBins, 0 );
+		for( int32_t y = y1; y < y2; ++y ) {
+			const T *row = mPlanes.getRow<T>( y );
+			for( int32_t p = 0; p < numPlanes; ++p ) {
+				if( ! mResults[p] )
+					continue;
+				uint32_t *c0 = &counts[p * 4 * numBins], *c1 = c0 + numBins, *c2 = c1 + numBins, *c3 = c2 + numBins;
+				const T *src = row + mPlanes.mOffsets[p];
+				int32_t x = 0;
+				for( ; x + 4 <= mWidth; x += 4, src += 4 * inc ) {
+					++c0[mBinning( src[0] )];
+					++c1[mBinning( src[inc] )];
+					++c2[mBinning( src[2 * inc] )];
+					++c3[mBinning( src[3 * inc] )];
+				}
+				for( ; x < mWidth; ++x, src += inc )
+					++c0[mBinning( *src )];
+			}
+		}
+
+		std::lock_guard<std::mutex> lock( *mMutex );
+		for( int32_t p = 0; p < numPlanes; ++p ) {
+			if( ! mResults[p] )
+				continue;
+			const uint32_t *c = &counts[p * 4 * numBins];
+			for( int32_t b = 0; b < numBins; ++b )
+				mResults[p][b] += c[b] + c[numBins + b] + c[2 * numBins + b] + c[3 * numBins + b];
+		}
+	}
+
+  private:
+	ImagePlane		mPlanes;
+	int32_t			mWidth;
+	Binning<T>		mBinning;
+	uint32_t		*mResults[3];
+	std::mutex		*mMutex;
+};
+
+// Zeroes \a results, which may alias one another or be NULL, and counts the planes into them
+template<typename T>
+void histogramImpl( const ImagePlane &planes, int32_t width, int32_t height, const Binning<T> &binning, uint32_t * const *results )
+{
+	for( int32_t p = 0; p < planes.mNumChannels; ++p )
+		if( results[p] )
+			std::fill( results[p], results[p] + binning.getNumBins(), 0 );
+
+	std::mutex mutex;
+	parallelRows( 0, height, HistogramBand<T>( planes, width, binning, results, &mutex ) );
+}
+
+// Replaces each value of each plane by its bin's entry in a lookup table
+template<typename T>
+class LutBand {
+  public:
+	LutBand( const ImagePlane &src, const ImagePlane &dst, int32_t width, const T *lut, const Binning<T> &binning )
+		: mSrc( src ), mDst( dst ), mWidth( width ), mLut( lut ), mBinning( binning )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		for( int32_t y = y1; y < y2; ++y ) {
+			for( int32_t p = 0; p < mSrc.mNumChannels; ++p ) {
+				const T *src = mSrc.getRow<T>( y ) + mSrc.mOffsets[p];
+				T *dst = mDst.getRow<T>( y ) + mDst.mOffsets[p];
+				for( int32_t x = 0; x < mWidth; ++x, src += mSrc.mPixelInc, dst += mDst.mPixelInc )
+					*dst = mLut[mBinning( *src )];
+			}
+		}
+	}
+
+  private:
+	ImagePlane		mSrc, mDst;
+	int32_t			mWidth;
+	const T			*mLut;
+	Binning<T>		mBinning;
+};
+
+template<typename T>
+void equalizeImpl( const ImagePlane &src, const ImagePlane &dst, int32_t width, int32_t height, const Binning<T> &binning )
+{
+	const int32_t numBins = binning.getNumBins();
+	std::vector<uint32_t> hist( numBins );
+	uint32_t *results[3] = { &hist[0], &hist[0], &hist[0] };
+	histogramImpl( src, width, height, binning, results );
+
+	// map the cumulative distribution onto the full range, starting from the lowest occupied bin
+	uint64_t total = 0, lowest = 0;
+	for( int32_t b = 0; b < numBins; ++b ) {
+		if( ( lowest == 0 ) && hist[b] )
+			lowest = hist[b];
+		total += hist[b];
+	}
+	std::vector<T> lut( numBins );
+	uint64_t cumulative = 0;
+	for( int32_t b = 0; b < numBins; ++b ) {
+		cumulative += hist[b];
+		if( total == lowest ) // a single occupied bin has no distribution to equalize
+			lut[b] = binning.value( b / (float)std::max<int32_t>( numBins - 1, 1 ) );
+		else if( cumulative < lowest )
+			lut[b] = binning.value( 0 );
+		else
+			lut[b] = binning.value( (float)( ( cumulative - lowest ) / (double)( total - lowest ) ) );
+	}
+
+	parallelRows( 0, height, LutBand<T>( src, dst, width, &lut[0], binning ) );
+}
+
+// Builds the equalizing lookup table of the clipped histogram of each tile in a band of tile rows
+template<typename T>
+class ClaheTileBand {
+  public:
+	ClaheTileBand( const ImagePlane &src, int32_t width, int32_t height, int32_t tilesX, int32_t tilesY, float clipLimit, const Binning<T> &binning, T *luts )
+		: mSrc( src ), mWidth( width ), mHeight( height ), mTilesX( tilesX ), mTilesY( tilesY ), mClipLimit( clipLimit ), mBinning( binning ), mLuts( luts )
+	{}
+
+	void operator()( int32_t ty1, int32_t ty2 ) const
+	{
+		const int32_t numBins = mBinning.getNumBins();
+		std::vector<uint32_t> hist( numBins );
+		for( int32_t ty = ty1; ty < ty2; ++ty ) {
+			const int32_t y1 = ty * mHeight / mTilesY, y2 = ( ty + 1 ) * mHeight / mTilesY;
+			for( int32_t tx = 0; tx < mTilesX; ++tx ) {
+				const int32_t x1 = tx * mWidth / mTilesX, x2 = ( tx + 1 ) * mWidth / mTilesX;
+				std::fill( hist.begin(), hist.end(), 0 );
+				for( int32_t y = y1; y < y2; ++y ) {
+					const T *src = mSrc.getRow<T>( y ) + x1 * mSrc.mPixelInc;
+					for( int32_t x = x1; x < x2; ++x, src += mSrc.mPixelInc )
+						++hist[mBinning( *src )];
+				}
+
+				const uint32_t tilePixels = ( x2 - x1 ) * ( y2 - y1 );
+				if( mClipLimit > 0 ) {
+					const uint32_t limit = std::max<uint32_t>( static_cast<uint32_t>( mClipLimit * tilePixels / numBins ), 1 );
+					uint32_t excess = 0;
+					for( int32_t b = 0; b < numBins; ++b ) {
+						if( hist[b] > limit ) {
+							excess += hist[b] - limit;
+							hist[b] = limit;
+						}
+					}
+					// redistribute the excess evenly, spreading the remainder across the range
+					const uint32_t batch = excess / numBins;
+					uint32_t remainder = excess % numBins;
+					for( int32_t b = 0; b < numBins; ++b )
+						hist[b] += batch;
+					if( remainder ) {
+						const int32_t step = std::max<int32_t>( numBins / remainder, 1 );
+						for( int32_t b = 0; ( b < numBins ) && remainder; b += step, --remainder )
+							++hist[b];
+					}
+				}
+
+				T *lut = mLuts + ( ty * mTilesX + tx ) * numBins;
+				const float invPixels = 1.0f / tilePixels;
+				uint32_t cumulative = 0;
+				for( int32_t b = 0; b < numBins; ++b ) {
+					cumulative += hist[b];
+					lut[b] = mBinning.value( cumulative * invPixels );
+				}
+			}
+		}
+	}
+
+  private:
+	ImagePlane		mSrc;
+	int32_t			mWidth, mHeight, mTilesX, mTilesY;
+	float			mClipLimit;
+	Binning<T>		mBinning;
+	T				*mLuts;
+};
+
+// Finds the tiles whose centers surround \a pos along an axis of \a size pixels and \a tiles tiles, and the weight of the second
+void tileNeighbors( int32_t pos, int32_t size, int32_t tiles, int32_t *tile0, int32_t *tile1, float *weight )
+{
+	const float t = ( pos + 0.5f ) * tiles / size - 0.5f;
+	*tile0 = static_cast<int32_t>( std::floor( t ) );
+	*weight = t - *tile0;
+	if( *tile0 < 0 ) {
+		*tile0 = 0;
+		*weight = 0;
+	}
+	else if( *tile0 >= tiles - 1 ) {
+		*tile0 = tiles - 1;
+		*weight = 0;
+	}
+	*tile1 = std::min( *tile0 + 1, tiles - 1 );
+}
+
+// Maps each pixel by bilinearly interpolating the lookup tables of the four nearest tiles
+template<typename T>
+class ClaheApplyBand {
+  public:
+	ClaheApplyBand( const ImagePlane &src, const ImagePlane &dst, int32_t width, int32_t height, int32_t tilesX, int32_t tilesY,
+					const T *luts, const int32_t *columnTiles, const float *columnWeights, const Binning<T> &binning )
+		: mSrc( src ), mDst( dst ), mWidth( width ), mHeight( height ), mTilesX( tilesX ), mTilesY( tilesY ), mLuts( luts ),
+			mColumnTiles( columnTiles ), mColumnWeights( columnWeights ), mBinning( binning )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t numBins = mBinning.getNumBins();
+		for( int32_t y = y1; y < y2; ++y ) {
+			int32_t ty0, ty1;
+			float wy;
+			tileNeighbors( y, mHeight, mTilesY, &ty0, &ty1, &wy );
+			const T *top = mLuts + ty0 * mTilesX * numBins, *bottom = mLuts + ty1 * mTilesX * numBins;
+			const T *src = mSrc.getRow<T>( y );
+			T *dst = mDst.getRow<T>( y );
+			for( int32_t x = 0; x < mWidth; ++x, src += mSrc.mPixelInc, dst += mDst.mPixelInc ) {
+				const int32_t bin = mBinning( *src );
+				const int32_t left = mColumnTiles[2 * x] * numBins + bin, right = mColumnTiles[2 * x + 1] * numBins + bin;
+				const float wx = mColumnWeights[x];
+				const float upper = top[left] + wx * ( top[right] - top[left] );
+				const float lower = bottom[left] + wx * ( bottom[right] - bottom[left] );
+				*dst = mBinning.round( upper + wy * ( lower - upper ) );
+			}
+		}
+	}
+
+  private:
+	ImagePlane		mSrc, mDst;
+	int32_t			mWidth, mHeight, mTilesX, mTilesY;
+	const T			*mLuts;
+	const int32_t	*mColumnTiles;
+	const float		*mColumnWeights;
+	Binning<T>		mBinning;
+};
+
+template<typename T>
+void claheImpl( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ClaheOptions &options, const Binning<T> &binning )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( ( width <= 0 ) || ( height <= 0 ) )
+		return;
+	const int32_t tilesX = constrain<int32_t>( options.getTilesX(), 1, width ), tilesY = constrain<int32_t>( options.getTilesY(), 1, height );
+	const ImagePlane src = channelPlane( srcChannel ), dst = channelPlane( *dstChannel );
+
+	std::vector<T> luts( tilesX * tilesY * binning.getNumBins() );
+	parallelRows( 0, tilesY, ClaheTileBand<T>( src, width, height, tilesX, tilesY, options.getClipLimit(), binning, &luts[0] ), 1 );
+
+	std::vector<int32_t> columnTiles( width * 2 );
+	std::vector<float> columnWeights( width );
+	for( int32_t x = 0; x < width; ++x )
+		tileNeighbors( x, width, tilesX, &columnTiles[2 * x], &columnTiles[2 * x + 1], &columnWeights[x] );
+
+	parallelRows( 0, height, ClaheApplyBand<T>( src, dst, width, height, tilesX, tilesY, &luts[0], &columnTiles[0], &columnWeights[0], binning ) );
+}
+
+} // anonymous namespace
+
+void histogram( const Channel8u &channel, uint32_t *histogram )
+{
+	histogramImpl( channelPlane( channel ), channel.getWidth(), channel.getHeight(), Binning<uint8_t>(), &histogram );
+}
+
+void histogram( const Channel32f &channel, uint32_t *histogram, int32_t numBins, float minValue, float maxValue )
+{
+	histogramImpl( channelPlane( channel ), channel.getWidth(), channel.getHeight(), Binning<float>( numBins, minValue, maxValue ), &histogram );
+}
+
+void histogram( const Surface8u &surface, uint32_t *red, uint32_t *green, uint32_t *blue )
+{
+	uint32_t *results[3] = { red, green, blue };
+	histogramImpl( surfacePlane( surface ), surface.getWidth(), surface.getHeight(), Binning<uint8_t>(), results );
+}
+
+void histogram( const Surface32f &surface, uint32_t *red, uint32_t *green, uint32_t *blue, int32_t numBins, float minValue, float maxValue )
+{
+	uint32_t *results[3] = { red, green, blue };
+	histogramImpl( surfacePlane( surface ), surface.getWidth(), surface.getHeight(), Binning<float>( numBins, minValue, maxValue ), results );
+}
+
+void equalizeHistogram( const Channel8u &srcChannel, Channel8u *dstChannel )
+{
+	equalizeImpl( channelPlane( srcChannel ), channelPlane( *dstChannel ), std::min( srcChannel.getWidth(), dstChannel->getWidth() ),
+		std::min( srcChannel.getHeight(), dstChannel->getHeight() ), Binning<uint8_t>() );
+}
+
+void equalizeHistogram( const Channel32f &srcChannel, Channel32f *dstChannel, int32_t numBins, float minValue, float maxValue )
+{
+	equalizeImpl( channelPlane( srcChannel ), channelPlane( *dstChannel ), std::min( srcChannel.getWidth(), dstChannel->getWidth() ),
+		std::min( srcChannel.getHeight(), dstChannel->getHeight() ), Binning<float>( numBins, minValue, maxValue ) );
+}
+
+void equalizeHistogram( const Surface8u &srcSurface, Surface8u *dstSurface )
+{
+	equalizeImpl( surfacePlane( srcSurface ), surfacePlane( *dstSurface ), std::min( srcSurface.getWidth(), dstSurface->getWidth() ),
+		std::min( srcSurface.getHeight(), dstSurface->getHeight() ), Binning<uint8_t>() );
+}
+
+void equalizeHistogram( const Surface32f &srcSurface, Surface32f *dstSurface, int32_t numBins, float minValue, float maxValue )
+{
+	equalizeImpl( surfacePlane( srcSurface ), surfacePlane( *dstSurface ), std::min( srcSurface.getWidth(), dstSurface->getWidth() ),
+		std::min( srcSurface.getHeight(), dstSurface->getHeight() ), Binning<float>( numBins, minValue, maxValue ) );
+}
+
+void clahe( const Channel8u &srcChannel, Channel8u *dstChannel, const ClaheOptions &options )
+{
+	claheImpl( srcChannel, dstChannel, options, Binning<uint8_t>() );
+}
+
+void clahe( const Channel32f &srcChannel, Channel32f *dstChannel, const ClaheOptions &options )
+{
+	claheImpl( srcChannel, dstChannel, options, Binning<float>( options.getNumBins(), options.getMinValue(), options.getMaxValue() ) );
+}
+
+} } // namespace cinder::ip
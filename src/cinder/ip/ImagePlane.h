@@ -0,0 +1,46 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+namespace cinder { namespace ip {
+
+// The interleaved channels of a Surface or Channel which a filter reads or writes, independent of its pixel type. Internal to the ip sources.
+struct ImagePlane {
+	ImagePlane( const void *data, int32_t rowBytes, uint8_t pixelInc )
+		: mData( reinterpret_cast<uint8_t*>( const_cast<void*>( data ) ) ), mRowBytes( rowBytes ), mPixelInc( pixelInc ), mNumChannels( 0 )
+	{}
+
+	void	addChannel( uint8_t offset ) { mOffsets[mNumChannels++] = offset; }
+	template<typename T>
+	T*		getRow( int32_t y ) const { return reinterpret_cast<T*>( mData + y * mRowBytes ); }
+
+	uint8_t		*mData;
+	int32_t		mRowBytes;
+	uint8_t		mPixelInc, mNumChannels;
+	uint8_t		mOffsets[4];
+};
+
+} } // namespace cinder::ip
@@ -0,0 +1,213 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/IntegralImage.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include <algorithm>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// Adds \a above to \a row, \a count entries
+template<typename T>
+void addRow( T *row, const T *above, int32_t count, bool /*simd*/ )
+{
+	for( int32_t x = 0; x < count; ++x )
+		row[x] += above[x];
+}
+
+#if defined( CINDER_SSE2 )
+
+template<>
+void addRow<uint32_t>( uint32_t *row, const uint32_t *above, int32_t count, bool simd )
+{
+	int32_t x = 0;
+	if( simd ) {
+		for( ; x + 4 <= count; x += 4 )
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( row + x ), _mm_add_epi32( _mm_loadu_si128( reinterpret_cast<__m128i*>( row + x ) ), _mm_loadu_si128( reinterpret_cast<const __m128i*>( above + x ) ) ) );
+	}
+	for( ; x < count; ++x )
+		row[x] += above[x];
+}
+
+template<>
+void addRow<uint64_t>( uint64_t *row, const uint64_t *above, int32_t count, bool simd )
+{
+	int32_t x = 0;
+	if( simd ) {
+		for( ; x + 2 <= count; x += 2 )
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( row + x ), _mm_add_epi64( _mm_loadu_si128( reinterpret_cast<__m128i*>( row + x ) ), _mm_loadu_si128( reinterpret_cast<const __m128i*>( above + x ) ) ) );
+	}
+	for( ; x < count; ++x )
+		row[x] += above[x];
+}
+
+template<>
+void addRow<double>( double *row, const double *above, int32_t count, bool simd )
+{
+	int32_t x = 0;
+	if( simd ) {
+		for( ; x + 2 <= count; x += 2 )
+			_mm_storeu_pd( row + x, _mm_add_pd( _mm_loadu_pd( row + x ), _mm_loadu_pd( above + x ) ) );
+	}
+	for( ; x < count; ++x )
+		row[x] += above[x];
+}
+
+#endif // defined( CINDER_SSE2 )
+
+// First pass: the prefix sum of each row of the Channel, written one row and column into the table
+template<typename Y, typename T>
+class RowPass {
+  public:
+	RowPass( const ChannelT<Y> *channel, T *sums, double *squares )
+		: mChannel( channel ), mSums( sums ), mSquares( squares )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t width = mChannel->getWidth(), stride = width + 1;
+		const uint8_t increment = mChannel->getIncrement();
+		for( int32_t y = y1; y < y2; ++y ) {
+			const Y *src = mChannel->getData( 0, y );
+			T *sums = mSums + ( y + 1 ) * stride;
+			T sum = 0;
+			sums[0] = 0;
+			for( int32_t x = 0; x < width; ++x ) {
+				sum += src[x * increment];
+				sums[x + 1] = sum;
+			}
+			if( mSquares ) {
+				double *squares = mSquares + ( y + 1 ) * stride;
+				double squareSum = 0;
+				squares[0] = 0;
+				for( int32_t x = 0; x < width; ++x ) {
+					const double v = src[x * increment];
+					squareSum += v * v;
+					squares[x + 1] = squareSum;
+				}
+			}
+		}
+	}
+
+  private:
+	const ChannelT<Y>	*mChannel;
+	T					*mSums;
+	double				*mSquares;
+};
+
+// Second pass: accumulates the row sums down a band of columns. parallelRows() supplies column bands here rather than row bands.
+template<typename T>
+class ColumnPass {
+  public:
+	ColumnPass( T *table, int32_t stride, int32_t rows )
+		: mTable( table ), mStride( stride ), mRows( rows ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t x1, int32_t x2 ) const
+	{
+		for( int32_t y = 2; y < mRows; ++y )
+			addRow( mTable + y * mStride + x1, mTable + ( y - 1 ) * mStride + x1, x2 - x1, mSimd );
+	}
+
+  private:
+	T			*mTable;
+	int32_t		mStride, mRows;
+	bool		mSimd;
+};
+
+} // anonymous namespace
+
+template<typename T>
+template<typename Y>
+IntegralImageT<T>::IntegralImageT( const ChannelT<Y> &channel, bool squares )
+	: mObj( new Obj )
+{
+	mObj->mHasSquares = squares;
+	update( channel );
+}
+
+template<typename T>
+template<typename Y>
+void IntegralImageT<T>::update( const ChannelT<Y> &channel )
+{
+	const int32_t width = channel.getWidth(), height = channel.getHeight();
+	const int32_t stride = width + 1, rows = height + 1;
+	mObj->mWidth = width;
+	mObj->mHeight = height;
+	mObj->mSums.resize( stride * rows );
+	std::fill( mObj->mSums.begin(), mObj->mSums.begin() + stride, T( 0 ) );
+	if( mObj->mHasSquares ) {
+		mObj->mSquares.resize( stride * rows );
+		std::fill( mObj->mSquares.begin(), mObj->mSquares.begin() + stride, 0.0 );
+	}
+	
+	double *squares = ( mObj->mHasSquares ) ? &mObj->mSquares[0] : 0;
+	parallelRows( 0, height, RowPass<Y,T>( &channel, &mObj->mSums[0], squares ) );
+	// columns are independent in the second pass; bands narrower than a few cache lines would share lines between threads
+	parallelRows( 0, stride, ColumnPass<T>( &mObj->mSums[0], stride, rows ), 64 );
+	if( squares )
+		parallelRows( 0, stride, ColumnPass<double>( squares, stride, rows ), 64 );
+}
+
+template<typename T>
+void IntegralImageT<T>::sum( const Area *areas, size_t count, T *results ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		results[i] = sum( areas[i] );
+}
+
+template<typename T>
+void IntegralImageT<T>::mean( const Area *areas, size_t count, double *results ) const
+{
+	for( size_t i = 0; i < count; ++i )
+		results[i] = mean( areas[i] );
+}
+
+template<typename T>
+void IntegralImageT<T>::variance( const Area *areas, size_t count, double *results ) const
+{
+	if( ! mObj->mHasSquares )
+		throw IntegralImageExc();
+	for( size_t i = 0; i < count; ++i )
+		results[i] = variance( areas[i] );
+}
+
+template class IntegralImageT<uint32_t>;
+template class IntegralImageT<uint64_t>;
+template class IntegralImageT<double>;
+
+template IntegralImageT<uint32_t>::IntegralImageT( const Channel8u &channel, bool squares );
+template IntegralImageT<uint64_t>::IntegralImageT( const Channel8u &channel, bool squares );
+template IntegralImageT<double>::IntegralImageT( const Channel8u &channel, bool squares );
+template IntegralImageT<double>::IntegralImageT( const Channel32f &channel, bool squares );
+template void IntegralImageT<uint32_t>::update( const Channel8u &channel );
+template void IntegralImageT<uint64_t>::update( const Channel8u &channel );
+template void IntegralImageT<double>::update( const Channel8u &channel );
+template void IntegralImageT<double>::update( const Channel32f &channel );
+
+} } // namespace cinder::ip
@@ -0,0 +1,302 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Label.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderMath.h"
+
+#include <limits>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// Returns the root of \a label, halving the path to it
+inline uint32_t findRoot( uint32_t *parent, uint32_t label )
+{
+	while( parent[label] != label ) {
+		parent[label] = parent[parent[label]];
+		label = parent[label];
+	}
+	return label;
+}
+
+// Joins the sets of \a a and \a b and returns the root, which is always the smaller label so that roots stay in scan order
+inline uint32_t unite( uint32_t *parent, uint32_t a, uint32_t b )
+{
+	a = findRoot( parent, a );
+	b = findRoot( parent, b );
+	if( a < b ) {
+		parent[b] = a;
+		return a;
+	}
+	parent[a] = b;
+	return b;
+}
+
+struct StatsSum {
+	StatsSum()
+		: mArea( 0 ), mSumX( 0 ), mSumY( 0 ), mSumXX( 0 ), mSumYY( 0 ), mSumXY( 0 ), mEdges( 0 ),
+		mX1( std::numeric_limits<int32_t>::max() ), mY1( std::numeric_limits<int32_t>::max() ), mX2( 0 ), mY2( 0 )
+	{}
+
+	void add( const StatsSum &rhs )
+	{
+		mArea += rhs.mArea;
+		mSumX += rhs.mSumX; mSumY += rhs.mSumY;
+		mSumXX += rhs.mSumXX; mSumYY += rhs.mSumYY; mSumXY += rhs.mSumXY;
+		mEdges += rhs.mEdges;
+		mX1 = std::min( mX1, rhs.mX1 ); mY1 = std::min( mY1, rhs.mY1 );
+		mX2 = std::max( mX2, rhs.mX2 ); mY2 = std::max( mY2, rhs.mY2 );
+	}
+
+	uint64_t	mArea, mSumX, mSumY, mSumXX, mSumYY, mSumXY, mEdges;
+	int32_t		mX1, mY1, mX2, mY2;
+};
+
+// A band of rows labeled on its own. Its labels are compacted to 1 through mCount, which become mBase + 1 through mBase + mCount once the Tiles are merged.
+struct Tile {
+	int32_t					mY1, mY2;
+	uint32_t				mCount, mBase;
+	std::vector<StatsSum>	mStats; // indexed by the Tile's own labels
+};
+
+// First pass: labels each Tile with union-find, then rewrites its labels to the Tile's compacted roots while its rows are still in cache
+class TileLabelBand {
+  public:
+	TileLabelBand( const Channel8u *src, Channel32u *labels, int32_t width, std::vector<Tile> *tiles, uint8_t threshold, bool eightConnected )
+		: mSrc( src ), mLabels( labels ), mWidth( width ), mTiles( tiles ), mThreshold( threshold ), mEightConnected( eightConnected )
+	{}
+
+	void operator()( int32_t t1, int32_t t2 ) const
+	{
+		std::vector<uint32_t> parent, compact;
+		for( int32_t t = t1; t < t2; ++t ) {
+			Tile &tile = (*mTiles)[t];
+			parent.assign( 1, 0 );
+			for( int32_t y = tile.mY1; y < tile.mY2; ++y )
+				labelRow( y, ( y > tile.mY1 ), &parent );
+
+			compact.resize( parent.size() );
+			compact[0] = 0;
+			uint32_t count = 0;
+			for( uint32_t l = 1; l < parent.size(); ++l )
+				compact[l] = ( parent[l] == l ) ? ++count : compact[findRoot( &parent[0], l )];
+			tile.mCount = count;
+
+			const int8_t inc = mLabels->getIncrement();
+			for( int32_t y = tile.mY1; y < tile.mY2; ++y ) {
+				uint32_t *row = mLabels->getData( 0, y );
+				for( int32_t x = 0; x < mWidth; ++x )
+					row[x * inc] = compact[row[x * inc]];
+			}
+		}
+	}
+
+  private:
+	void labelRow( int32_t y, bool hasAbove, std::vector<uint32_t> *parent ) const
+	{
+		const uint8_t *src = mSrc->getData( 0, y );
+		const int8_t srcInc = mSrc->getIncrement(), inc = mLabels->getIncrement();
+		uint32_t *row = mLabels->getData( 0, y );
+		const uint32_t *above = ( hasAbove ) ? mLabels->getData( 0, y - 1 ) : 0;
+		for( int32_t x = 0; x < mWidth; ++x ) {
+			if( src[x * srcInc] <= mThreshold ) {
+				row[x * inc] = 0;
+				continue;
+			}
+
+			const uint32_t west = ( x > 0 ) ? row[( x - 1 ) * inc] : 0;
+			const uint32_t north = ( above ) ? above[x * inc] : 0;
+			uint32_t l;
+			if( mEightConnected ) {
+				// north touches both northwest and northeast, and west touches northwest, so those pairs are already joined
+				if( north )
+					l = north;
+				else {
+					const uint32_t northWest = ( above && ( x > 0 ) ) ? above[( x - 1 ) * inc] : 0;
+					const uint32_t northEast = ( above && ( x + 1 < mWidth ) ) ? above[( x + 1 ) * inc] : 0;
+					l = ( west ) ? west : northWest;
+					if( northEast )
+						l = ( l ) ? unite( &(*parent)[0], l, northEast ) : northEast;
+				}
+			}
+			else {
+				if( west && north )
+					l = unite( &(*parent)[0], west, north );
+				else
+					l = ( west ) ? west : north;
+			}
+
+			if( ! l ) {
+				l = static_cast<uint32_t>( parent->size() );
+				parent->push_back( l );
+			}
+			row[x * inc] = l;
+		}
+	}
+
+	const Channel8u		*mSrc;
+	Channel32u			*mLabels;
+	int32_t				mWidth;
+	std::vector<Tile>	*mTiles;
+	uint8_t				mThreshold;
+	bool				mEightConnected;
+};
+
+// Second pass: rewrites each Tile's labels to the final labels, optionally gathering each component's statistics for the Tile
+class TileRelabelBand {
+  public:
+	TileRelabelBand( const Channel8u *src, Channel32u *labels, int32_t width, int32_t height, std::vector<Tile> *tiles, const uint32_t *finalLabels, uint8_t threshold, bool gatherStats )
+		: mSrc( src ), mLabels( labels ), mWidth( width ), mHeight( height ), mTiles( tiles ), mFinalLabels( finalLabels ), mThreshold( threshold ), mGatherStats( gatherStats )
+	{}
+
+	void operator()( int32_t t1, int32_t t2 ) const
+	{
+		const int8_t srcInc = mSrc->getIncrement(), inc = mLabels->getIncrement();
+		for( int32_t t = t1; t < t2; ++t ) {
+			Tile &tile = (*mTiles)[t];
+			if( mGatherStats )
+				tile.mStats.assign( tile.mCount + 1, StatsSum() );
+			for( int32_t y = tile.mY1; y < tile.mY2; ++y ) {
+				uint32_t *row = mLabels->getData( 0, y );
+				const uint8_t *src = mSrc->getData( 0, y );
+				const uint8_t *srcAbove = ( y > 0 ) ? mSrc->getData( 0, y - 1 ) : 0;
+				const uint8_t *srcBelow = ( y + 1 < mHeight ) ? mSrc->getData( 0, y + 1 ) : 0;
+				for( int32_t x = 0; x < mWidth; ++x ) {
+					const uint32_t l = row[x * inc];
+					if( ! l )
+						continue;
+					row[x * inc] = mFinalLabels[tile.mBase + l];
+					if( ! mGatherStats )
+						continue;
+
+					StatsSum &s = tile.mStats[l];
+					s.mArea++;
+					s.mSumX += x; s.mSumY += y;
+					s.mSumXX += (uint64_t)x * x; s.mSumYY += (uint64_t)y * y; s.mSumXY += (uint64_t)x * y;
+					s.mX1 = std::min( s.mX1, x ); s.mX2 = std::max( s.mX2, x + 1 );
+					s.mY1 = std::min( s.mY1, y ); s.mY2 = std::max( s.mY2, y + 1 );
+					s.mEdges += ( ( x == 0 ) || ( src[( x - 1 ) * srcInc] <= mThreshold ) ) ? 1 : 0;
+					s.mEdges += ( ( x + 1 == mWidth ) || ( src[( x + 1 ) * srcInc] <= mThreshold ) ) ? 1 : 0;
+					s.mEdges += ( ( ! srcAbove ) || ( srcAbove[x * srcInc] <= mThreshold ) ) ? 1 : 0;
+					s.mEdges += ( ( ! srcBelow ) || ( srcBelow[x * srcInc] <= mThreshold ) ) ? 1 : 0;
+				}
+			}
+		}
+	}
+
+  private:
+	const Channel8u		*mSrc;
+	Channel32u			*mLabels;
+	int32_t				mWidth, mHeight;
+	std::vector<Tile>	*mTiles;
+	const uint32_t		*mFinalLabels;
+	uint8_t				mThreshold;
+	bool				mGatherStats;
+};
+
+} // anonymous namespace
+
+uint32_t label( const Channel8u &srcChannel, Channel32u *labels, std::vector<BlobStats> *stats, const LabelOptions &options )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), labels->getWidth() ), height = std::min( srcChannel.getHeight(), labels->getHeight() );
+	if( stats )
+		stats->clear();
+	if( ( width <= 0 ) || ( height <= 0 ) )
+		return 0;
+	const bool eightConnected = options.getConnectivity() != 4;
+	const int32_t tileHeight = std::max<int32_t>( options.getTileHeight(), 1 );
+
+	std::vector<Tile> tiles( ( height + tileHeight - 1 ) / tileHeight );
+	for( size_t t = 0; t < tiles.size(); ++t ) {
+		tiles[t].mY1 = (int32_t)t * tileHeight;
+		tiles[t].mY2 = std::min( tiles[t].mY1 + tileHeight, height );
+	}
+	parallelRows( 0, (int32_t)tiles.size(), TileLabelBand( &srcChannel, labels, width, &tiles, options.getThreshold(), eightConnected ), 1 );
+
+	uint32_t total = 0;
+	for( size_t t = 0; t < tiles.size(); ++t ) {
+		tiles[t].mBase = total;
+		total += tiles[t].mCount;
+	}
+
+	// join the components which touch across each border between Tiles
+	std::vector<uint32_t> parent( total + 1 );
+	for( uint32_t l = 0; l <= total; ++l )
+		parent[l] = l;
+	const int8_t inc = labels->getIncrement();
+	for( size_t t = 1; t < tiles.size(); ++t ) {
+		const uint32_t *row = labels->getData( 0, tiles[t].mY1 ), *above = labels->getData( 0, tiles[t].mY1 - 1 );
+		const uint32_t base = tiles[t].mBase, aboveBase = tiles[t - 1].mBase;
+		for( int32_t x = 0; x < width; ++x ) {
+			const uint32_t l = row[x * inc];
+			if( ! l )
+				continue;
+			if( above[x * inc] )
+				unite( &parent[0], base + l, aboveBase + above[x * inc] );
+			if( eightConnected ) {
+				if( ( x > 0 ) && above[( x - 1 ) * inc] )
+					unite( &parent[0], base + l, aboveBase + above[( x - 1 ) * inc] );
+				if( ( x + 1 < width ) && above[( x + 1 ) * inc] )
+					unite( &parent[0], base + l, aboveBase + above[( x + 1 ) * inc] );
+			}
+		}
+	}
+
+	// roots are the smallest labels of their sets, so numbering them in order numbers the components in scan order
+	std::vector<uint32_t> finalLabels( total + 1 );
+	uint32_t count = 0;
+	finalLabels[0] = 0;
+	for( uint32_t l = 1; l <= total; ++l )
+		finalLabels[l] = ( parent[l] == l ) ? ++count : finalLabels[findRoot( &parent[0], l )];
+
+	parallelRows( 0, (int32_t)tiles.size(), TileRelabelBand( &srcChannel, labels, width, height, &tiles, &finalLabels[0], options.getThreshold(), stats != 0 ), 1 );
+
+	if( stats ) {
+		std::vector<StatsSum> sums( count );
+		for( size_t t = 0; t < tiles.size(); ++t )
+			for( uint32_t l = 1; l <= tiles[t].mCount; ++l )
+				sums[finalLabels[tiles[t].mBase + l] - 1].add( tiles[t].mStats[l] );
+
+		stats->resize( count );
+		for( uint32_t i = 0; i < count; ++i ) {
+			const StatsSum &s = sums[i];
+			BlobStats &result = (*stats)[i];
+			const double invArea = 1.0 / s.mArea;
+			const double meanX = s.mSumX * invArea, meanY = s.mSumY * invArea;
+			result.mLabel = i + 1;
+			result.mArea = (uint32_t)s.mArea;
+			result.mBounds = Area( s.mX1, s.mY1, s.mX2, s.mY2 );
+			result.mCentroid = Vec2f( (float)( meanX + 0.5 ), (float)( meanY + 0.5 ) );
+			result.mMu20 = (float)( s.mSumXX * invArea - meanX * meanX );
+			result.mMu02 = (float)( s.mSumYY * invArea - meanY * meanY );
+			result.mMu11 = (float)( s.mSumXY * invArea - meanX * meanY );
+			result.mPerimeter = (float)( s.mEdges * M_PI / 4 );
+		}
+	}
+
+	return count;
+}
+
+} } // namespace cinder::ip
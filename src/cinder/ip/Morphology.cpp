@@ -0,0 +1,291 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Morphology.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include <vector>
+#include <limits>
+#include <cstring>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+struct MinOp {
+	template<typename T>
+	static T	identity() { return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+	template<typename T>
+	static T	apply( T a, T b ) { return ( b < a ) ? b : a; }
+};
+
+struct MaxOp {
+	template<typename T>
+	static T	identity() { return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::min(); }
+	template<typename T>
+	static T	apply( T a, T b ) { return ( a < b ) ? b : a; }
+};
+
+#if defined( CINDER_SSE2 )
+inline __m128i	loadu( const uint8_t *p ) { return _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) ); }
+inline __m128	loadu( const float *p ) { return _mm_loadu_ps( p ); }
+inline void		storeu( uint8_t *p, __m128i v ) { _mm_storeu_si128( reinterpret_cast<__m128i*>( p ), v ); }
+inline void		storeu( float *p, __m128 v ) { _mm_storeu_ps( p, v ); }
+inline __m128i	simdApply( MinOp, __m128i a, __m128i b ) { return _mm_min_epu8( a, b ); }
+inline __m128i	simdApply( MaxOp, __m128i a, __m128i b ) { return _mm_max_epu8( a, b ); }
+inline __m128	simdApply( MinOp, __m128 a, __m128 b ) { return _mm_min_ps( a, b ); }
+inline __m128	simdApply( MaxOp, __m128 a, __m128 b ) { return _mm_max_ps( a, b ); }
+#endif
+
+// out[x] = OP( a[x], b[x] ); \a out may be \a a or \a b
+template<typename OP, typename T>
+void combineRows( T *out, const T *a, const T *b, int32_t count, bool simd )
+{
+	int32_t x = 0;
+#if defined( CINDER_SSE2 )
+	if( simd ) {
+		const int32_t lanes = 16 / sizeof(T);
+		for( ; x + lanes <= count; x += lanes )
+			storeu( out + x, simdApply( OP(), loadu( a + x ), loadu( b + x ) ) );
+	}
+#endif
+	for( ; x < count; ++x )
+		out[x] = OP::apply( a[x], b[x] );
+}
+
+// The extreme of each window [x - size / 2, x - size / 2 + size) of the \a width values of \a src, spaced \a inc apart. The padded values are split into blocks
+// of \a size; \a g and \a h hold the running extremes from the start and end of each block, so every window is the combination of one entry of each.
+template<typename OP, typename T>
+void vhgwRow( const T *src, int8_t inc, int32_t width, int32_t size, T *dst, T *g, T *h )
+{
+	const T identity = OP::template identity<T>();
+	const int32_t anchor = size / 2, padded = ( width + 2 * ( size - 1 ) ) / size * size;
+	for( int32_t start = 0; start < padded; start += size ) {
+		T extreme = identity;
+		for( int32_t i = start; i < start + size; ++i ) {
+			const int32_t x = i - anchor;
+			extreme = OP::apply( extreme, ( ( x >= 0 ) && ( x < width ) ) ? src[x * inc] : identity );
+			g[i] = extreme;
+		}
+		extreme = identity;
+		for( int32_t i = start + size - 1; i >= start; --i ) {
+			const int32_t x = i - anchor;
+			extreme = OP::apply( extreme, ( ( x >= 0 ) && ( x < width ) ) ? src[x * inc] : identity );
+			h[i] = extreme;
+		}
+	}
+
+	for( int32_t x = 0; x < width; ++x )
+		dst[x] = OP::apply( h[x], g[x + size - 1] );
+}
+
+// Length of the scratch rows vhgwRow() requires
+inline int32_t vhgwLength( int32_t width, int32_t size )
+{
+	return ( width + 2 * ( size - 1 ) ) / size * size;
+}
+
+// 3x3 kernels on contiguous rows: the extreme of three rows, then of three neighboring columns, a vector at a time
+template<typename T, typename OP>
+class Morph3x3Band {
+  public:
+	Morph3x3Band( const ChannelT<T> *src, ChannelT<T> *dst, int32_t width )
+		: mSrc( src ), mDst( dst ), mWidth( width ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		// clamping to the edge gives the same extremes as clipping the kernel
+		const int32_t srcWidth = mSrc->getWidth(), lastRow = mSrc->getHeight() - 1;
+		std::vector<T> buffer( srcWidth + 2 );
+		T *columns = &buffer[1];
+		for( int32_t y = y1; y < y2; ++y ) {
+			combineRows<OP>( columns, mSrc->getData( 0, std::max( y - 1, 0 ) ), mSrc->getData( 0, y ), srcWidth, mSimd );
+			combineRows<OP>( columns, columns, mSrc->getData( 0, std::min( y + 1, lastRow ) ), srcWidth, mSimd );
+			buffer[0] = buffer[1];
+			buffer[srcWidth + 1] = buffer[srcWidth];
+
+			T *dst = mDst->getData( 0, y );
+			combineRows<OP>( dst, &buffer[0], &buffer[1], mWidth, mSimd );
+			combineRows<OP>( dst, dst, &buffer[2], mWidth, mSimd );
+		}
+	}
+
+  private:
+	const ChannelT<T>	*mSrc;
+	ChannelT<T>			*mDst;
+	int32_t				mWidth;
+	bool				mSimd;
+};
+
+// First pass: the horizontal extremes of each row into a contiguous Channel the size of the source
+template<typename T, typename OP>
+class HorizontalBand {
+  public:
+	HorizontalBand( const ChannelT<T> *src, ChannelT<T> *dst, int32_t size )
+		: mSrc( src ), mDst( dst ), mSize( size )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t width = mSrc->getWidth();
+		std::vector<T> g( vhgwLength( width, mSize ) ), h( g.size() );
+		for( int32_t y = y1; y < y2; ++y )
+			vhgwRow<OP>( mSrc->getData( 0, y ), mSrc->getIncrement(), width, mSize, mDst->getData( 0, y ), &g[0], &h[0] );
+	}
+
+  private:
+	const ChannelT<T>	*mSrc;
+	ChannelT<T>			*mDst;
+	int32_t				mSize;
+};
+
+// Second pass: van Herk/Gil-Werman down the columns, with whole rows combined at a time. A block of backward extremes is kept while the forward extremes of the next block are accumulated in a single row.
+template<typename T, typename OP>
+class VerticalBand {
+  public:
+	VerticalBand( const ChannelT<T> *src, ChannelT<T> *dst, int32_t width, int32_t size )
+		: mSrc( src ), mDst( dst ), mWidth( width ), mSize( size ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t srcWidth = mSrc->getWidth(), rows = y2 - y1;
+		std::vector<T> block( mSize * srcWidth ), forward( srcWidth ), identity( srcWidth, OP::template identity<T>() ), output( mWidth );
+		for( int32_t start = 0; start < rows; start += mSize ) {
+			std::memcpy( &block[( mSize - 1 ) * srcWidth], getRow( y1, start + mSize - 1, &identity[0] ), srcWidth * sizeof(T) );
+			for( int32_t j = mSize - 2; j >= 0; --j )
+				combineRows<OP>( &block[j * srcWidth], &block[( j + 1 ) * srcWidth], getRow( y1, start + j, &identity[0] ), srcWidth, mSimd );
+
+			// the window of the block's first row is the block itself
+			T *dst = getDstRow( y1 + start, &output[0] );
+			std::memcpy( dst, &block[0], mWidth * sizeof(T) );
+			finishRow( y1 + start, dst );
+
+			for( int32_t j = 0; ( j < mSize - 1 ) && ( start + j + 1 < rows ); ++j ) {
+				const T *next = getRow( y1, start + mSize + j, &identity[0] );
+				if( j == 0 )
+					std::memcpy( &forward[0], next, srcWidth * sizeof(T) );
+				else
+					combineRows<OP>( &forward[0], &forward[0], next, srcWidth, mSimd );
+				dst = getDstRow( y1 + start + j + 1, &output[0] );
+				combineRows<OP>( dst, &block[( j + 1 ) * srcWidth], &forward[0], mWidth, mSimd );
+				finishRow( y1 + start + j + 1, dst );
+			}
+		}
+	}
+
+  private:
+	// Returns padded row \a i of the band starting at \a y1, or \a identity outside the source
+	const T*	getRow( int32_t y1, int32_t i, const T *identity ) const
+	{
+		const int32_t y = y1 + i - mSize / 2;
+		return ( ( y >= 0 ) && ( y < mSrc->getHeight() ) ) ? mSrc->getData( 0, y ) : identity;
+	}
+	// Rows of a destination which isn't contiguous are written to \a output first
+	T*			getDstRow( int32_t y, T *output ) const { return ( mDst->getIncrement() == 1 ) ? mDst->getData( 0, y ) : output; }
+	void		finishRow( int32_t y, const T *row ) const
+	{
+		const int8_t inc = mDst->getIncrement();
+		if( inc != 1 ) {
+			T *dst = mDst->getData( 0, y );
+			for( int32_t x = 0; x < mWidth; ++x, dst += inc )
+				*dst = row[x];
+		}
+	}
+
+	const ChannelT<T>	*mSrc;
+	ChannelT<T>			*mDst;
+	int32_t				mWidth, mSize;
+	bool				mSimd;
+};
+
+template<typename T>
+bool overlaps( const ChannelT<T> &a, const ChannelT<T> &b )
+{
+	const uint8_t *aBegin = reinterpret_cast<const uint8_t*>( a.getData() ), *aEnd = reinterpret_cast<const uint8_t*>( a.getData( 0, a.getHeight() - 1 ) + a.getWidth() * a.getIncrement() );
+	const uint8_t *bBegin = reinterpret_cast<const uint8_t*>( b.getData() ), *bEnd = reinterpret_cast<const uint8_t*>( b.getData( 0, b.getHeight() - 1 ) + b.getWidth() * b.getIncrement() );
+	return ( aBegin < bEnd ) && ( bBegin < aEnd );
+}
+
+template<typename T, typename OP>
+void morphology( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( ( width <= 0 ) || ( height <= 0 ) )
+		return;
+	const int32_t sizeX = std::max<int32_t>( kernelSize.x, 1 ), sizeY = std::max<int32_t>( kernelSize.y, 1 );
+
+	if( ( sizeX == 3 ) && ( sizeY == 3 ) && ( srcChannel.getIncrement() == 1 ) && ( dstChannel->getIncrement() == 1 ) && ( ! overlaps( srcChannel, *dstChannel ) ) )
+		parallelRows( 0, height, Morph3x3Band<T,OP>( &srcChannel, dstChannel, width ) );
+	else {
+		// the intermediate Channel also makes it safe for the destination to be the source
+		ChannelT<T> horizontal( srcChannel.getWidth(), srcChannel.getHeight() );
+		parallelRows( 0, srcChannel.getHeight(), HorizontalBand<T,OP>( &srcChannel, &horizontal, sizeX ) );
+		// each band reads size - 1 rows beyond its own
+		parallelRows( 0, height, VerticalBand<T,OP>( &horizontal, dstChannel, width, sizeY ), std::max<int32_t>( sizeY, 16 ) );
+	}
+}
+
+} // anonymous namespace
+
+template<typename T>
+void erode( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize )
+{
+	morphology<T,MinOp>( srcChannel, dstChannel, kernelSize );
+}
+
+template<typename T>
+void dilate( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize )
+{
+	morphology<T,MaxOp>( srcChannel, dstChannel, kernelSize );
+}
+
+template<typename T>
+void open( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize )
+{
+	ChannelT<T> eroded( srcChannel.getWidth(), srcChannel.getHeight() );
+	morphology<T,MinOp>( srcChannel, &eroded, kernelSize );
+	morphology<T,MaxOp>( eroded, dstChannel, kernelSize );
+}
+
+template<typename T>
+void close( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize )
+{
+	ChannelT<T> dilated( srcChannel.getWidth(), srcChannel.getHeight() );
+	morphology<T,MaxOp>( srcChannel, &dilated, kernelSize );
+	morphology<T,MinOp>( dilated, dstChannel, kernelSize );
+}
+
+#define morphology_PROTOTYPES(r,data,T)\
+	template void erode( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize ); \
+	template void dilate( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize ); \
+	template void open( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize ); \
+	template void close( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Vec2i &kernelSize );
+
+BOOST_PP_SEQ_FOR_EACH( morphology_PROTOTYPES, ~, (uint8_t)(float) )
+
+} } // namespace cinder::ip
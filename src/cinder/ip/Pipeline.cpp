@@ -0,0 +1,352 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Pipeline.h"
+#include "cinder/ip/Grayscale.h"
+#include "cinder/ip/Threshold.h"
+#include "cinder/ip/EdgeDetect.h"
+#include "cinder/ip/Morphology.h"
+#include "cinder/ip/Flip.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/ChanTraits.h"
+
+#include <algorithm>
+
+namespace cinder { namespace ip {
+
+Pipeline& Pipeline::grayscale()
+{
+	mStages.push_back( Stage( GRAYSCALE ) );
+	return *this;
+}
+
+Pipeline& Pipeline::threshold( float value )
+{
+	mStages.push_back( Stage( THRESHOLD, value ) );
+	return *this;
+}
+
+Pipeline& Pipeline::edgeDetectSobel()
+{
+	mStages.push_back( Stage( EDGE_DETECT_SOBEL ) );
+	return *this;
+}
+
+Pipeline& Pipeline::erode( const Vec2i &kernelSize )
+{
+	mStages.push_back( Stage( ERODE, 0, kernelSize ) );
+	return *this;
+}
+
+Pipeline& Pipeline::dilate( const Vec2i &kernelSize )
+{
+	mStages.push_back( Stage( DILATE, 0, kernelSize ) );
+	return *this;
+}
+
+Pipeline& Pipeline::flipVertical()
+{
+	mStages.push_back( Stage( FLIP_VERTICAL ) );
+	return *this;
+}
+
+namespace {
+
+enum Type { UINT8, FLOAT32 };
+
+// Rows of an image of either type, held in the member of its type. Row mY1 of the image is the first row of the Surface or Channel.
+struct Image {
+	Image() : mType( UINT8 ), mIsSurface( false ), mY1( 0 ) {}
+
+	void set( const Surface8u &surface ) { mSurface8u = surface; mType = UINT8; mIsSurface = true; }
+	void set( const Surface32f &surface ) { mSurface32f = surface; mType = FLOAT32; mIsSurface = true; }
+	void set( const Channel8u &channel ) { m8u = channel; mType = UINT8; mIsSurface = false; }
+	void set( const Channel32f &channel ) { m32f = channel; mType = FLOAT32; mIsSurface = false; }
+
+	int32_t	getWidth() const;
+	//! Returns the rows [y1, y2) of the image, which share the pixels of these
+	Image	getRows( int32_t y1, int32_t y2 ) const;
+
+	Surface8u		mSurface8u;
+	Surface32f		mSurface32f;
+	Channel8u		m8u;
+	Channel32f		m32f;
+	Type			mType;
+	bool			mIsSurface;
+	int32_t			mY1;
+};
+
+int32_t Image::getWidth() const
+{
+	if( mIsSurface )
+		return ( mType == UINT8 ) ? mSurface8u.getWidth() : mSurface32f.getWidth();
+	else
+		return ( mType == UINT8 ) ? m8u.getWidth() : m32f.getWidth();
+}
+
+Image Image::getRows( int32_t y1, int32_t y2 ) const
+{
+	const Area area( 0, y1 - mY1, getWidth(), y2 - mY1 );
+	Image result;
+	if( mIsSurface && mType == UINT8 )
+		result.set( mSurface8u.getSubSurface( area ) );
+	else if( mIsSurface )
+		result.set( mSurface32f.getSubSurface( area ) );
+	else if( mType == UINT8 )
+		result.set( m8u.getSubChannel( area ) );
+	else
+		result.set( m32f.getSubChannel( area ) );
+	result.mY1 = y1;
+
+	return result;
+}
+
+// Returns the types each stage produces from \a source, throwing PipelineExc unless each stage accepts the type of its predecessor
+std::vector<Type> stageTypes( const std::vector<Pipeline::Stage> &stages, const Image &source )
+{
+	if( stages.empty() || ( ( stages[0].mOp == Pipeline::GRAYSCALE ) != source.mIsSurface ) )
+		throw PipelineExc();
+
+	std::vector<Type> result;
+	Type type = source.mType;
+	for( size_t s = 0; s < stages.size(); ++s ) {
+		if( s > 0 && stages[s].mOp == Pipeline::GRAYSCALE )
+			throw PipelineExc();
+		else if( stages[s].mOp == Pipeline::EDGE_DETECT_SOBEL ) {
+			if( type != UINT8 )
+				throw PipelineExc();
+			type = FLOAT32;
+		}
+		result.push_back( type );
+	}
+
+	return result;
+}
+
+// Returns the rows of its input which \a stage needs to produce the rows [y1, y2) of an image \a height rows tall
+std::pair<int32_t,int32_t> inputRows( const Pipeline::Stage &stage, int32_t y1, int32_t y2, int32_t height )
+{
+	switch( stage.mOp ) {
+		case Pipeline::EDGE_DETECT_SOBEL:
+			return std::make_pair( std::max( y1 - 1, 0 ), std::min( y2 + 1, height ) );
+		case Pipeline::ERODE:
+		case Pipeline::DILATE: {
+			// the rectangle is anchored at kernelSize / 2
+			const int32_t above = stage.mKernelSize.y / 2, below = std::max( stage.mKernelSize.y - 1 - above, 0 );
+			return std::make_pair( std::max( y1 - above, 0 ), std::min( y2 + below, height ) );
+		}
+		case Pipeline::FLIP_VERTICAL:
+			return std::make_pair( height - y2, height - y1 );
+		default:
+			return std::make_pair( y1, y2 );
+	}
+}
+
+// Returns the number of rows around a tile which \a stage reads
+int32_t haloRows( const Pipeline::Stage &stage )
+{
+	if( stage.mOp == Pipeline::EDGE_DETECT_SOBEL )
+		return 2;
+	else if( stage.mOp == Pipeline::ERODE || stage.mOp == Pipeline::DILATE )
+		return std::max( stage.mKernelSize.y - 1, 0 );
+	else
+		return 0;
+}
+
+// Copies \a src to \a dst, reversing the order of the rows if \a flip
+template<typename T>
+void copyRows( const ChannelT<T> &src, ChannelT<T> *dst, bool flip )
+{
+	const int32_t width = src.getWidth(), height = src.getHeight();
+	const uint8_t srcInc = src.getIncrement(), dstInc = dst->getIncrement();
+	for( int32_t y = 0; y < height; ++y ) {
+		const T *srcPtr = src.getData( 0, ( flip ) ? height - 1 - y : y );
+		T *dstPtr = dst->getData( 0, y );
+		if( srcInc == 1 && dstInc == 1 )
+			std::copy( srcPtr, srcPtr + width, dstPtr );
+		else {
+			for( int32_t x = 0; x < width; ++x, srcPtr += srcInc, dstPtr += dstInc )
+				*dstPtr = *srcPtr;
+		}
+	}
+}
+
+// Converts a threshold to the type of the values it is compared with
+template<typename T> T thresholdValue( float value ) { return value; }
+template<> uint8_t thresholdValue<uint8_t>( float value ) { return static_cast<uint8_t>( constrain<float>( value, 0, 255 ) ); }
+
+template<typename T>
+void applySameType( const Pipeline::Stage &stage, const ChannelT<T> &src, ChannelT<T> *dst )
+{
+	switch( stage.mOp ) {
+		case Pipeline::THRESHOLD:
+			ip::threshold( src, thresholdValue<T>( stage.mValue ), dst );
+		break;
+		case Pipeline::ERODE:
+			ip::erode( src, dst, stage.mKernelSize );
+		break;
+		case Pipeline::DILATE:
+			ip::dilate( src, dst, stage.mKernelSize );
+		break;
+		case Pipeline::FLIP_VERTICAL:
+			copyRows( src, dst, true );
+		break;
+		default:
+		break;
+	}
+}
+
+// Applies \a stage to the rows \a src, storing the result in the rows \a dst
+void apply( const Pipeline::Stage &stage, const Image &src, Image *dst )
+{
+	if( stage.mOp == Pipeline::GRAYSCALE ) {
+		if( src.mType == UINT8 )
+			ip::grayscale( src.mSurface8u, &dst->m8u );
+		else
+			ip::grayscale( src.mSurface32f, &dst->m32f );
+	}
+	else if( stage.mOp == Pipeline::EDGE_DETECT_SOBEL )
+		ip::edgeDetectSobel( src.m8u, &dst->m32f );
+	else if( src.mType == UINT8 )
+		applySameType( stage, src.m8u, &dst->m8u );
+	else
+		applySameType( stage, src.m32f, &dst->m32f );
+}
+
+// Runs the stages on the tiles [tile1, tile2) of \a src, storing the result in \a dst. Each band keeps a buffer per stage, which it fills
+// with the rows of the tile that stage produces and the rows around the tile which later stages read.
+class TileBand {
+  public:
+	TileBand( const std::vector<Pipeline::Stage> *stages, const std::vector<Type> *types, const Image *src, const Image *dst, int32_t width, int32_t height, int32_t tileRows )
+		: mStages( stages ), mTypes( types ), mSrc( src ), mDst( dst ), mWidth( width ), mHeight( height ), mTileRows( tileRows )
+	{}
+
+	void operator()( int32_t tile1, int32_t tile2 ) const
+	{
+		const size_t numStages = mStages->size();
+		int32_t bufferRows = mTileRows;
+		for( size_t s = 0; s < numStages; ++s )
+			bufferRows += haloRows( (*mStages)[s] );
+		bufferRows = std::min( bufferRows, mHeight );
+
+		std::vector<Image> buffers( numStages );
+		for( size_t s = 0; s < numStages; ++s ) {
+			if( (*mTypes)[s] == UINT8 )
+				buffers[s].set( Channel8u( mWidth, bufferRows ) );
+			else
+				buffers[s].set( Channel32f( mWidth, bufferRows ) );
+		}
+
+		std::vector<std::pair<int32_t,int32_t> > outputs( numStages );
+		for( int32_t tile = tile1; tile < tile2; ++tile ) {
+			const int32_t y1 = tile * mTileRows, y2 = std::min( y1 + mTileRows, mHeight );
+			// the rows each stage must produce, from the last stage back to the first
+			outputs[numStages - 1] = std::make_pair( y1, y2 );
+			for( size_t s = numStages - 1; s > 0; --s )
+				outputs[s - 1] = inputRows( (*mStages)[s], outputs[s].first, outputs[s].second, mHeight );
+
+			Image previous;
+			for( size_t s = 0; s < numStages; ++s ) {
+				const Pipeline::Stage &stage = (*mStages)[s];
+				// a neighborhood operation produces a row for each of its input rows, though those around the tile are valid only at the edges of the image
+				const std::pair<int32_t,int32_t> input = inputRows( stage, outputs[s].first, outputs[s].second, mHeight );
+				const std::pair<int32_t,int32_t> output = ( stage.mOp == Pipeline::FLIP_VERTICAL ) ? outputs[s] : input;
+				// the last stage writes straight to the destination when it produces just the rows of the tile
+				const bool last = ( s + 1 == numStages ), direct = last && ( output == outputs[s] );
+				Image result;
+				if( direct )
+					result = mDst->getRows( y1, y2 );
+				else {
+					buffers[s].mY1 = output.first;
+					result = buffers[s].getRows( output.first, output.second );
+				}
+
+				apply( stage, ( s == 0 ) ? mSrc->getRows( input.first, input.second ) : previous.getRows( input.first, input.second ), &result );
+
+				if( last && ! direct ) {
+					Image src = result.getRows( y1, y2 ), dst = mDst->getRows( y1, y2 );
+					if( src.mType == UINT8 )
+						copyRows( src.m8u, &dst.m8u, false );
+					else
+						copyRows( src.m32f, &dst.m32f, false );
+				}
+				previous = result;
+			}
+		}
+	}
+
+  private:
+	const std::vector<Pipeline::Stage>	*mStages;
+	const std::vector<Type>				*mTypes;
+	const Image							*mSrc, *mDst;
+	int32_t								mWidth, mHeight, mTileRows;
+};
+
+void execute( const std::vector<Pipeline::Stage> &stages, const Image &src, const Image &dst, int32_t width, int32_t height, size_t tileBytes )
+{
+	const std::vector<Type> types = stageTypes( stages, src );
+	if( types.back() != dst.mType )
+		throw PipelineExc();
+	if( width <= 0 || height <= 0 )
+		return;
+
+	// a tile touches a row of the source, at most four channels wide, and of each stage's result for each of its rows
+	size_t rowBytes = width * ( ( src.mType == UINT8 ) ? sizeof(uint8_t) : sizeof(float) ) * ( ( src.mIsSurface ) ? 4 : 1 );
+	for( size_t s = 0; s < types.size(); ++s )
+		rowBytes += width * ( ( types[s] == UINT8 ) ? sizeof(uint8_t) : sizeof(float) );
+	const int32_t tileRows = std::min<int32_t>( std::max<int32_t>( (int32_t)( tileBytes / rowBytes ), 16 ), height );
+
+	parallelRows( 0, ( height + tileRows - 1 ) / tileRows, TileBand( &stages, &types, &src, &dst, width, height, tileRows ), 1 );
+}
+
+} // anonymous namespace
+
+template<typename T, typename Y>
+void Pipeline::run( const SurfaceT<T> &srcSurface, ChannelT<Y> *dstChannel ) const
+{
+	const int32_t width = std::min( srcSurface.getWidth(), dstChannel->getWidth() ), height = std::min( srcSurface.getHeight(), dstChannel->getHeight() );
+	Image src, dst;
+	src.set( srcSurface.getSubSurface( Area( 0, 0, width, height ) ) );
+	dst.set( dstChannel->getSubChannel( Area( 0, 0, width, height ) ) );
+	execute( mStages, src, dst, width, height, mTileBytes );
+}
+
+template<typename T, typename Y>
+void Pipeline::run( const ChannelT<T> &srcChannel, ChannelT<Y> *dstChannel ) const
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() ), height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	Image src, dst;
+	src.set( srcChannel.getSubChannel( Area( 0, 0, width, height ) ) );
+	dst.set( dstChannel->getSubChannel( Area( 0, 0, width, height ) ) );
+	execute( mStages, src, dst, width, height, mTileBytes );
+}
+
+#define pipeline_PROTOTYPES(r,data,T)\
+	template void Pipeline::run( const SurfaceT<T> &srcSurface, ChannelT<uint8_t> *dstChannel ) const; \
+	template void Pipeline::run( const SurfaceT<T> &srcSurface, ChannelT<float> *dstChannel ) const; \
+	template void Pipeline::run( const ChannelT<T> &srcChannel, ChannelT<uint8_t> *dstChannel ) const; \
+	template void Pipeline::run( const ChannelT<T> &srcChannel, ChannelT<float> *dstChannel ) const;
+
+BOOST_PP_SEQ_FOR_EACH( pipeline_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -21,100 +21,298 @@
 */
 
 #include "cinder/ip/Premultiply.h"
+#include "cinder/ip/Parallel.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/SimdDispatch.h"
+
+#include <algorithm>
+#include <boost/thread/once.hpp>
 
 namespace cinder { namespace ip {
 
-// this is a candidate for sse2
-template<typename T>
-void premultiply( SurfaceT<T> *surface )
+namespace {
+
+// The scalar reference for unpremultiplying one value. The basic formula is to divide by the alpha, which in 8-bit
+// arithmetic is to multiply by 255 first; values greater than their alpha aren't truly premultiplied and saturate.
+inline uint8_t unpremultiplyValue( uint8_t c, uint8_t alpha )
 {
-	const Area clippedArea = surface->getBounds();
+	return ( alpha ) ? static_cast<uint8_t>( std::min( c * 255 / alpha, 255 ) ) : c;
+}
 
-	if( ! surface->hasAlpha() )
-		return;
+inline float unpremultiplyValue( float c, float alpha )
+{
+	return ( alpha != 0 ) ? c / alpha : c;
+}
+
+// SIMD row kernels for 4-channel pixels whose alpha lies at offset ALPHA, converting from \a src to \a dst, which may be the same.
+// Each converts as many leading pixels as it can and returns that count; the caller finishes the row with the scalar code.
+typedef int32_t (*PremultRowFunc_u8)( const uint8_t *src, uint8_t *dst, int32_t width );
+typedef int32_t (*PremultRowFunc_float)( const float *src, float *dst, int32_t width );
+
+#if defined( CINDER_SSE2 )
+
+// 255 / alpha for every 8-bit alpha, and 1 for alpha 0 so that transparent pixels pass through unchanged. Built on first use.
+class ReciprocalTable {
+  public:
+	static const ReciprocalTable&	get() { boost::call_once( &ReciprocalTable::build, sOnce ); return sInstance; }
+
+	float	operator[]( uint8_t alpha ) const { return mValues[alpha]; }
+
+  private:
+	static void build()
+	{
+		sInstance.mValues[0] = 1;
+		for( int a = 1; a < 256; ++a )
+			sInstance.mValues[a] = 255.0f / a;
+	}
+
+	float	mValues[256];
+
+	// neither needs a constructor run, so the table costs nothing until an unpremultiply uses it
+	static ReciprocalTable		sInstance;
+	static boost::once_flag		sOnce;
+};
 
-	surface->setPremultiplied( true );
-
-	int32_t rowBytes = surface->getRowBytes();
-	uint8_t pixelInc = surface->getPixelInc();
-	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			T alpha = dstPtr[alphaOffset];
-			
-			dstPtr[redOffset] = CHANTRAIT<T>::premultiply( dstPtr[redOffset], alpha );
-			dstPtr[greenOffset] = CHANTRAIT<T>::premultiply( dstPtr[greenOffset], alpha );
-			dstPtr[blueOffset] = CHANTRAIT<T>::premultiply( dstPtr[blueOffset], alpha );
-			dstPtr += pixelInc;
+ReciprocalTable ReciprocalTable::sInstance;
+boost::once_flag ReciprocalTable::sOnce = BOOST_ONCE_INIT;
+
+// A mask of the alpha lanes of a pixel, 8 bits per lane
+template<int ALPHA>
+inline __m128i alphaMask_epi8()
+{
+	return _mm_set1_epi32( 0xFF << ( ALPHA * 8 ) );
+}
+
+template<int ALPHA>
+inline __m128 alphaMask_ps()
+{
+	return _mm_castsi128_ps( _mm_setr_epi32( ( ALPHA == 0 ) ? -1 : 0, ( ALPHA == 1 ) ? -1 : 0, ( ALPHA == 2 ) ? -1 : 0, ( ALPHA == 3 ) ? -1 : 0 ) );
+}
+
+template<int ALPHA>
+int32_t premultiplyRow_sse( const uint8_t *src, uint8_t *dst, int32_t width )
+{
+	const __m128i zero = _mm_setzero_si128(), max = _mm_set1_epi16( 255 ), divide255 = _mm_set1_epi16( (short)0x8081 );
+	// the alpha lanes of two pixels widened to 16 bits
+	const __m128i mask = _mm_unpacklo_epi8( alphaMask_epi8<ALPHA>(), alphaMask_epi8<ALPHA>() );
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 4 ) );
+		__m128i halves[2] = { _mm_unpacklo_epi8( v, zero ), _mm_unpackhi_epi8( v, zero ) };
+		for( int k = 0; k < 2; ++k ) {
+			__m128i alpha = _mm_shufflelo_epi16( halves[k], _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+			alpha = _mm_shufflehi_epi16( alpha, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+			// alpha itself is multiplied by 255 so the divide restores it; ( n * 0x8081 ) >> 23 is n / 255 for every 16-bit n
+			const __m128i product = _mm_mullo_epi16( halves[k], _mm_or_si128( _mm_andnot_si128( mask, alpha ), _mm_and_si128( mask, max ) ) );
+			halves[k] = _mm_srli_epi16( _mm_mulhi_epu16( product, divide255 ), 7 );
 		}
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 4 ), _mm_packus_epi16( halves[0], halves[1] ) );
 	}
+	return x;
 }
 
-// this is a candidate for sse2
-template<>
-void unpremultiply<uint8_t>( SurfaceT<uint8_t> *surface )
+template<int ALPHA>
+int32_t unpremultiplyRow_sse( const uint8_t *src, uint8_t *dst, int32_t width )
 {
-	const Area clippedArea = surface->getBounds();
+	const __m128i zero = _mm_setzero_si128(), mask = alphaMask_epi8<ALPHA>();
+	// Multiplying by the reciprocal is exact for 8-bit values once they are nudged up by 1/510: this lifts quotients that are
+	// whole numbers clear of the rounding error, while staying well short of the next whole number for those that aren't.
+	const __m128 nudge = _mm_set1_ps( 1.0f / 510 );
+	const ReciprocalTable &reciprocals = ReciprocalTable::get();
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 4 ) );
+		const __m128i halves[2] = { _mm_unpacklo_epi8( v, zero ), _mm_unpackhi_epi8( v, zero ) };
+		__m128i pixels[4];
+		for( int k = 0; k < 4; ++k ) {
+			const __m128i pixel = ( k & 1 ) ? _mm_unpackhi_epi16( halves[k / 2], zero ) : _mm_unpacklo_epi16( halves[k / 2], zero );
+			const __m128 scale = _mm_set1_ps( reciprocals[src[( x + k ) * 4 + ALPHA]] );
+			pixels[k] = _mm_cvttps_epi32( _mm_mul_ps( _mm_add_ps( _mm_cvtepi32_ps( pixel ), nudge ), scale ) );
+		}
+		const __m128i result = _mm_packus_epi16( _mm_packs_epi32( pixels[0], pixels[1] ), _mm_packs_epi32( pixels[2], pixels[3] ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 4 ), _mm_or_si128( _mm_andnot_si128( mask, result ), _mm_and_si128( mask, v ) ) );
+	}
+	return x;
+}
 
-	if( ! surface->hasAlpha() )
-		return;
+template<int ALPHA>
+int32_t premultiplyRow_sse( const float *src, float *dst, int32_t width )
+{
+	const __m128 mask = alphaMask_ps<ALPHA>(), one = _mm_set1_ps( 1 );
+	for( int32_t x = 0; x < width; ++x ) {
+		const __m128 v = _mm_loadu_ps( src + x * 4 ), alpha = _mm_shuffle_ps( v, v, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		_mm_storeu_ps( dst + x * 4, _mm_mul_ps( v, _mm_or_ps( _mm_andnot_ps( mask, alpha ), _mm_and_ps( mask, one ) ) ) );
+	}
+	return width;
+}
 
-	surface->setPremultiplied( false );
-
-	int32_t rowBytes = surface->getRowBytes();
-	uint8_t pixelInc = surface->getPixelInc();
-	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		uint8_t *dstPtr = reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes;
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			// which in 8bit pixel arithmetic is to multiply by 255 and divide by the alpha
-			uint8_t alpha = dstPtr[alphaOffset];
-			if( alpha ) {
-				dstPtr[redOffset] = dstPtr[redOffset] * 255 / alpha;
-				dstPtr[greenOffset] = dstPtr[greenOffset] * 255 / alpha;
-				dstPtr[blueOffset] = dstPtr[blueOffset] * 255 / alpha;
+template<int ALPHA>
+int32_t unpremultiplyRow_sse( const float *src, float *dst, int32_t width )
+{
+	const __m128 mask = alphaMask_ps<ALPHA>(), one = _mm_set1_ps( 1 ), zero = _mm_setzero_ps();
+	for( int32_t x = 0; x < width; ++x ) {
+		const __m128 v = _mm_loadu_ps( src + x * 4 ), alpha = _mm_shuffle_ps( v, v, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		const __m128 quotient = _mm_div_ps( v, _mm_or_ps( _mm_andnot_ps( mask, alpha ), _mm_and_ps( mask, one ) ) );
+		// transparent pixels are left as they are
+		const __m128 opaque = _mm_cmpneq_ps( alpha, zero );
+		_mm_storeu_ps( dst + x * 4, _mm_or_ps( _mm_and_ps( opaque, quotient ), _mm_andnot_ps( opaque, v ) ) );
+	}
+	return width;
+}
+
+#endif // defined( CINDER_SSE2 )
+
+// The row kernels, indexed by alpha offset and resolved per machine through DispatchTable; NULL where there is none
+struct PremultKernels {
+	PremultRowFunc_u8		mPremultiply_u8[4], mUnpremultiply_u8[4];
+	PremultRowFunc_float	mPremultiply_float[4], mUnpremultiply_float[4];
+
+	static void resolve( System::SimdLevel level, PremultKernels *table )
+	{
+		std::fill( table->mPremultiply_u8, table->mPremultiply_u8 + 4, PremultRowFunc_u8( NULL ) );
+		std::fill( table->mUnpremultiply_u8, table->mUnpremultiply_u8 + 4, PremultRowFunc_u8( NULL ) );
+		std::fill( table->mPremultiply_float, table->mPremultiply_float + 4, PremultRowFunc_float( NULL ) );
+		std::fill( table->mUnpremultiply_float, table->mUnpremultiply_float + 4, PremultRowFunc_float( NULL ) );
+#if defined( CINDER_SSE2 )
+		if( level >= System::SIMD_SSE2 ) {
+			table->mPremultiply_u8[0] = &premultiplyRow_sse<0>;
+			table->mPremultiply_u8[3] = &premultiplyRow_sse<3>;
+			table->mUnpremultiply_u8[0] = &unpremultiplyRow_sse<0>;
+			table->mUnpremultiply_u8[3] = &unpremultiplyRow_sse<3>;
+			table->mPremultiply_float[0] = &premultiplyRow_sse<0>;
+			table->mPremultiply_float[3] = &premultiplyRow_sse<3>;
+			table->mUnpremultiply_float[0] = &unpremultiplyRow_sse<0>;
+			table->mUnpremultiply_float[3] = &unpremultiplyRow_sse<3>;
+		}
+#endif
+	}
+};
+
+// Looks up the kernel converting 4-channel rows of T with alpha at offset \a alpha
+template<typename T, bool PREMULTIPLY>
+struct PremultKernel {};
+
+template<> struct PremultKernel<uint8_t,true> {
+	typedef PremultRowFunc_u8 Func;
+	static Func get( uint8_t alpha ) { return DispatchTable<PremultKernels>::get().mPremultiply_u8[alpha]; }
+};
+template<> struct PremultKernel<uint8_t,false> {
+	typedef PremultRowFunc_u8 Func;
+	static Func get( uint8_t alpha ) { return DispatchTable<PremultKernels>::get().mUnpremultiply_u8[alpha]; }
+};
+template<> struct PremultKernel<float,true> {
+	typedef PremultRowFunc_float Func;
+	static Func get( uint8_t alpha ) { return DispatchTable<PremultKernels>::get().mPremultiply_float[alpha]; }
+};
+template<> struct PremultKernel<float,false> {
+	typedef PremultRowFunc_float Func;
+	static Func get( uint8_t alpha ) { return DispatchTable<PremultKernels>::get().mUnpremultiply_float[alpha]; }
+};
+
+// Premultiplies or unpremultiplies rows [y1, y2) of \a srcArea of \a src into \a dst at \a dstOffset. \a src must have an alpha channel;
+// if \a dst has none, only the color channels are written.
+template<typename T, bool PREMULTIPLY>
+class PremultiplyBand {
+  public:
+	PremultiplyBand( const SurfaceT<T> *src, SurfaceT<T> *dst, const Area &srcArea, const Vec2i &dstOffset )
+		: mSrc( src ), mDst( dst ), mSrcArea( srcArea ), mDstOffset( dstOffset ), mRowFunc( NULL )
+	{
+		const SurfaceChannelOrder &srcOrder = src->getChannelOrder(), &dstOrder = dst->getChannelOrder();
+		// the kernels keep pixels where they are, so both surfaces must share a 4-channel layout
+		if( ( src->getPixelInc() == 4 ) && dst->hasAlpha() && ( srcOrder == dstOrder ) )
+			mRowFunc = PremultKernel<T,PREMULTIPLY>::get( src->getAlphaOffset() );
+	}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const uint8_t srcInc = mSrc->getPixelInc(), dstInc = mDst->getPixelInc();
+		const uint8_t sR = mSrc->getRedOffset(), sG = mSrc->getGreenOffset(), sB = mSrc->getBlueOffset(), sA = mSrc->getAlphaOffset();
+		const uint8_t dR = mDst->getRedOffset(), dG = mDst->getGreenOffset(), dB = mDst->getBlueOffset(), dA = mDst->getAlphaOffset();
+		const bool dstAlpha = mDst->hasAlpha();
+		const int32_t width = mSrcArea.getWidth();
+		for( int32_t y = y1; y < y2; ++y ) {
+			const T *src = mSrc->getData( Vec2i( mSrcArea.x1, mSrcArea.y1 + y ) );
+			T *dst = mDst->getData( Vec2i( mDstOffset.x, mDstOffset.y + y ) );
+			int32_t x = ( mRowFunc ) ? (*mRowFunc)( src, dst, width ) : 0;
+			src += x * srcInc;
+			dst += x * dstInc;
+			for( ; x < width; ++x ) {
+				const T alpha = src[sA];
+				if( PREMULTIPLY ) {
+					dst[dR] = CHANTRAIT<T>::premultiply( src[sR], alpha );
+					dst[dG] = CHANTRAIT<T>::premultiply( src[sG], alpha );
+					dst[dB] = CHANTRAIT<T>::premultiply( src[sB], alpha );
+				}
+				else {
+					dst[dR] = unpremultiplyValue( src[sR], alpha );
+					dst[dG] = unpremultiplyValue( src[sG], alpha );
+					dst[dB] = unpremultiplyValue( src[sB], alpha );
+				}
+				if( dstAlpha )
+					dst[dA] = alpha;
+				src += srcInc;
+				dst += dstInc;
 			}
-			dstPtr += pixelInc;
 		}
-	}	
+	}
+
+  private:
+	const SurfaceT<T>	*mSrc;
+	SurfaceT<T>			*mDst;
+	Area				mSrcArea;
+	Vec2i				mDstOffset;
+	typename PremultKernel<T,PREMULTIPLY>::Func	mRowFunc;
+};
+
+template<typename T, bool PREMULTIPLY>
+void convertPremultiplication( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	const Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
+	if( srcSurface.hasAlpha() )
+		parallelRows( 0, area.getHeight(), PremultiplyBand<T,PREMULTIPLY>( &srcSurface, dstSurface, area, Vec2i::zero() ) );
+	else // nothing to multiply by
+		dstSurface->copyFrom( srcSurface, area );
+	dstSurface->setPremultiplied( PREMULTIPLY );
 }
 
-template<>
-void unpremultiply<float>( SurfaceT<float> *surface )
+} // anonymous namespace
+
+template<typename T>
+void premultiply( SurfaceT<T> *surface )
 {
-	const Area clippedArea = surface->getBounds();
+	if( ! surface->hasAlpha() )
+		return;
 
+	convertPremultiplication<T,true>( *surface, surface );
+}
+
+template<typename T>
+void unpremultiply( SurfaceT<T> *surface )
+{
 	if( ! surface->hasAlpha() )
 		return;
 
-	surface->setPremultiplied( false );
-
-	int32_t rowBytes = surface->getRowBytes();
-	uint8_t pixelInc = surface->getPixelInc();
-	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		float *dstPtr = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			if( dstPtr[alphaOffset] != 0 ) {
-				float invAlpha = 1.0f / dstPtr[alphaOffset];
-				dstPtr[redOffset] *= invAlpha;
-				dstPtr[greenOffset] *= invAlpha;
-				dstPtr[blueOffset] *= invAlpha;
-			}
-			dstPtr += pixelInc;
-		}
-	}	
+	convertPremultiplication<T,false>( *surface, surface );
 }
 
+template<typename T>
+void premultiply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	convertPremultiplication<T,true>( srcSurface, dstSurface );
+}
 
+template<typename T>
+void unpremultiply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	convertPremultiplication<T,false>( srcSurface, dstSurface );
+}
 
 #define premult_PROTOTYPES(r,data,T)\
-	template void premultiply( SurfaceT<T> *Surface );
+	template void premultiply( SurfaceT<T> *Surface );\
+	template void unpremultiply( SurfaceT<T> *Surface );\
+	template void premultiply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );\
+	template void unpremultiply( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
 
 BOOST_PP_SEQ_FOR_EACH( premult_PROTOTYPES, ~, CHANNEL_TYPES )
 	
@@ -0,0 +1,410 @@
+/*
+ Copyright (c) 2010, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Pyramid.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include <algorithm>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// The vertical sums of the 5x5 binomial kernel fit in 16 bits for uint8_t pixels, and the full sums, 256 * 255, do as well
+template<typename T> struct BinomialSum { typedef float Type; typedef float Wide; };
+template<> struct BinomialSum<uint8_t> { typedef uint16_t Type; typedef uint32_t Wide; };
+
+template<typename S, typename T>
+inline S binomial5( T a, T b, T c, T d, T e ) { return ( (S)a + (S)e ) + 4 * ( (S)b + (S)d ) + 6 * (S)c; }
+
+// Normalizes a sum of the 5x5 binomial kernel, whose weights total 256
+inline uint8_t binomialNormalize( uint32_t sum ) { return ( sum + 128 ) >> 8; }
+inline float binomialNormalize( float sum ) { return sum * ( 1.0f / 256 ); }
+
+inline uint8_t boxMean( uint8_t a, uint8_t b, uint8_t c, uint8_t d ) { return ( a + b + c + d + 2 ) >> 2; }
+inline float boxMean( float a, float b, float c, float d ) { return ( ( a + b ) + ( c + d ) ) * 0.25f; }
+
+#if defined( CINDER_SSE2 )
+inline __m128i binomial5_epi16( __m128i a, __m128i b, __m128i c, __m128i d, __m128i e )
+{
+	return _mm_add_epi16( _mm_add_epi16( _mm_add_epi16( a, e ), _mm_slli_epi16( _mm_add_epi16( b, d ), 2 ) ), _mm_add_epi16( _mm_slli_epi16( c, 2 ), _mm_slli_epi16( c, 1 ) ) );
+}
+
+inline __m128 binomial5_ps( __m128 a, __m128 b, __m128 c, __m128 d, __m128 e )
+{
+	return _mm_add_ps( _mm_add_ps( _mm_add_ps( a, e ), _mm_mul_ps( _mm_set1_ps( 4 ), _mm_add_ps( b, d ) ) ), _mm_mul_ps( _mm_set1_ps( 6 ), c ) );
+}
+
+// Averages the 2x2 blocks of the four-channel rows \a row0 and \a row1 into the first \a count pixels of \a dst, two at a time. Returns the number of pixels written.
+int32_t boxRow4( const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int32_t count )
+{
+	const __m128i zero = _mm_setzero_si128(), two = _mm_set1_epi16( 2 );
+	int32_t x = 0;
+	for( ; x + 2 <= count; x += 2 ) {
+		const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row0 + x * 8 ) ), b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row1 + x * 8 ) );
+		// the sums of the two rows, source pixels 0 and 1 in lo and 2 and 3 in hi
+		const __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) );
+		const __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) );
+		__m128i sum = _mm_unpacklo_epi64( _mm_add_epi16( lo, _mm_srli_si128( lo, 8 ) ), _mm_add_epi16( hi, _mm_srli_si128( hi, 8 ) ) );
+		sum = _mm_srli_epi16( _mm_add_epi16( sum, two ), 2 );
+		_mm_storel_epi64( reinterpret_cast<__m128i*>( dst + x * 4 ), _mm_packus_epi16( sum, sum ) );
+	}
+	return x;
+}
+
+int32_t boxRow4( const float *row0, const float *row1, float *dst, int32_t count )
+{
+	const __m128 quarter = _mm_set1_ps( 0.25f );
+	for( int32_t x = 0; x < count; ++x ) {
+		const __m128 top = _mm_add_ps( _mm_loadu_ps( row0 + x * 8 ), _mm_loadu_ps( row0 + x * 8 + 4 ) );
+		const __m128 bottom = _mm_add_ps( _mm_loadu_ps( row1 + x * 8 ), _mm_loadu_ps( row1 + x * 8 + 4 ) );
+		_mm_storeu_ps( dst + x * 4, _mm_mul_ps( _mm_add_ps( top, bottom ), quarter ) );
+	}
+	return count;
+}
+
+// Writes to \a sums the first \a count values of the binomial kernel down the five \a rows. Returns the number of values written.
+int32_t binomialColumns( const uint8_t * const *rows, uint16_t *sums, int32_t count )
+{
+	const __m128i zero = _mm_setzero_si128();
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		__m128i v[5];
+		for( int k = 0; k < 5; ++k )
+			v[k] = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rows[k] + i ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( sums + i ), binomial5_epi16( _mm_unpacklo_epi8( v[0], zero ), _mm_unpacklo_epi8( v[1], zero ),
+			_mm_unpacklo_epi8( v[2], zero ), _mm_unpacklo_epi8( v[3], zero ), _mm_unpacklo_epi8( v[4], zero ) ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( sums + i + 8 ), binomial5_epi16( _mm_unpackhi_epi8( v[0], zero ), _mm_unpackhi_epi8( v[1], zero ),
+			_mm_unpackhi_epi8( v[2], zero ), _mm_unpackhi_epi8( v[3], zero ), _mm_unpackhi_epi8( v[4], zero ) ) );
+	}
+	return i;
+}
+
+int32_t binomialColumns( const float * const *rows, float *sums, int32_t count )
+{
+	int32_t i = 0;
+	for( ; i + 4 <= count; i += 4 )
+		_mm_storeu_ps( sums + i, binomial5_ps( _mm_loadu_ps( rows[0] + i ), _mm_loadu_ps( rows[1] + i ), _mm_loadu_ps( rows[2] + i ), _mm_loadu_ps( rows[3] + i ), _mm_loadu_ps( rows[4] + i ) ) );
+	return i;
+}
+
+// Writes pixels [\a x, \a end) of the four-channel row \a dst from the vertical \a sums, all of whose taps must lie inside the row. Returns \a end.
+int32_t binomialRow4( const uint16_t *sums, uint8_t *dst, int32_t x, int32_t end )
+{
+	const __m128i round = _mm_set1_epi16( 128 );
+	for( ; x < end; ++x ) {
+		const uint16_t *s = sums + ( 2 * x - 2 ) * 4;
+		// source pixels -2 and -1, 0 and 1, and 2; the sums wrap but the total, at most 65280, does not
+		const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) ), b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + 8 ) );
+		const __m128i c = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( s + 16 ) );
+		const __m128i outer = _mm_add_epi16( _mm_add_epi16( a, c ), _mm_add_epi16( _mm_slli_epi16( b, 2 ), _mm_slli_epi16( b, 1 ) ) );
+		const __m128i inner = _mm_srli_si128( _mm_add_epi16( a, b ), 8 );
+		const __m128i sum = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( outer, _mm_slli_epi16( inner, 2 ) ), round ), 8 );
+		const int32_t pixel = _mm_cvtsi128_si32( _mm_packus_epi16( sum, sum ) );
+		std::copy( reinterpret_cast<const uint8_t*>( &pixel ), reinterpret_cast<const uint8_t*>( &pixel ) + 4, dst + x * 4 );
+	}
+	return x;
+}
+
+int32_t binomialRow4( const float *sums, float *dst, int32_t x, int32_t end )
+{
+	const __m128 norm = _mm_set1_ps( 1.0f / 256 );
+	for( ; x < end; ++x ) {
+		const float *s = sums + ( 2 * x - 2 ) * 4;
+		const __m128 sum = binomial5_ps( _mm_loadu_ps( s ), _mm_loadu_ps( s + 4 ), _mm_loadu_ps( s + 8 ), _mm_loadu_ps( s + 12 ), _mm_loadu_ps( s + 16 ) );
+		_mm_storeu_ps( dst + x * 4, _mm_mul_ps( sum, norm ) );
+	}
+	return x;
+}
+#else
+template<typename T> int32_t boxRow4( const T*, const T*, T*, int32_t ) { return 0; }
+template<typename T, typename S> int32_t binomialColumns( const T * const*, S*, int32_t ) { return 0; }
+template<typename T, typename S> int32_t binomialRow4( const S*, T*, int32_t x, int32_t ) { return x; }
+#endif
+
+// Downsamples rows [y1, y2) of \a dst from \a src by the mean of each 2x2 block
+template<typename T>
+class BoxBand {
+  public:
+	BoxBand( const SurfaceT<T> *src, SurfaceT<T> *dst )
+		: mSrc( src ), mDst( dst ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t srcWidth = mSrc->getWidth(), srcHeight = mSrc->getHeight(), dstWidth = mDst->getWidth();
+		const uint8_t inc = mSrc->getPixelInc();
+		for( int32_t y = y1; y < y2; ++y ) {
+			const T *row0 = mSrc->getData( Vec2i( 0, 2 * y ) ), *row1 = mSrc->getData( Vec2i( 0, std::min( 2 * y + 1, srcHeight - 1 ) ) );
+			T *dst = mDst->getData( Vec2i( 0, y ) );
+			// the last pixel of an odd width has no right neighbor and is left to the scalar loop
+			int32_t x = ( mSimd && inc == 4 ) ? boxRow4( row0, row1, dst, srcWidth / 2 ) : 0;
+			for( ; x < dstWidth; ++x ) {
+				const int32_t x0 = 2 * x * inc, x1 = std::min( 2 * x + 1, srcWidth - 1 ) * inc;
+				for( uint8_t c = 0; c < inc; ++c )
+					dst[x * inc + c] = boxMean( row0[x0 + c], row0[x1 + c], row1[x0 + c], row1[x1 + c] );
+			}
+		}
+	}
+
+  private:
+	const SurfaceT<T>	*mSrc;
+	SurfaceT<T>			*mDst;
+	bool				mSimd;
+};
+
+// Downsamples rows [y1, y2) of \a dst from \a src by the 5x5 binomial kernel centered on every other pixel, replicating the edges of \a src
+template<typename T>
+class BinomialBand {
+  public:
+	BinomialBand( const SurfaceT<T> *src, SurfaceT<T> *dst )
+		: mSrc( src ), mDst( dst ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		typedef typename BinomialSum<T>::Type S;
+		const int32_t srcWidth = mSrc->getWidth(), srcHeight = mSrc->getHeight(), dstWidth = mDst->getWidth();
+		const uint8_t inc = mSrc->getPixelInc();
+		const int32_t count = srcWidth * inc;
+		// the pixels whose taps all lie inside the row
+		const int32_t interiorEnd = std::max<int32_t>( ( srcWidth - 1 ) / 2, 1 );
+		std::vector<S> sums( count );
+		for( int32_t y = y1; y < y2; ++y ) {
+			const T *rows[5];
+			for( int32_t k = 0; k < 5; ++k )
+				rows[k] = mSrc->getData( Vec2i( 0, constrain<int32_t>( 2 * y + k - 2, 0, srcHeight - 1 ) ) );
+			int32_t i = ( mSimd ) ? binomialColumns( rows, &sums[0], count ) : 0;
+			for( ; i < count; ++i )
+				sums[i] = binomial5<S>( rows[0][i], rows[1][i], rows[2][i], rows[3][i], rows[4][i] );
+
+			T *dst = mDst->getData( Vec2i( 0, y ) );
+			pixel( &sums[0], dst, 0, srcWidth, inc );
+			int32_t x = ( mSimd && inc == 4 ) ? binomialRow4( &sums[0], dst, 1, interiorEnd ) : 1;
+			for( ; x < dstWidth; ++x )
+				pixel( &sums[0], dst, x, srcWidth, inc );
+		}
+	}
+
+  private:
+	template<typename S>
+	static void pixel( const S *sums, T *dst, int32_t x, int32_t srcWidth, uint8_t inc )
+	{
+		typedef typename BinomialSum<T>::Wide W;
+		const S *p0 = sums + std::max( 2 * x - 2, 0 ) * inc, *p1 = sums + std::max( 2 * x - 1, 0 ) * inc, *p2 = sums + 2 * x * inc;
+		const S *p3 = sums + std::min( 2 * x + 1, srcWidth - 1 ) * inc, *p4 = sums + std::min( 2 * x + 2, srcWidth - 1 ) * inc;
+		for( uint8_t c = 0; c < inc; ++c )
+			dst[x * inc + c] = binomialNormalize( binomial5<W>( p0[c], p1[c], p2[c], p3[c], p4[c] ) );
+	}
+
+	const SurfaceT<T>	*mSrc;
+	SurfaceT<T>			*mDst;
+	bool				mSimd;
+};
+
+// Upsamples \a src into rows [y1, y2) of \a dst by the binomial kernel, the counterpart of BinomialBand, and writes, adds or subtracts the result.
+// Each output pixel draws on the source pixels at half its coordinates: even coordinates weigh 1 6 1 / 8 and odd ones 1 1 / 2.
+class ExpandBand {
+  public:
+	enum Mode { WRITE, ADD, SUBTRACT };
+
+	ExpandBand( const Surface32f *src, Surface32f *dst, Mode mode )
+		: mSrc( src ), mDst( dst ), mMode( mode ), mSimd( System::hasSse2() )
+	{}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t srcHeight = mSrc->getHeight();
+		const int32_t count = mDst->getWidth() * mDst->getPixelInc();
+		// the source rows which the band draws on, each upsampled horizontally
+		const int32_t first = std::max( std::min( y1 / 2, srcHeight - 1 ) - 1, 0 ), last = std::min( ( y2 - 1 ) / 2 + 1, srcHeight - 1 );
+		std::vector<float> rows( ( last - first + 1 ) * count );
+		for( int32_t y = first; y <= last; ++y )
+			expandRow( mSrc->getData( Vec2i( 0, y ) ), &rows[( y - first ) * count] );
+
+		for( int32_t y = y1; y < y2; ++y ) {
+			const int32_t m = std::min( y / 2, srcHeight - 1 );
+			const float *above = &rows[( std::max( m - 1, 0 ) - first ) * count], *center = &rows[( m - first ) * count];
+			const float *below = &rows[( std::min( m + 1, srcHeight - 1 ) - first ) * count];
+			if( y & 1 )
+				combine( center, center, below, 0.5f, 0, mDst->getData( Vec2i( 0, y ) ), count );
+			else
+				combine( above, center, below, 0.125f, 0.75f, mDst->getData( Vec2i( 0, y ) ), count );
+		}
+	}
+
+  private:
+	void expandRow( const float *src, float *dst ) const
+	{
+		const int32_t srcWidth = mSrc->getWidth(), dstWidth = mDst->getWidth();
+		const uint8_t inc = mDst->getPixelInc();
+		for( int32_t x = 0; x < dstWidth; ++x ) {
+			const int32_t m = std::min( x / 2, srcWidth - 1 );
+			const float *center = src + m * inc, *right = src + std::min( m + 1, srcWidth - 1 ) * inc;
+			if( x & 1 ) {
+				for( uint8_t c = 0; c < inc; ++c )
+					dst[x * inc + c] = ( center[c] + right[c] ) * 0.5f;
+			}
+			else {
+				const float *left = src + std::max( m - 1, 0 ) * inc;
+				for( uint8_t c = 0; c < inc; ++c )
+					dst[x * inc + c] = ( left[c] + right[c] ) * 0.125f + center[c] * 0.75f;
+			}
+		}
+	}
+
+	// Combines \a outerWeight * ( \a a + \a c ) + \a centerWeight * \a b into \a dst according to mMode
+	void combine( const float *a, const float *b, const float *c, float outerWeight, float centerWeight, float *dst, int32_t count ) const
+	{
+		int32_t i = 0;
+#if defined( CINDER_SSE2 )
+		if( mSimd ) {
+			const __m128 outer = _mm_set1_ps( outerWeight ), center = _mm_set1_ps( centerWeight );
+			for( ; i + 4 <= count; i += 4 ) {
+				const __m128 v = _mm_add_ps( _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( c + i ) ), outer ), _mm_mul_ps( _mm_loadu_ps( b + i ), center ) );
+				if( mMode == WRITE )
+					_mm_storeu_ps( dst + i, v );
+				else if( mMode == ADD )
+					_mm_storeu_ps( dst + i, _mm_add_ps( _mm_loadu_ps( dst + i ), v ) );
+				else
+					_mm_storeu_ps( dst + i, _mm_sub_ps( _mm_loadu_ps( dst + i ), v ) );
+			}
+		}
+#endif
+		for( ; i < count; ++i ) {
+			const float v = ( a[i] + c[i] ) * outerWeight + b[i] * centerWeight;
+			if( mMode == WRITE )
+				dst[i] = v;
+			else if( mMode == ADD )
+				dst[i] += v;
+			else
+				dst[i] -= v;
+		}
+	}
+
+	const Surface32f	*mSrc;
+	Surface32f			*mDst;
+	Mode				mMode;
+	bool				mSimd;
+};
+
+// Aligns the Pyramid's Surface for the downsampling kernels while keeping the channel order of the source
+class PyramidConstraints : public SurfaceConstraintsAligned {
+  public:
+	PyramidConstraints( const SurfaceChannelOrder &channelOrder ) : SurfaceConstraintsAligned( 16 ), mChannelOrder( channelOrder ) {}
+
+	virtual SurfaceChannelOrder getChannelOrder( bool /*alpha*/ ) const { return mChannelOrder; }
+
+  private:
+	SurfaceChannelOrder		mChannelOrder;
+};
+
+} // anonymous namespace
+
+template<typename T>
+PyramidT<T>::PyramidT( const SurfaceT<T> &surface, int32_t numLevels, Filter filter )
+	: mObj( new Obj )
+{
+	mObj->mFilter = filter;
+	mObj->mRequestedLevels = std::max( numLevels, 0 );
+	allocate( surface.getWidth(), surface.getHeight(), surface.getChannelOrder(), mObj->mRequestedLevels );
+	update( surface );
+}
+
+template<typename T>
+void PyramidT<T>::allocate( int32_t width, int32_t height, const SurfaceChannelOrder &channelOrder, int32_t numLevels )
+{
+	std::vector<Vec2i> sizes( 1, Vec2i( width, height ) );
+	while( ( numLevels == 0 || (int32_t)sizes.size() < numLevels ) && ( sizes.back().x > 1 || sizes.back().y > 1 ) )
+		sizes.push_back( Vec2i( ( sizes.back().x + 1 ) / 2, ( sizes.back().y + 1 ) / 2 ) );
+
+	// levels 1 and up are stacked in a column which begins at a multiple of 16 pixels, keeping their rows as aligned as level 0's
+	int32_t columnX = width, columnWidth = 0, columnHeight = 0;
+	if( sizes.size() > 1 ) {
+		columnX = ( width + 15 ) & ~15;
+		columnWidth = sizes[1].x;
+		for( size_t l = 1; l < sizes.size(); ++l )
+			columnHeight += sizes[l].y;
+	}
+
+	mObj->mSurface = SurfaceT<T>( columnX + columnWidth, std::max( height, columnHeight ), channelOrder.hasAlpha(), PyramidConstraints( channelOrder ) );
+	mObj->mLevels.clear();
+	mObj->mLevels.push_back( mObj->mSurface.getSubSurface( Area( 0, 0, width, height ) ) );
+	int32_t y = 0;
+	for( size_t l = 1; l < sizes.size(); ++l ) {
+		mObj->mLevels.push_back( mObj->mSurface.getSubSurface( Area( columnX, y, columnX + sizes[l].x, y + sizes[l].y ) ) );
+		y += sizes[l].y;
+	}
+}
+
+template<typename T>
+void PyramidT<T>::update( const SurfaceT<T> &surface )
+{
+	if( ( surface.getSize() != mObj->mLevels[0].getSize() ) || ! ( surface.getChannelOrder() == mObj->mLevels[0].getChannelOrder() ) )
+		allocate( surface.getWidth(), surface.getHeight(), surface.getChannelOrder(), mObj->mRequestedLevels );
+
+	if( surface.getData() != mObj->mLevels[0].getData() )
+		mObj->mLevels[0].copyFrom( surface, surface.getBounds() );
+	for( size_t l = 0; l < mObj->mLevels.size(); ++l )
+		mObj->mLevels[l].setPremultiplied( surface.isPremultiplied() );
+	update();
+}
+
+template<typename T>
+void PyramidT<T>::update()
+{
+	for( size_t l = 1; l < mObj->mLevels.size(); ++l ) {
+		const SurfaceT<T> *src = &mObj->mLevels[l - 1];
+		SurfaceT<T> *dst = &mObj->mLevels[l];
+		if( mObj->mFilter == BOX )
+			parallelRows( 0, dst->getHeight(), BoxBand<T>( src, dst ) );
+		else
+			parallelRows( 0, dst->getHeight(), BinomialBand<T>( src, dst ) );
+	}
+}
+
+void pyramidExpand( const Surface32f &srcSurface, Surface32f *dstSurface )
+{
+	parallelRows( 0, dstSurface->getHeight(), ExpandBand( &srcSurface, dstSurface, ExpandBand::WRITE ) );
+}
+
+void makeLaplacian( Pyramid32f *pyramid )
+{
+	// each level is expanded from the next one while that is still Gaussian
+	for( int32_t l = 0; l < pyramid->getNumLevels() - 1; ++l )
+		parallelRows( 0, pyramid->getLevel( l ).getHeight(), ExpandBand( &pyramid->getLevel( l + 1 ), &pyramid->getLevel( l ), ExpandBand::SUBTRACT ) );
+}
+
+void collapseLaplacian( Pyramid32f *pyramid )
+{
+	// each level is expanded from the next one once that has been reconstructed
+	for( int32_t l = pyramid->getNumLevels() - 2; l >= 0; --l )
+		parallelRows( 0, pyramid->getLevel( l ).getHeight(), ExpandBand( &pyramid->getLevel( l + 1 ), &pyramid->getLevel( l ), ExpandBand::ADD ) );
+}
+
+template class PyramidT<uint8_t>;
+template class PyramidT<float>;
+
+} } // namespace cinder::ip
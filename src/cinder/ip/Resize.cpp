@@ -25,8 +25,10 @@
 #include "cinder/Filter.h"
 #include "cinder/Rect.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/ip/Parallel.h"
 
 #include <math.h>
+#include <algorithm>
 #include <vector>
 using std::vector;
 using std::pair;
@@ -112,7 +114,7 @@ void scanlineShiftAccumToChannel( AT *accum, int32_t x1, int32_t y, int32_t widt
 }
 
 template<typename T, typename WT, typename AT>
-void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t y, const ChannelT<T> &channel, AT *lineBuffer, int32_t width )
+void scanlineFilterChannelToBuffer( const WeightTable<WT> *weights, int32_t x, int32_t y, const ChannelT<T> &channel, AT *lineBuffer, int32_t width )
 {
 	int32_t b, af;
 	AT sum;
@@ -138,84 +140,6 @@ void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t
 	}	
 }
 
-// assumes channels are of same dimensions
-template<typename T>
-void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &filter, const Area &srcArea, const Area &dstArea, const vector<ChannelT<T>*> &dstChannels )
-{
-	Rectf clippedSrcRect;
-	Area clippedDstArea;
-	getClippedScaledRects( srcChannels[0]->getBounds(), Rectf( srcArea ), dstChannels[0]->getBounds(), dstArea, &clippedSrcRect, &clippedDstArea );
-	
-	if ( ( clippedSrcRect.getWidth() <= 0 ) || ( clippedDstArea.getWidth() <= 0 ) 
-		|| ( clippedSrcRect.getHeight() <= 0 ) || ( clippedDstArea.getHeight() <= 0 ) )
-		return;
-	
-	FilterParams filterParamsX, filterParamsY;
-	Mapping m;
-	std::shared_ptr<typename SCALETRAIT<T>::SUMT> accum;
-	int32_t dstWidth = (int32_t)clippedDstArea.getWidth(), dstHeight = (int32_t)clippedDstArea.getHeight();
-	int32_t srcWidth = (int32_t)clippedSrcRect.getWidth(), srcHeight = (int32_t)clippedSrcRect.getHeight();
-	int32_t srcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
-	int32_t srcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
-	vector<pair<int32_t,std::shared_ptr<typename SCALETRAIT<T>::SUMT> > > linesBuffer;
-
-	m.sx = dstWidth / (float)srcWidth;
-	m.sy = dstHeight / (float)srcHeight;
-	m.tx = clippedDstArea.getX1() - 0.5f - m.sx * ( clippedSrcRect.getX1() - 0.5f );
-	m.ty = clippedDstArea.getY1() - 0.5f - m.sy * ( clippedSrcRect.getY1() - 0.5f );
-	m.ux = clippedDstArea.getX1() - m.sx * ( clippedSrcRect.getX1()- 0.5f ) - m.tx;
-	m.uy = clippedDstArea.getY1() - m.sy * ( clippedSrcRect.getY1()- 0.5f ) - m.ty;
-
-	filterParamsX.scale = std::max( 1.0f, 1.0f / m.sx );
-	filterParamsX.supp = std::max( 0.5f, filterParamsX.scale * filter.getSupport() );
-	filterParamsX.width = (int32_t)ceil( 2.0f * filterParamsX.supp );
-
-	filterParamsY.scale = std::max( 1.0f, 1.0f / m.sy );
-	filterParamsY.supp = std::max( 0.5f, filterParamsY.scale * filter.getSupport() );
-	filterParamsY.width = (int32_t)ceil( 2.0f * filterParamsY.supp );
-
-	for( int32_t i = 0; i < filterParamsY.width; i++ )
-		linesBuffer.push_back( std::make_pair( -1, std::shared_ptr<typename SCALETRAIT<T>::SUMT>( new typename SCALETRAIT<T>::SUMT[dstWidth], checked_array_deleter<typename SCALETRAIT<T>::SUMT>() ) ) );
-
-	WeightTable<typename SCALETRAIT<T>::SUMT> *xWeights, yWeights;
-	typename SCALETRAIT<T>::SUMT *xWeightBuffer, *xWeightPtr;
-	xWeights = (WeightTable<typename SCALETRAIT<T>::SUMT>*)malloc( sizeof(WeightTable<int32_t>) * dstWidth );
-	xWeightBuffer = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * dstWidth * filterParamsX.width );
-	yWeights.weight = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * filterParamsY.width );
-	accum = std::shared_ptr<typename SCALETRAIT<T>::SUMT>( new typename SCALETRAIT<T>::SUMT[dstWidth], checked_array_deleter<typename SCALETRAIT<T>::SUMT>() );
-
-	xWeightPtr = xWeightBuffer;
-	for ( int32_t bx = 0; bx < dstWidth; bx++, xWeightPtr += filterParamsX.width ) {
-		xWeights[bx].weight = xWeightPtr;
-		makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( bx, MAP(bx, m.sx, m.ux), filter, &filterParamsX, srcWidth, true, &xWeights[bx] );
-	}
-
-	for( size_t chan = 0; chan < srcChannels.size(); ++chan ) {
-		for ( int32_t dstY = 0; dstY < dstHeight; ++dstY ) {     // loop over dest scanlines
-			// prepare a weight table for dest y position by
-			makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( dstY, MAP(dstY, m.sy, m.uy), filter, &filterParamsY, srcHeight, false, &yWeights );
-
-			memset( accum.get(), 0, sizeof(int32_t) * dstWidth );
-
-			// loop over source scanlines that influence this dest scanline
-			for ( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
-				typename SCALETRAIT<T>::SUMT *line = linesBuffer[ayf % filterParamsY.width].second.get();
-				if( linesBuffer[ayf % filterParamsY.width].first != ayf ) {
-					scanlineFilterChannelToBuffer( xWeights, srcOffsetX, srcOffsetY + ayf, *(srcChannels[chan]), line, dstWidth );
-					linesBuffer[ayf % filterParamsY.width].first = ayf;
-				}
-				scanlineAccumulate<typename SCALETRAIT<T>::SUMT,typename SCALETRAIT<T>::SUMT>( yWeights.weight[ayf - yWeights.start], line, dstWidth, accum.get() );
-			}
-
-			scanlineShiftAccumToChannel( accum.get(), clippedDstArea.getX1(), clippedDstArea.getY1() + dstY, dstWidth, dstChannels[chan] );
-		}
-	}
-
-	free( xWeights );
-	free( xWeightBuffer );
-	free( yWeights.weight );
-}
-
 template<typename LT, typename AT>
 void scanlineAccumulate( LT weight, LT *lineBuffer, int32_t width, AT *accum )
 {
@@ -307,8 +231,144 @@ void makeWeightTable( int32_t b, float cen, const FilterBase &filter, const Filt
 }
 
 template<typename T>
-void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+struct ResizePlanT<T>::Obj {
+	typedef typename SCALETRAIT<T>::SUMT	SUMT;
+
+	Obj( const Area &srcBounds, const Area &srcArea, const Area &dstBounds, const Area &dstArea, const FilterBase &filter );
+
+	// resamples every channel in srcChannels into the matching channel of dstChannels, in parallel bands of rows
+	void	resample( const vector<const ChannelT<T>*> &srcChannels, const vector<ChannelT<T>*> &dstChannels ) const;
+	// resamples destination rows [y1, y2) of every channel in srcChannels into the matching channel of dstChannels
+	void	resampleRows( const vector<const ChannelT<T>*> &srcChannels, const vector<ChannelT<T>*> &dstChannels, int32_t y1, int32_t y2 ) const;
+
+	struct Band {
+		Band( const Obj *obj, const vector<const ChannelT<T>*> *srcChannels, const vector<ChannelT<T>*> *dstChannels )
+			: mObj( obj ), mSrcChannels( srcChannels ), mDstChannels( dstChannels )
+		{}
+
+		void operator()( int32_t y1, int32_t y2 ) const { mObj->resampleRows( *mSrcChannels, *mDstChannels, y1, y2 ); }
+
+		const Obj							*mObj;
+		const vector<const ChannelT<T>*>	*mSrcChannels;
+		const vector<ChannelT<T>*>			*mDstChannels;
+	};
+
+	Area						mSrcBounds, mDstBounds;
+	Area						mClippedDstArea;
+	bool						mEmpty;
+	int32_t						mDstWidth, mDstHeight;
+	int32_t						mSrcOffsetX, mSrcOffsetY;
+	FilterParams				mFilterParamsX, mFilterParamsY;
+	vector<WeightTable<SUMT> >	mXWeights, mYWeights;	// one per destination column and row respectively
+	vector<SUMT>				mXWeightBuffer, mYWeightBuffer;
+};
+
+template<typename T>
+ResizePlanT<T>::Obj::Obj( const Area &srcBounds, const Area &srcArea, const Area &dstBounds, const Area &dstArea, const FilterBase &filter )
+	: mSrcBounds( srcBounds ), mDstBounds( dstBounds ), mEmpty( true ), mDstWidth( 0 ), mDstHeight( 0 ), mSrcOffsetX( 0 ), mSrcOffsetY( 0 )
+{
+	Rectf clippedSrcRect;
+	getClippedScaledRects( srcBounds, Rectf( srcArea ), dstBounds, dstArea, &clippedSrcRect, &mClippedDstArea );
+	
+	if ( ( clippedSrcRect.getWidth() <= 0 ) || ( mClippedDstArea.getWidth() <= 0 ) 
+		|| ( clippedSrcRect.getHeight() <= 0 ) || ( mClippedDstArea.getHeight() <= 0 ) )
+		return;
+	mEmpty = false;
+
+	Mapping m;
+	mDstWidth = (int32_t)mClippedDstArea.getWidth(), mDstHeight = (int32_t)mClippedDstArea.getHeight();
+	int32_t srcWidth = (int32_t)clippedSrcRect.getWidth(), srcHeight = (int32_t)clippedSrcRect.getHeight();
+	mSrcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
+	mSrcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
+
+	m.sx = mDstWidth / (float)srcWidth;
+	m.sy = mDstHeight / (float)srcHeight;
+	m.tx = mClippedDstArea.getX1() - 0.5f - m.sx * ( clippedSrcRect.getX1() - 0.5f );
+	m.ty = mClippedDstArea.getY1() - 0.5f - m.sy * ( clippedSrcRect.getY1() - 0.5f );
+	m.ux = mClippedDstArea.getX1() - m.sx * ( clippedSrcRect.getX1()- 0.5f ) - m.tx;
+	m.uy = mClippedDstArea.getY1() - m.sy * ( clippedSrcRect.getY1()- 0.5f ) - m.ty;
+
+	mFilterParamsX.scale = std::max( 1.0f, 1.0f / m.sx );
+	mFilterParamsX.supp = std::max( 0.5f, mFilterParamsX.scale * filter.getSupport() );
+	mFilterParamsX.width = (int32_t)ceil( 2.0f * mFilterParamsX.supp );
+
+	mFilterParamsY.scale = std::max( 1.0f, 1.0f / m.sy );
+	mFilterParamsY.supp = std::max( 0.5f, mFilterParamsY.scale * filter.getSupport() );
+	mFilterParamsY.width = (int32_t)ceil( 2.0f * mFilterParamsY.supp );
+
+	mXWeights.resize( mDstWidth );
+	mXWeightBuffer.resize( mDstWidth * mFilterParamsX.width );
+	for ( int32_t bx = 0; bx < mDstWidth; bx++ ) {
+		mXWeights[bx].weight = &mXWeightBuffer[bx * mFilterParamsX.width];
+		makeWeightTable<T,SUMT>( bx, MAP(bx, m.sx, m.ux), filter, &mFilterParamsX, srcWidth, true, &mXWeights[bx] );
+	}
+
+	mYWeights.resize( mDstHeight );
+	mYWeightBuffer.resize( mDstHeight * mFilterParamsY.width );
+	for ( int32_t by = 0; by < mDstHeight; by++ ) {
+		mYWeights[by].weight = &mYWeightBuffer[by * mFilterParamsY.width];
+		makeWeightTable<T,SUMT>( by, MAP(by, m.sy, m.uy), filter, &mFilterParamsY, srcHeight, false, &mYWeights[by] );
+	}
+}
+
+template<typename T>
+void ResizePlanT<T>::Obj::resampleRows( const vector<const ChannelT<T>*> &srcChannels, const vector<ChannelT<T>*> &dstChannels, int32_t y1, int32_t y2 ) const
 {
+	// each band keeps its own ring of horizontally filtered source lines, indexed by source line modulo the filter height
+	vector<SUMT> accum( mDstWidth ), linesStorage( mDstWidth * mFilterParamsY.width );
+	vector<int32_t> lineIndices( mFilterParamsY.width );
+
+	for( size_t chan = 0; chan < srcChannels.size(); ++chan ) {
+		std::fill( lineIndices.begin(), lineIndices.end(), -1 );
+		for ( int32_t dstY = y1; dstY < y2; ++dstY ) {     // loop over dest scanlines
+			const WeightTable<SUMT> &yWeights = mYWeights[dstY];
+			std::fill( accum.begin(), accum.end(), SUMT( 0 ) );
+
+			// loop over source scanlines that influence this dest scanline
+			for ( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
+				const int32_t lineIdx = ayf % mFilterParamsY.width;
+				SUMT *line = &linesStorage[lineIdx * mDstWidth];
+				if( lineIndices[lineIdx] != ayf ) {
+					scanlineFilterChannelToBuffer( &mXWeights[0], mSrcOffsetX, mSrcOffsetY + ayf, *(srcChannels[chan]), line, mDstWidth );
+					lineIndices[lineIdx] = ayf;
+				}
+				scanlineAccumulate<SUMT,SUMT>( yWeights.weight[ayf - yWeights.start], line, mDstWidth, &accum[0] );
+			}
+
+			scanlineShiftAccumToChannel( &accum[0], mClippedDstArea.getX1(), mClippedDstArea.getY1() + dstY, mDstWidth, dstChannels[chan] );
+		}
+	}
+}
+
+template<typename T>
+void ResizePlanT<T>::Obj::resample( const vector<const ChannelT<T>*> &srcChannels, const vector<ChannelT<T>*> &dstChannels ) const
+{
+	if( mEmpty )
+		return;
+
+	// keep bands large enough that thread startup is amortized on narrow destinations
+	const int32_t minRowsPerBand = std::max<int32_t>( 4, 16384 / mDstWidth );
+	parallelRows( 0, mDstHeight, Band( this, &srcChannels, &dstChannels ), minRowsPerBand );
+}
+
+template<typename T>
+ResizePlanT<T>::ResizePlanT( const Area &srcBounds, const Area &srcArea, const Area &dstBounds, const Area &dstArea, const FilterBase &filter )
+	: mObj( new Obj( srcBounds, srcArea, dstBounds, dstArea, filter ) )
+{
+}
+
+template<typename T>
+ResizePlanT<T>::ResizePlanT( const Vec2i &srcSize, const Vec2i &dstSize, const FilterBase &filter )
+	: mObj( new Obj( Area( Vec2i::zero(), srcSize ), Area( Vec2i::zero(), srcSize ), Area( Vec2i::zero(), dstSize ), Area( Vec2i::zero(), dstSize ), filter ) )
+{
+}
+
+template<typename T>
+void ResizePlanT<T>::run( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ) const
+{
+	if( ( srcSurface.getBounds() != mObj->mSrcBounds ) || ( dstSurface->getBounds() != mObj->mDstBounds ) )
+		throw ResizePlanExc();
+
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
 
@@ -323,19 +383,46 @@ void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *ds
 		dstChannels.push_back( &dstSurface->getChannelAlpha() );	
 	}
 
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	mObj->resample( srcChannels, dstChannels );
 }
 
 template<typename T>
-void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter )
+void ResizePlanT<T>::run( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel ) const
 {
+	if( ( srcChannel.getBounds() != mObj->mSrcBounds ) || ( dstChannel->getBounds() != mObj->mDstBounds ) )
+		throw ResizePlanExc();
+
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
 	
 	srcChannels.push_back( &srcChannel );
 	dstChannels.push_back( dstChannel );
 	
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	mObj->resample( srcChannels, dstChannels );
+}
+
+template<typename T>
+const Area& ResizePlanT<T>::getSrcBounds() const
+{
+	return mObj->mSrcBounds;
+}
+
+template<typename T>
+const Area& ResizePlanT<T>::getDstBounds() const
+{
+	return mObj->mDstBounds;
+}
+
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+{
+	ResizePlanT<T>( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstArea, filter ).run( srcSurface, dstSurface );
+}
+
+template<typename T>
+void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter )
+{
+	ResizePlanT<T>( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstArea, filter ).run( srcChannel, dstChannel );
 }
 
 template<typename T>
@@ -363,7 +450,8 @@ void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Filte
 	template void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter ); \
 	template void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter ); \
 	template SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter ); \
-	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter );
+	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter ); \
+	template class ResizePlanT<T>;
 
 BOOST_PP_SEQ_FOR_EACH( resize_PROTOTYPES, ~, CHANNEL_TYPES )
 
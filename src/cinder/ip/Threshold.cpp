@@ -21,9 +21,12 @@
 */
 
 #include "cinder/ip/Threshold.h"
+#include "cinder/ip/Grayscale.h"
+#include "cinder/ip/Parallel.h"
 #include "cinder/ChanTraits.h"
 
 #include <stdlib.h>
+#include <cmath>
 
 namespace cinder { namespace ip {
 
@@ -323,6 +326,95 @@ void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, C
 	free( integralImage );	
 }
 
+namespace {
+
+// Thresholds rows against the sums of each pixel's window, read from the IntegralImage in constant time
+template<typename T, typename SUMT, AdaptiveThresholdOptions::Method METHOD>
+class LocalThresholdBand {
+  public:
+	LocalThresholdBand( const ChannelT<T> *src, const IntegralImageT<SUMT> *table, const AdaptiveThresholdOptions &options, ChannelT<T> *dst )
+		: mSrc( src ), mTable( table ), mDst( dst ), mRadius( std::max<int32_t>( options.getWindowSize() / 2, 0 ) )
+	{
+		mWidth = std::min( src->getWidth(), dst->getWidth() );
+		mOffset = options.getOffset() * CHANTRAIT<T>::max();
+		mK = options.getK();
+		mInvRange = 1.0 / ( options.getDynamicRange() * CHANTRAIT<T>::max() );
+	}
+
+	void operator()( int32_t y1, int32_t y2 ) const
+	{
+		const int32_t tableWidth = mTable->getWidth(), tableHeight = mTable->getHeight(), stride = tableWidth + 1;
+		const int8_t srcInc = mSrc->getIncrement(), dstInc = mDst->getIncrement();
+		const T maxValue = CHANTRAIT<T>::max();
+		for( int32_t y = y1; y < y2; ++y ) {
+			const int32_t top = std::max( y - mRadius, 0 ), bottom = std::min( y + mRadius + 1, tableHeight );
+			const SUMT *sumsTop = mTable->getData() + top * stride, *sumsBottom = mTable->getData() + bottom * stride;
+			const double *squaresTop = 0, *squaresBottom = 0;
+			if( METHOD == AdaptiveThresholdOptions::SAUVOLA ) {
+				squaresTop = mTable->getSquaresData() + top * stride;
+				squaresBottom = mTable->getSquaresData() + bottom * stride;
+			}
+			const T *src = mSrc->getData( 0, y );
+			T *dst = mDst->getData( 0, y );
+			for( int32_t x = 0; x < mWidth; ++x ) {
+				const int32_t left = std::max( x - mRadius, 0 ), right = std::min( x + mRadius + 1, tableWidth );
+				const double count = (double)( ( right - left ) * ( bottom - top ) );
+				// integer sums wrap, so difference them before converting
+				const double sum = (double)( ( sumsBottom[right] - sumsBottom[left] ) - ( sumsTop[right] - sumsTop[left] ) );
+				const double value = *src;
+				bool set;
+				if( METHOD == AdaptiveThresholdOptions::MEAN ) {
+					// value > sum / count - offset, without the division
+					set = value * count > sum - mOffset * count;
+				}
+				else {
+					const double invCount = 1.0 / count;
+					const double mean = sum * invCount;
+					const double variance = ( ( squaresBottom[right] - squaresBottom[left] ) - ( squaresTop[right] - squaresTop[left] ) ) * invCount - mean * mean;
+					const double stdDev = ( variance > 0 ) ? std::sqrt( variance ) : 0;
+					set = value > mean * ( 1 + mK * ( stdDev * mInvRange - 1 ) );
+				}
+				*dst = ( set ) ? maxValue : 0;
+				src += srcInc;
+				dst += dstInc;
+			}
+		}
+	}
+
+  private:
+	const ChannelT<T>			*mSrc;
+	const IntegralImageT<SUMT>	*mTable;
+	ChannelT<T>					*mDst;
+	int32_t						mRadius, mWidth;
+	double						mOffset, mK, mInvRange;
+};
+
+} // anonymous namespace
+
+template<typename T, typename SUMT>
+void adaptiveThreshold( const ChannelT<T> &srcChannel, const AdaptiveThresholdOptions &options, IntegralImageT<SUMT> *integralImage, ChannelT<T> *dstChannel )
+{
+	const bool sauvola = options.getMethod() == AdaptiveThresholdOptions::SAUVOLA;
+	if( ( ! *integralImage ) || ( sauvola && ( ! integralImage->hasSquares() ) ) )
+		*integralImage = IntegralImageT<SUMT>( srcChannel, sauvola );
+	else
+		integralImage->update( srcChannel );
+
+	const int32_t height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( sauvola )
+		parallelRows( 0, height, LocalThresholdBand<T,SUMT,AdaptiveThresholdOptions::SAUVOLA>( &srcChannel, integralImage, options, dstChannel ) );
+	else
+		parallelRows( 0, height, LocalThresholdBand<T,SUMT,AdaptiveThresholdOptions::MEAN>( &srcChannel, integralImage, options, dstChannel ) );
+}
+
+template<typename T, typename SUMT>
+void adaptiveThreshold( const SurfaceT<T> &srcSurface, const AdaptiveThresholdOptions &options, IntegralImageT<SUMT> *integralImage, ChannelT<T> *dstChannel )
+{
+	// each pixel reads only its own value once the table is built, so the grayscale image can be thresholded in place
+	grayscale( srcSurface, dstChannel );
+	adaptiveThreshold( *dstChannel, options, integralImage, dstChannel );
+}
+
 template<typename T>
 AdaptiveThresholdT<T>::Obj::Obj( ChannelT<T> *channel ) : mChannel( channel ) {
 	mImageWidth = mChannel->getWidth();
@@ -370,5 +462,16 @@ template class AdaptiveThresholdT<float>;
 
 BOOST_PP_SEQ_FOR_EACH( threshold_PROTOTYPES, ~, (uint8_t) )
 
+template void threshold( const ChannelT<float> &srcChannel, float value, ChannelT<float> *dstChannel );
+
+template void adaptiveThreshold( const ChannelT<uint8_t> &srcChannel, const AdaptiveThresholdOptions &options, IntegralImageT<uint32_t> *integralImage, ChannelT<uint8_t> *dstChannel );
+template void adaptiveThreshold( const ChannelT<uint8_t> &srcChannel, const AdaptiveThresholdOptions &options, IntegralImageT<uint64_t> *integralImage, ChannelT<uint8_t> *dstChannel );
+template void adaptiveThreshold( const ChannelT<uint8_t> &srcChannel, const AdaptiveThresholdOptions &options, IntegralImageT<double> *integralImage, ChannelT<uint8_t> *dstChannel );
+template void adaptiveThreshold( const ChannelT<float> &srcChannel, const AdaptiveThresholdOptions &options, IntegralImageT<double> *integralImage, ChannelT<float> *dstChannel );
+template void adaptiveThreshold( const SurfaceT<uint8_t> &srcSurface, const AdaptiveThresholdOptions &options, IntegralImageT<uint32_t> *integralImage, ChannelT<uint8_t> *dstChannel );
+template void adaptiveThreshold( const SurfaceT<uint8_t> &srcSurface, const AdaptiveThresholdOptions &options, IntegralImageT<uint64_t> *integralImage, ChannelT<uint8_t> *dstChannel );
+template void adaptiveThreshold( const SurfaceT<uint8_t> &srcSurface, const AdaptiveThresholdOptions &options, IntegralImageT<double> *integralImage, ChannelT<uint8_t> *dstChannel );
+template void adaptiveThreshold( const SurfaceT<float> &srcSurface, const AdaptiveThresholdOptions &options, IntegralImageT<double> *integralImage, ChannelT<float> *dstChannel );
+
 
 } } // namespace cinder::ip
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+
+#include "cinder/Surface.h"
+#include "cinder/ip/Blend.h"
+using namespace ci;
+
+// Verifies that ip::blend()'s SIMD code paths match the scalar reference, ip::blendScalar(), across channel orders,
+// premultiplication and widths which aren't a multiple of the SIMD width.
+
+static const std::string kPre = "   ";
+
+std::string MakeIndentedBlock( const std::stringstream& src )
+{
+	std::stringstream ss;
+	std::string data = src.str();	
+	if( ! data.empty() ) {
+		ss << kPre;
+		for( size_t i = 0; i < data.size(); ++i ) {
+			char c = data[i];
+			ss << c;
+			if( '\n' == c ) {
+				ss << kPre;
+			}
+		}
+	}
+	return ss.str();
+}
+
+void DoTest( const std::string& name, void (*testFunc)(std::ostream&) );
+
+#define DO_TEST( _FUNC_ ) \
+	DoTest( #_FUNC_, &_FUNC_ );
+
+// extremes of alpha exercise the fully transparent and fully opaque special cases
+uint8_t randomValue( uint8_t )
+{
+	int r = rand() % 20;
+	return ( r == 0 ) ? 0 : ( ( r == 1 ) ? 255 : (uint8_t)( rand() % 256 ) );
+}
+
+float randomValue( float )
+{
+	int r = rand() % 20;
+	return ( r == 0 ) ? 0.0f : ( ( r == 1 ) ? 1.0f : ( rand() % 10001 ) / 10000.0f );
+}
+
+template<typename T>
+void randomize( SurfaceT<T> *surface )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		T *p = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < surface->getWidth() * surface->getPixelInc(); ++x )
+			p[x] = randomValue( T() );
+	}
+}
+
+bool channelsMatch( uint8_t a, uint8_t b ) { return a == b; }
+bool channelsMatch( float a, float b ) { return ( a == b ) || ( fabs( a - b ) <= 1.0e-5f * std::max<float>( 1.0f, fabs( b ) ) ); }
+
+template<typename T>
+bool surfacesMatch( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y ) {
+		const T *pa = a.getData( Vec2i( 0, y ) ), *pb = b.getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < a.getWidth() * a.getPixelInc(); ++x )
+			if( ! channelsMatch( pa[x], pb[x] ) )
+				return false;
+	}
+	
+	return true;
+}
+
+std::string orderName( int code )
+{
+	switch( code ) {
+		case SurfaceChannelOrder::RGBA: return "RGBA";
+		case SurfaceChannelOrder::BGRA: return "BGRA";
+		case SurfaceChannelOrder::ARGB: return "ARGB";
+		case SurfaceChannelOrder::ABGR: return "ABGR";
+		case SurfaceChannelOrder::RGBX: return "RGBX";
+		case SurfaceChannelOrder::BGRX: return "BGRX";
+		case SurfaceChannelOrder::XRGB: return "XRGB";
+		case SurfaceChannelOrder::RGB: return "RGB";
+		default: return "?";
+	}
+}
+
+template<typename T>
+void TestBlend( std::ostream& os )
+{
+	const int fgOrders[] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::ABGR };
+	const int bgOrders[] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::RGBX, SurfaceChannelOrder::BGRX, SurfaceChannelOrder::XRGB, SurfaceChannelOrder::RGB };
+	const int32_t widths[] = { 1, 4, 13, 64 };
+
+	srand( 1 );
+	for( int f = 0; f < 4; ++f ) {
+		for( int b = 0; b < 7; ++b ) {
+			for( int premult = 0; premult < 4; ++premult ) {
+				bool result = true;
+				for( int w = 0; w < 4; ++w ) {
+					const bool bgAlpha = ( bgOrders[b] == SurfaceChannelOrder::RGBA ) || ( bgOrders[b] == SurfaceChannelOrder::BGRA ) || ( bgOrders[b] == SurfaceChannelOrder::ARGB );
+					SurfaceT<T> foreground( widths[w] + 3, 5, true, SurfaceChannelOrder( fgOrders[f] ) );
+					SurfaceT<T> background( widths[w] + 7, 7, bgAlpha, SurfaceChannelOrder( bgOrders[b] ) );
+					randomize( &foreground );
+					randomize( &background );
+					foreground.setPremultiplied( ( premult & 1 ) != 0 );
+					background.setPremultiplied( ( premult & 2 ) != 0 );
+					SurfaceT<T> expected = background.clone();
+					expected.setPremultiplied( background.isPremultiplied() );
+
+					const Area area( 3, 0, widths[w] + 3, 5 );
+					ip::blend( &background, foreground, area, Vec2i( 2, 1 ) );
+					ip::blendScalar( &expected, foreground, area, Vec2i( 2, 1 ) );
+					result = result && surfacesMatch( background, expected );
+				}
+				os << (result ? "passed" : "FAILED") << " : " << orderName( fgOrders[f] ) << ( ( premult & 1 ) ? " premult" : "" )
+					<< " onto " << orderName( bgOrders[b] ) << ( ( premult & 2 ) ? " premult" : "" ) << "\n";
+			}
+		}
+	}
+}
+
+int main( int argc, char **argv )
+{
+	std::cout << std::endl;
+
+	DO_TEST( TestBlend<uint8_t> );
+	DO_TEST( TestBlend<float> );
+	
+	std::cout << std::endl;
+
+	return 0;
+}
+
+void DoTest( const std::string& name, void (*testFunc)( std::ostream& os ) )
+{
+	std::cout << "Testing " << name << "\n";
+	std::stringstream ss;
+	testFunc( ss );
+	std::string output = MakeIndentedBlock( ss );
+	if( ! output.empty() ) {
+		std::cout << output << "\n";
+	}
+	std::cout << std::endl;
+}
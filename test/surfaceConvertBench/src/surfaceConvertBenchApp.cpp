@@ -0,0 +1,116 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "cinder/Surface.h"
+#include "cinder/Timer.h"
+using namespace ci;
+
+// Measures the throughput of Surface::copyFrom() between every pair of channel orders, and of the conversion
+// constructors between Surface8u and Surface32f. Throughput counts the bytes read plus the bytes written.
+
+static const int32_t kWidth = 1920, kHeight = 1080;
+static const double kMinSeconds = 0.25;
+
+std::string orderName( int code )
+{
+	switch( code ) {
+		case SurfaceChannelOrder::RGBA: return "RGBA";
+		case SurfaceChannelOrder::BGRA: return "BGRA";
+		case SurfaceChannelOrder::ARGB: return "ARGB";
+		case SurfaceChannelOrder::ABGR: return "ABGR";
+		case SurfaceChannelOrder::RGBX: return "RGBX";
+		case SurfaceChannelOrder::BGRX: return "BGRX";
+		case SurfaceChannelOrder::RGB: return "RGB";
+		case SurfaceChannelOrder::BGR: return "BGR";
+		default: return "?";
+	}
+}
+
+bool hasAlpha( int code )
+{
+	return ( code == SurfaceChannelOrder::RGBA ) || ( code == SurfaceChannelOrder::BGRA ) || ( code == SurfaceChannelOrder::ARGB ) || ( code == SurfaceChannelOrder::ABGR );
+}
+
+template<typename T>
+void fill( SurfaceT<T> *surface )
+{
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		T *p = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < surface->getWidth() * surface->getPixelInc(); ++x )
+			p[x] = static_cast<T>( ( x + y ) % 200 ) / static_cast<T>( ( sizeof(T) == 1 ) ? 1 : 200 );
+	}
+}
+
+size_t surfaceBytes( int32_t width, int32_t height, const SurfaceChannelOrder &order, size_t elementSize )
+{
+	return width * height * order.getPixelInc() * elementSize;
+}
+
+void report( const std::string &name, size_t bytes, int iterations, double seconds )
+{
+	std::cout << "   " << std::setw( 20 ) << std::left << name << std::right << std::fixed << std::setprecision( 2 )
+		<< std::setw( 8 ) << ( bytes * (double)iterations / seconds / 1.0e9 ) << " GB/s" << std::endl;
+}
+
+template<typename T>
+void BenchCopyFrom( const std::string &typeName )
+{
+	const int orders[] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::ABGR,
+							SurfaceChannelOrder::RGBX, SurfaceChannelOrder::BGRX, SurfaceChannelOrder::RGB, SurfaceChannelOrder::BGR };
+	const int numOrders = sizeof(orders) / sizeof(orders[0]);
+
+	std::cout << "copyFrom() " << typeName << std::endl;
+	for( int s = 0; s < numOrders; ++s ) {
+		for( int d = 0; d < numOrders; ++d ) {
+			SurfaceT<T> src( kWidth, kHeight, hasAlpha( orders[s] ), SurfaceChannelOrder( orders[s] ) );
+			SurfaceT<T> dst( kWidth, kHeight, hasAlpha( orders[d] ), SurfaceChannelOrder( orders[d] ) );
+			fill( &src );
+			
+			int iterations = 0;
+			Timer timer( true );
+			do {
+				dst.copyFrom( src, src.getBounds() );
+				++iterations;
+			} while( timer.getSeconds() < kMinSeconds );
+			timer.stop();
+			
+			const size_t bytes = surfaceBytes( kWidth, kHeight, src.getChannelOrder(), sizeof(T) ) + surfaceBytes( kWidth, kHeight, dst.getChannelOrder(), sizeof(T) );
+			report( orderName( orders[s] ) + " -> " + orderName( orders[d] ), bytes, iterations, timer.getSeconds() );
+		}
+	}
+	std::cout << std::endl;
+}
+
+template<typename Y, typename T>
+void BenchConvert( const std::string &name )
+{
+	SurfaceT<Y> src( kWidth, kHeight, true, SurfaceChannelOrder::RGBA );
+	fill( &src );
+	
+	int iterations = 0;
+	Timer timer( true );
+	do {
+		SurfaceT<T> dst( src );
+		++iterations;
+	} while( timer.getSeconds() < kMinSeconds );
+	timer.stop();
+	
+	const size_t bytes = surfaceBytes( kWidth, kHeight, src.getChannelOrder(), sizeof(Y) ) + surfaceBytes( kWidth, kHeight, src.getChannelOrder(), sizeof(T) );
+	report( name, bytes, iterations, timer.getSeconds() );
+}
+
+int main( int argc, char **argv )
+{
+	std::cout << std::endl;
+
+	BenchCopyFrom<uint8_t>( "Surface8u" );
+	BenchCopyFrom<float>( "Surface32f" );
+
+	std::cout << "conversion" << std::endl;
+	BenchConvert<uint8_t,float>( "8u -> 32f" );
+	BenchConvert<float,uint8_t>( "32f -> 8u" );
+	std::cout << std::endl;
+
+	return 0;
+}